@@ -10,39 +10,49 @@ const int OFFSETS_4[4][2] = {{1,0}, {-1,0}, {0,1}, {0,-1}};
 // Offsets for 8-connectivity
 const int OFFSETS_8[8][2] = {{1,0}, {-1,0}, {0,1}, {0,-1}, {1,1}, {1,-1}, {-1,1}, {-1,-1}};
 
-std::vector<int32_t> label_cc_bfs(
-    const uint8_t* img, int H, int W,
-    bool eight_connectivity
+template <class Trace>
+static int label_cc_bfs_impl(
+    const ImageView& img, const LabelView& labels,
+    bool eight_connectivity, Trace& trace
 ) {
-    std::vector<int32_t> labels(H * W, 0);
+    const int H = img.H, W = img.W;
+    for (int y = 0; y < H; ++y) {
+        std::fill(labels.row(y), labels.row(y) + W, 0);
+    }
     std::vector<bool> visited(H * W, false);
     
     const int num_offsets = eight_connectivity ? 8 : 4;
     const int (*offsets)[2] = eight_connectivity ? OFFSETS_8 : OFFSETS_4;
 
+    // Flood fill labels directly: the whole engine is one scan phase
+    EnginePhaseScope<Trace> scan(trace, CCLPhase::Scan);
+
     int current = 0;
     for (int y = 0; y < H; ++y) {
         for (int x = 0; x < W; ++x) {
-            if (img[y * W + x] == 1 && !visited[y * W + x]) {
+            if (img.at(y, x) == 1 && !visited[y * W + x]) {
                 current++;
                 std::queue<std::pair<int, int>> q;
                 q.push({y, x});
+                trace.on_frontier(q.size());
                 visited[y * W + x] = true;
-                labels[y * W + x] = current;
+                labels.at(y, x) = current;
 
                 while (!q.empty()) {
                     auto [cy, cx] = q.front();
                     q.pop();
+                    trace.on_expand(num_offsets);
                     
                     for (int i = 0; i < num_offsets; ++i) {
                         int ny = cy + offsets[i][0];
                         int nx = cx + offsets[i][1];
                         
                         if (ny >= 0 && ny < H && nx >= 0 && nx < W) {
-                            if (img[ny * W + nx] == 1 && !visited[ny * W + nx]) {
+                            if (img.at(ny, nx) == 1 && !visited[ny * W + nx]) {
                                 visited[ny * W + nx] = true;
-                                labels[ny * W + nx] = current;
+                                labels.at(ny, nx) = current;
                                 q.push({ny, nx});
+                                trace.on_frontier(q.size());
                             }
                         }
                     }
@@ -50,42 +60,55 @@ std::vector<int32_t> label_cc_bfs(
             }
         }
     }
-    return labels;
+    trace.provisional_labels = current;
+    trace.label_capacity = 0;
+    trace.components = current;
+    return current;
 }
 
-std::vector<int32_t> label_cc_dfs(
-    const uint8_t* img, int H, int W,
-    bool eight_connectivity
+template <class Trace>
+static int label_cc_dfs_impl(
+    const ImageView& img, const LabelView& labels,
+    bool eight_connectivity, Trace& trace
 ) {
-    std::vector<int32_t> labels(H * W, 0);
+    const int H = img.H, W = img.W;
+    for (int y = 0; y < H; ++y) {
+        std::fill(labels.row(y), labels.row(y) + W, 0);
+    }
     std::vector<bool> visited(H * W, false);
     
     const int num_offsets = eight_connectivity ? 8 : 4;
     const int (*offsets)[2] = eight_connectivity ? OFFSETS_8 : OFFSETS_4;
 
+    // Flood fill labels directly: the whole engine is one scan phase
+    EnginePhaseScope<Trace> scan(trace, CCLPhase::Scan);
+
     int current = 0;
     for (int y = 0; y < H; ++y) {
         for (int x = 0; x < W; ++x) {
-            if (img[y * W + x] == 1 && !visited[y * W + x]) {
+            if (img.at(y, x) == 1 && !visited[y * W + x]) {
                 current++;
                 std::stack<std::pair<int, int>> stack;
                 stack.push({y, x});
+                trace.on_frontier(stack.size());
                 visited[y * W + x] = true;
-                labels[y * W + x] = current;
+                labels.at(y, x) = current;
 
                 while (!stack.empty()) {
                     auto [cy, cx] = stack.top();
                     stack.pop();
+                    trace.on_expand(num_offsets);
                     
                     for (int i = 0; i < num_offsets; ++i) {
                         int ny = cy + offsets[i][0];
                         int nx = cx + offsets[i][1];
                         
                         if (ny >= 0 && ny < H && nx >= 0 && nx < W) {
-                            if (img[ny * W + nx] == 1 && !visited[ny * W + nx]) {
+                            if (img.at(ny, nx) == 1 && !visited[ny * W + nx]) {
                                 visited[ny * W + nx] = true;
-                                labels[ny * W + nx] = current;
+                                labels.at(ny, nx) = current;
                                 stack.push({ny, nx});
+                                trace.on_frontier(stack.size());
                             }
                         }
                     }
@@ -93,7 +116,10 @@ std::vector<int32_t> label_cc_dfs(
             }
         }
     }
-    return labels;
+    trace.provisional_labels = current;
+    trace.label_capacity = 0;
+    trace.components = current;
+    return current;
 }
 
 class DSU {
@@ -108,18 +134,25 @@ public:
         }
     }
 
-    int find(int x) {
+    template <class Trace>
+    int find(int x, Trace& trace) {
+        int steps = 0;
         while (x != parent[x]) {
             parent[x] = parent[parent[x]];
             x = parent[x];
+            steps++;
         }
+        trace.on_find(steps);
         return x;
     }
 
-    void union_set(int a, int b) {
-        int ra = find(a);
-        int rb = find(b);
+    template <class Trace>
+    void union_set(int a, int b, Trace& trace) {
+        trace.on_union();
+        int ra = find(a, trace);
+        int rb = find(b, trace);
         if (ra == rb) return;
+        trace.on_merge();
         
         if (rank[ra] < rank[rb]) {
             parent[ra] = rb;
@@ -132,59 +165,147 @@ public:
     }
 };
 
-std::vector<int32_t> label_cc_dsu(
-    const uint8_t* img, int H, int W,
-    bool eight_connectivity
+template <class Trace>
+static int label_cc_dsu_impl(
+    const ImageView& img, const LabelView& labels,
+    bool eight_connectivity, Trace& trace
 ) {
+    const int H = img.H, W = img.W;
     int N = H * W;
     DSU dsu(N);
+    trace.label_capacity = N;
+    int64_t foreground = 0;
 
     // Pass 1: union adjacent pixels
-    for (int y = 0; y < H; ++y) {
-        for (int x = 0; x < W; ++x) {
-            if (img[y * W + x] != 1) {
-                continue;
-            }
-            int idx = y * W + x;
-
-            // right
-            if (x + 1 < W && img[y * W + (x + 1)] == 1) {
-                dsu.union_set(idx, y * W + (x + 1));
-            }
-            // down
-            if (y + 1 < H && img[(y + 1) * W + x] == 1) {
-                dsu.union_set(idx, (y + 1) * W + x);
-            }
+    {
+        EnginePhaseScope<Trace> scan(trace, CCLPhase::Scan);
+        for (int y = 0; y < H; ++y) {
+            for (int x = 0; x < W; ++x) {
+                if (img.at(y, x) != 1) {
+                    continue;
+                }
+                int idx = y * W + x;
+                foreground++;
 
-            if (eight_connectivity) {
-                if (y + 1 < H && x + 1 < W && img[(y + 1) * W + (x + 1)] == 1) {
-                    dsu.union_set(idx, (y + 1) * W + (x + 1));
+                // right
+                if (x + 1 < W && img.at(y, x + 1) == 1) {
+                    dsu.union_set(idx, y * W + (x + 1), trace);
+                }
+                // down
+                if (y + 1 < H && img.at(y + 1, x) == 1) {
+                    dsu.union_set(idx, (y + 1) * W + x, trace);
                 }
-                if (y + 1 < H && x - 1 >= 0 && img[(y + 1) * W + (x - 1)] == 1) {
-                    dsu.union_set(idx, (y + 1) * W + (x - 1));
+
+                if (eight_connectivity) {
+                    if (y + 1 < H && x + 1 < W && img.at(y + 1, x + 1) == 1) {
+                        dsu.union_set(idx, (y + 1) * W + (x + 1), trace);
+                    }
+                    if (y + 1 < H && x - 1 >= 0 && img.at(y + 1, x - 1) == 1) {
+                        dsu.union_set(idx, (y + 1) * W + (x - 1), trace);
+                    }
                 }
             }
         }
     }
 
-    // Pass 2: assign final labels
-    std::vector<int32_t> labels(H * W, 0);
+    // Every foreground pixel is its own provisional label
+    trace.provisional_labels = foreground;
+
+    // Pass 2: assign final labels (root lookup and relabel are fused)
+    EnginePhaseScope<Trace> relabel(trace, CCLPhase::Relabel);
     std::unordered_map<int, int> root2label;
     int cur = 0;
 
     for (int y = 0; y < H; ++y) {
         for (int x = 0; x < W; ++x) {
-            if (img[y * W + x] == 1) {
-                int r = dsu.find(y * W + x);
+            if (img.at(y, x) == 1) {
+                int r = dsu.find(y * W + x, trace);
                 if (root2label.find(r) == root2label.end()) {
                     cur++;
                     root2label[r] = cur;
                 }
-                labels[y * W + x] = root2label[r];
+                labels.at(y, x) = root2label[r];
+            } else {
+                labels.at(y, x) = 0;
             }
         }
     }
 
+    trace.components = cur;
+    return cur;
+}
+
+std::vector<int32_t> label_cc_bfs(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity
+) {
+    NullTrace trace;
+    std::vector<int32_t> labels((size_t)H * W);
+    label_cc_bfs_impl(ImageView(img, H, W), LabelView(labels, H, W), eight_connectivity, trace);
+    return labels;
+}
+
+std::vector<int32_t> label_cc_bfs(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLTrace& trace
+) {
+    trace = CCLTrace();
+    std::vector<int32_t> labels((size_t)H * W);
+    label_cc_bfs_impl(ImageView(img, H, W), LabelView(labels, H, W), eight_connectivity, trace);
+    return labels;
+}
+
+int label_cc_bfs(const ImageView& img, const LabelView& labels, bool eight_connectivity) {
+    NullTrace trace;
+    return label_cc_bfs_impl(img, labels, eight_connectivity, trace);
+}
+
+std::vector<int32_t> label_cc_dfs(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity
+) {
+    NullTrace trace;
+    std::vector<int32_t> labels((size_t)H * W);
+    label_cc_dfs_impl(ImageView(img, H, W), LabelView(labels, H, W), eight_connectivity, trace);
+    return labels;
+}
+
+std::vector<int32_t> label_cc_dfs(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLTrace& trace
+) {
+    trace = CCLTrace();
+    std::vector<int32_t> labels((size_t)H * W);
+    label_cc_dfs_impl(ImageView(img, H, W), LabelView(labels, H, W), eight_connectivity, trace);
+    return labels;
+}
+
+int label_cc_dfs(const ImageView& img, const LabelView& labels, bool eight_connectivity) {
+    NullTrace trace;
+    return label_cc_dfs_impl(img, labels, eight_connectivity, trace);
+}
+
+std::vector<int32_t> label_cc_dsu(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity
+) {
+    NullTrace trace;
+    std::vector<int32_t> labels((size_t)H * W);
+    label_cc_dsu_impl(ImageView(img, H, W), LabelView(labels, H, W), eight_connectivity, trace);
+    return labels;
+}
+
+std::vector<int32_t> label_cc_dsu(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLTrace& trace
+) {
+    trace = CCLTrace();
+    std::vector<int32_t> labels((size_t)H * W);
+    label_cc_dsu_impl(ImageView(img, H, W), LabelView(labels, H, W), eight_connectivity, trace);
     return labels;
 }
 
+int label_cc_dsu(const ImageView& img, const LabelView& labels, bool eight_connectivity) {
+    NullTrace trace;
+    return label_cc_dsu_impl(img, labels, eight_connectivity, trace);
+}
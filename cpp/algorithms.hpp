@@ -5,6 +5,8 @@
 #include <cstdint>
 #include <queue>
 #include <stack>
+#include "ccl_trace.hpp"
+#include "image_view.hpp"
 
 // BFS connected-component labeling
 std::vector<int32_t> label_cc_bfs(
@@ -24,5 +26,27 @@ std::vector<int32_t> label_cc_dsu(
     bool eight_connectivity = false
 );
 
+// Traced variants: fill `trace` with phase times and internal counters
+// (queue/stack high-water for BFS/DFS, union/find counts for DSU)
+std::vector<int32_t> label_cc_bfs(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLTrace& trace
+);
+std::vector<int32_t> label_cc_dfs(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLTrace& trace
+);
+std::vector<int32_t> label_cc_dsu(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLTrace& trace
+);
+
+// Strided variants: label the H x W view `img` into `labels` (same size,
+// own stride) without copying either; return the number of components.
+// Every pixel of `labels` is written.
+int label_cc_bfs(const ImageView& img, const LabelView& labels, bool eight_connectivity = false);
+int label_cc_dfs(const ImageView& img, const LabelView& labels, bool eight_connectivity = false);
+int label_cc_dsu(const ImageView& img, const LabelView& labels, bool eight_connectivity = false);
+
 #endif // ALGORITHMS_HPP
 
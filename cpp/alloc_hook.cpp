@@ -0,0 +1,61 @@
+#include "alloc_tracker.hpp"
+#include <cstdlib>
+#include <cstddef>
+#include <new>
+
+// Replacement global operator new/delete that feed alloc_tracker.
+// Link this file into an executable (not into ccl_lib) to turn on heap
+// accounting for that program.
+//
+// Each block carries a small header recording its size, so frees are
+// accounted exactly without relying on malloc_usable_size.
+
+namespace {
+
+constexpr size_t HEADER = alignof(std::max_align_t);
+
+struct EnableTracking {
+    EnableTracking() { alloc_tracker_enable(); }
+} enable_tracking;
+
+void* tracked_alloc(size_t size) {
+    void* raw = std::malloc(size + HEADER);
+    if (!raw) return nullptr;
+    *static_cast<size_t*>(raw) = size;
+    alloc_tracker_on_alloc(size);
+    return static_cast<char*>(raw) + HEADER;
+}
+
+void tracked_free(void* p) {
+    if (!p) return;
+    void* raw = static_cast<char*>(p) - HEADER;
+    alloc_tracker_on_free(*static_cast<size_t*>(raw));
+    std::free(raw);
+}
+
+}  // namespace
+
+void* operator new(size_t size) {
+    void* p = tracked_alloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    return tracked_alloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return tracked_alloc(size ? size : 1);
+}
+
+void operator delete(void* p) noexcept { tracked_free(p); }
+void operator delete[](void* p) noexcept { tracked_free(p); }
+void operator delete(void* p, size_t) noexcept { tracked_free(p); }
+void operator delete[](void* p, size_t) noexcept { tracked_free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { tracked_free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { tracked_free(p); }
@@ -0,0 +1,50 @@
+#include "alloc_tracker.hpp"
+#include <atomic>
+
+// Plain atomics with static initialization: the hook may run before any
+// dynamic initializer in this file would.
+static std::atomic<bool> g_enabled{false};
+static std::atomic<int64_t> g_live{0};
+static std::atomic<int64_t> g_peak{0};
+static std::atomic<size_t> g_total{0};
+static std::atomic<size_t> g_count{0};
+
+bool alloc_tracking_enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void alloc_tracker_enable() {
+    g_enabled.store(true, std::memory_order_relaxed);
+}
+
+void alloc_tracker_on_alloc(size_t bytes) {
+    int64_t live = g_live.fetch_add((int64_t)bytes, std::memory_order_relaxed) + (int64_t)bytes;
+    g_total.fetch_add(bytes, std::memory_order_relaxed);
+    g_count.fetch_add(1, std::memory_order_relaxed);
+
+    int64_t peak = g_peak.load(std::memory_order_relaxed);
+    while (live > peak && !g_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {
+    }
+}
+
+void alloc_tracker_on_free(size_t bytes) {
+    g_live.fetch_sub((int64_t)bytes, std::memory_order_relaxed);
+}
+
+AllocScope::AllocScope() {
+    start_live = g_live.load(std::memory_order_relaxed);
+    start_total = g_total.load(std::memory_order_relaxed);
+    start_count = g_count.load(std::memory_order_relaxed);
+    // Restart the high-water mark from the current level
+    g_peak.store(start_live, std::memory_order_relaxed);
+}
+
+AllocStats AllocScope::stop() const {
+    AllocStats s;
+    int64_t peak = g_peak.load(std::memory_order_relaxed);
+    s.peak_bytes = peak > start_live ? (size_t)(peak - start_live) : 0;
+    s.total_bytes = g_total.load(std::memory_order_relaxed) - start_total;
+    s.allocations = g_count.load(std::memory_order_relaxed) - start_count;
+    s.live_bytes = g_live.load(std::memory_order_relaxed) - start_live;
+    return s;
+}
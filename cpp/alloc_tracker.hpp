@@ -0,0 +1,41 @@
+#ifndef ALLOC_TRACKER_HPP
+#define ALLOC_TRACKER_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+// Heap accounting for benchmark drivers.
+//
+// The counters are fed by the replacement operator new/delete in
+// alloc_hook.cpp. That file is linked into benchmark executables only,
+// never into ccl_lib, so library users keep their own allocator. Without
+// the hook, alloc_tracking_enabled() is false and every scope reports zero.
+
+struct AllocStats {
+    size_t peak_bytes;    // high-water mark of live bytes above the scope's start
+    size_t total_bytes;   // bytes requested inside the scope
+    size_t allocations;   // operator new calls inside the scope
+    int64_t live_bytes;   // bytes still held at the end of the scope (net)
+};
+
+bool alloc_tracking_enabled();
+
+// Measure heap use between construction and stop(). Scopes must not be
+// nested, and allocations from other threads are counted too.
+class AllocScope {
+private:
+    int64_t start_live;
+    size_t start_total;
+    size_t start_count;
+
+public:
+    AllocScope();
+    AllocStats stop() const;
+};
+
+// Called by alloc_hook.cpp
+void alloc_tracker_enable();
+void alloc_tracker_on_alloc(size_t bytes);
+void alloc_tracker_on_free(size_t bytes);
+
+#endif // ALLOC_TRACKER_HPP
@@ -0,0 +1,311 @@
+#include "auto_engine.hpp"
+#include "workload.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+
+InputFeatures sample_features(const uint8_t* img, int H, int W, int sample_rows) {
+    return sample_features(ImageView(img, H, W), sample_rows);
+}
+
+InputFeatures sample_features(const ImageView& img, int sample_rows) {
+    const int H = img.H, W = img.W;
+    InputFeatures f = {(int64_t)H * W, 0.0, 0.0, 0.0};
+    if (H <= 0 || W <= 0) return f;
+
+    int rows = std::max(1, std::min(H, sample_rows));
+    int64_t fg = 0, runs = 0;
+    int occupied = 0;
+    for (int k = 0; k < rows; ++k) {
+        // Row centres of `rows` equal bands
+        const uint8_t* row = img.row((int)((2 * (int64_t)k + 1) * H / (2 * rows)));
+        int64_t row_fg = 0;
+        uint8_t prev = 0;
+        for (int j = 0; j < W; ++j) {
+            uint8_t v = row[j] != 0;
+            row_fg += v;
+            runs += v & !prev;
+            prev = v;
+        }
+        fg += row_fg;
+        occupied += row_fg > 0;
+    }
+    f.density = (double)fg / ((int64_t)rows * W);
+    f.mean_run = runs ? (double)fg / runs : 0.0;
+    f.row_occupancy = (double)occupied / rows;
+    return f;
+}
+
+// Scales chosen so that one unit is roughly the distance over which the
+// winning engine changes in the calibration data
+static double feature_distance(const InputFeatures& a, const InputFeatures& b) {
+    double size = std::log10((double)std::max<int64_t>(a.pixels, 1) / std::max<int64_t>(b.pixels, 1)) / 0.5;
+    double density = (a.density - b.density) / 0.15;
+    double run = std::log2((a.mean_run + 1.0) / (b.mean_run + 1.0)) / 1.5;
+    double occupancy = (a.row_occupancy - b.row_occupancy) / 0.3;
+    return size * size + density * density + run * run + occupancy * occupancy;
+}
+
+std::string select_engine(const InputFeatures& features, bool eight_conn,
+                          const CalibrationTable& table) {
+    const CalibrationPoint* best = nullptr;
+    double best_dist = std::numeric_limits<double>::infinity();
+    for (int pass = 0; pass < 2 && !best; ++pass) {
+        // Second pass: no point for this connectivity, take any
+        for (const auto& p : table) {
+            if (pass == 0 && p.eight_conn != eight_conn) continue;
+            if (!find_engine(p.engine)) continue;
+            double d = feature_distance(features, p.features);
+            if (d < best_dist) {
+                best_dist = d;
+                best = &p;
+            }
+        }
+    }
+    return best ? best->engine : batch_engines().front().name;
+}
+
+// Measured with `ccl_bench --calibrate` on the development machine
+// (sizes 100, 300, 1000, 2000; seed 42)
+static const CalibrationPoint BUILTIN_POINTS[] = {
+    {{10000, 0.050, 1.06, 1.00}, false, "2-Pass DSU", 20.0},
+    {{10000, 0.149, 1.17, 1.00}, false, "2-Pass DSU", 29.4},
+    {{10000, 0.303, 1.48, 1.00}, false, "2-Pass DSU", 65.9},
+    {{10000, 0.435, 1.77, 1.00}, false, "2-Pass DSU", 99.1},
+    {{10000, 0.593, 2.45, 1.00}, false, "2-Pass DSU", 128.1},
+    {{10000, 0.797, 4.84, 1.00}, false, "2-Pass DSU", 58.5},
+    {{10000, 0.004, 6.25, 0.06}, false, "DFS", 11.2},
+    {{10000, 0.375, 4.46, 1.00}, false, "2-Pass DSU", 34.7},
+    {{10000, 0.505, 50.50, 1.00}, false, "2-Pass DSU", 45.5},
+    {{10000, 0.500, 1.00, 1.00}, false, "2-Pass DSU", 42.6},
+    {{10000, 0.134, 1.59, 0.80}, false, "2-Pass DSU", 22.7},
+    {{90000, 0.048, 1.04, 1.00}, false, "2-Pass DSU", 227.2},
+    {{90000, 0.151, 1.18, 1.00}, false, "2-Pass DSU", 417.7},
+    {{90000, 0.297, 1.40, 1.00}, false, "2-Pass DSU", 772.6},
+    {{90000, 0.449, 1.81, 1.00}, false, "2-Pass DSU", 1348.4},
+    {{90000, 0.594, 2.45, 1.00}, false, "2-Pass DSU", 1401.7},
+    {{90000, 0.800, 4.91, 1.00}, false, "2-Pass DSU", 932.4},
+    {{90000, 0.137, 30.65, 0.86}, false, "2-Pass DSU", 207.4},
+    {{90000, 0.373, 4.53, 1.00}, false, "2-Pass DSU", 566.3},
+    {{90000, 0.502, 150.50, 1.00}, false, "2-Pass DSU", 273.2},
+    {{90000, 0.500, 1.00, 1.00}, false, "2-Pass DSU", 627.5},
+    {{90000, 0.152, 1.61, 0.84}, false, "2-Pass DSU", 568.1},
+    {{1000000, 0.050, 1.05, 1.00}, false, "2-Pass DSU", 4551.4},
+    {{1000000, 0.150, 1.18, 1.00}, false, "2-Pass DSU", 7630.5},
+    {{1000000, 0.301, 1.42, 1.00}, false, "2-Pass DSU", 12159.6},
+    {{1000000, 0.451, 1.82, 1.00}, false, "2-Pass DSU", 20003.0},
+    {{1000000, 0.598, 2.48, 1.00}, false, "2-Pass DSU", 17638.1},
+    {{1000000, 0.801, 5.00, 1.00}, false, "2-Pass DSU", 10795.2},
+    {{1000000, 0.681, 155.10, 1.00}, false, "2-Pass DSU", 5324.0},
+    {{1000000, 0.374, 4.60, 1.00}, false, "2-Pass DSU", 4940.2},
+    {{1000000, 0.500, 500.50, 1.00}, false, "2-Pass DSU", 3305.8},
+    {{1000000, 0.500, 1.00, 1.00}, false, "2-Pass DSU", 14208.4},
+    {{1000000, 0.149, 1.62, 0.83}, false, "2-Pass DSU", 7479.6},
+    {{4000000, 0.049, 1.05, 1.00}, false, "2-Pass DSU", 19501.3},
+    {{4000000, 0.150, 1.18, 1.00}, false, "2-Pass DSU", 26694.6},
+    {{4000000, 0.298, 1.42, 1.00}, false, "2-Pass DSU", 41859.8},
+    {{4000000, 0.452, 1.83, 1.00}, false, "2-Pass DSU", 66588.0},
+    {{4000000, 0.599, 2.49, 1.00}, false, "2-Pass DSU", 83693.9},
+    {{4000000, 0.802, 5.03, 1.00}, false, "2-Pass DSU", 50631.8},
+    {{4000000, 0.993, 1765.92, 1.00}, false, "2-Pass DSU", 38239.4},
+    {{4000000, 0.373, 4.60, 1.00}, false, "2-Pass DSU", 24671.4},
+    {{4000000, 0.500, 1000.50, 1.00}, false, "2-Pass DSU", 25985.7},
+    {{4000000, 0.500, 1.00, 1.00}, false, "2-Pass DSU", 65148.0},
+    {{4000000, 0.152, 1.64, 0.84}, false, "2-Pass DSU", 26294.4},
+    {{10000, 0.050, 1.06, 1.00}, true, "2-Pass DSU", 18.8},
+    {{10000, 0.149, 1.17, 1.00}, true, "2-Pass DSU", 26.5},
+    {{10000, 0.303, 1.48, 1.00}, true, "2-Pass DSU", 81.8},
+    {{10000, 0.435, 1.77, 1.00}, true, "2-Pass DSU", 121.2},
+    {{10000, 0.593, 2.45, 1.00}, true, "2-Pass DSU", 162.5},
+    {{10000, 0.797, 4.84, 1.00}, true, "2-Pass DSU", 93.8},
+    {{10000, 0.004, 6.25, 0.06}, true, "BFS", 20.1},
+    {{10000, 0.375, 4.46, 1.00}, true, "2-Pass DSU", 75.2},
+    {{10000, 0.505, 50.50, 1.00}, true, "2-Pass DSU", 65.8},
+    {{10000, 0.500, 1.00, 1.00}, true, "2-Pass DSU", 74.3},
+    {{10000, 0.134, 1.59, 0.80}, true, "2-Pass DSU", 35.9},
+    {{90000, 0.048, 1.04, 1.00}, true, "2-Pass DSU", 355.9},
+    {{90000, 0.151, 1.18, 1.00}, true, "2-Pass DSU", 639.6},
+    {{90000, 0.297, 1.40, 1.00}, true, "2-Pass DSU", 1218.1},
+    {{90000, 0.449, 1.81, 1.00}, true, "2-Pass DSU", 1432.4},
+    {{90000, 0.594, 2.45, 1.00}, true, "2-Pass DSU", 1959.0},
+    {{90000, 0.800, 4.91, 1.00}, true, "2-Pass DSU", 1143.4},
+    {{90000, 0.137, 30.65, 0.86}, true, "2-Pass DSU", 261.6},
+    {{90000, 0.373, 4.53, 1.00}, true, "2-Pass DSU", 776.9},
+    {{90000, 0.502, 150.50, 1.00}, true, "2-Pass DSU", 496.5},
+    {{90000, 0.500, 1.00, 1.00}, true, "2-Pass DSU", 360.0},
+    {{90000, 0.152, 1.61, 0.84}, true, "2-Pass DSU", 575.9},
+    {{1000000, 0.050, 1.05, 1.00}, true, "2-Pass DSU", 3368.3},
+    {{1000000, 0.150, 1.18, 1.00}, true, "2-Pass DSU", 7440.8},
+    {{1000000, 0.301, 1.42, 1.00}, true, "2-Pass DSU", 28384.3},
+    {{1000000, 0.451, 1.82, 1.00}, true, "2-Pass DSU", 19430.7},
+    {{1000000, 0.598, 2.48, 1.00}, true, "2-Pass DSU", 17026.4},
+    {{1000000, 0.801, 5.00, 1.00}, true, "2-Pass DSU", 18502.7},
+    {{1000000, 0.681, 155.10, 1.00}, true, "2-Pass DSU", 9424.8},
+    {{1000000, 0.374, 4.60, 1.00}, true, "2-Pass DSU", 6972.3},
+    {{1000000, 0.500, 500.50, 1.00}, true, "2-Pass DSU", 4000.5},
+    {{1000000, 0.500, 1.00, 1.00}, true, "2-Pass DSU", 5517.1},
+    {{1000000, 0.149, 1.62, 0.83}, true, "2-Pass DSU", 5808.4},
+    {{4000000, 0.049, 1.05, 1.00}, true, "2-Pass DSU", 19282.2},
+    {{4000000, 0.150, 1.18, 1.00}, true, "2-Pass DSU", 28606.7},
+    {{4000000, 0.298, 1.42, 1.00}, true, "2-Pass DSU", 53365.8},
+    {{4000000, 0.452, 1.83, 1.00}, true, "2-Pass DSU", 93190.9},
+    {{4000000, 0.599, 2.49, 1.00}, true, "2-Pass DSU", 88400.9},
+    {{4000000, 0.802, 5.03, 1.00}, true, "2-Pass DSU", 75927.9},
+    {{4000000, 0.993, 1765.92, 1.00}, true, "2-Pass DSU", 65041.8},
+    {{4000000, 0.373, 4.60, 1.00}, true, "2-Pass DSU", 36577.9},
+    {{4000000, 0.500, 1000.50, 1.00}, true, "2-Pass DSU", 18433.7},
+    {{4000000, 0.500, 1.00, 1.00}, true, "2-Pass DSU", 22224.6},
+    {{4000000, 0.152, 1.64, 0.84}, true, "2-Pass DSU", 29184.3},
+};
+
+const CalibrationTable& builtin_calibration() {
+    static const CalibrationTable table(std::begin(BUILTIN_POINTS), std::end(BUILTIN_POINTS));
+    return table;
+}
+
+static CalibrationTable& calibration_slot() {
+    static CalibrationTable table = [] {
+        const char* path = std::getenv("CCL_CALIBRATION");
+        CalibrationTable loaded;
+        std::string error;
+        if (path && *path && read_calibration(path, loaded, error) && !loaded.empty()) {
+            return loaded;
+        }
+        return builtin_calibration();
+    }();
+    return table;
+}
+
+const CalibrationTable& active_calibration() {
+    return calibration_slot();
+}
+
+void set_calibration(CalibrationTable table) {
+    calibration_slot() = std::move(table);
+}
+
+static const EngineEntry& dispatch(const ImageView& img, bool eight_connectivity) {
+    std::string name = select_engine(sample_features(img), eight_connectivity, active_calibration());
+    for (const auto& e : batch_engines()) {
+        if (e.name == name) return e;
+    }
+    return batch_engines().front();
+}
+
+std::vector<int32_t> label_cc_auto(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity
+) {
+    return dispatch(ImageView(img, H, W), eight_connectivity).fn(img, H, W, eight_connectivity);
+}
+
+std::vector<int32_t> label_cc_auto(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLTrace& trace
+) {
+    return dispatch(ImageView(img, H, W), eight_connectivity).traced(img, H, W, eight_connectivity, trace);
+}
+
+int label_cc_auto(const ImageView& img, const LabelView& labels, bool eight_connectivity) {
+    return dispatch(img, eight_connectivity).view(img, labels, eight_connectivity);
+}
+
+CalibrationTable calibrate_engines(const std::vector<int>& sizes, bool eight_conn,
+                                   uint64_t seed, const BenchOptions& opts) {
+    static const double densities[] = {0.05, 0.15, 0.3, 0.45, 0.6, 0.8};
+
+    CalibrationTable table;
+    auto calibrate = [&](const std::vector<uint8_t>& img, int H, int W) {
+        CalibrationPoint p;
+        p.features = sample_features(img.data(), H, W);
+        p.eight_conn = eight_conn;
+        p.median_us = std::numeric_limits<double>::infinity();
+        for (const auto& e : batch_engines()) {
+            BenchStats s = run_benchmark([&] { e.fn(img.data(), H, W, eight_conn); }, opts);
+            if (s.median_us < p.median_us) {
+                p.median_us = s.median_us;
+                p.engine = e.name;
+            }
+        }
+        table.push_back(p);
+    };
+
+    for (int size : sizes) {
+        for (double density : densities) {
+            std::ostringstream key;
+            key << "noise " << density << "@" << size;
+            calibrate(generate_random_image(size, size, density, derive_seed(seed, key.str())), size, size);
+        }
+        for (ShapeClass cls : all_shape_classes()) {
+            if (cls == ShapeClass::Noise) continue;  // covered by the density sweep
+            std::string key = std::string(shape_class_name(cls)) + "@" + std::to_string(size);
+            calibrate(generate_shape_image(cls, size, size, derive_seed(seed, key)), size, size);
+        }
+    }
+    return table;
+}
+
+bool write_calibration(const std::string& path, const CalibrationTable& table) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "Pixels,Density,MeanRun,RowOccupancy,EightConn,Engine,Median_us\n";
+    out << std::setprecision(6);
+    for (const auto& p : table) {
+        out << p.features.pixels << "," << p.features.density << "," << p.features.mean_run << ","
+            << p.features.row_occupancy << "," << (p.eight_conn ? 1 : 0) << "," << p.engine << ","
+            << p.median_us << "\n";
+    }
+    return (bool)out;
+}
+
+bool read_calibration(const std::string& path, CalibrationTable& table, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line.rfind("Pixels,", 0) != 0) {
+        error = path + ": not a calibration table";
+        return false;
+    }
+
+    int line_no = 1;
+    while (std::getline(in, line)) {
+        line_no++;
+        if (line.empty()) continue;
+        std::vector<std::string> f;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) f.push_back(field);
+        if (f.size() != 7) {
+            error = path + ":" + std::to_string(line_no) + ": expected 7 fields, got " + std::to_string(f.size());
+            return false;
+        }
+
+        CalibrationPoint p;
+        try {
+            p.features.pixels = std::stoll(f[0]);
+            p.features.density = std::stod(f[1]);
+            p.features.mean_run = std::stod(f[2]);
+            p.features.row_occupancy = std::stod(f[3]);
+            p.eight_conn = std::stoi(f[4]) != 0;
+            p.median_us = std::stod(f[6]);
+        } catch (const std::exception&) {
+            error = path + ":" + std::to_string(line_no) + ": malformed number";
+            return false;
+        }
+        p.engine = f[5];
+        if (!find_engine(p.engine)) {
+            error = path + ":" + std::to_string(line_no) + ": unknown engine " + p.engine;
+            return false;
+        }
+        table.push_back(p);
+    }
+    return true;
+}
@@ -0,0 +1,73 @@
+#ifndef AUTO_ENGINE_HPP
+#define AUTO_ENGINE_HPP
+
+#include "bench_harness.hpp"
+#include "ccl_trace.hpp"
+#include <vector>
+#include <cstdint>
+#include <string>
+
+// Adaptive engine selection.
+//
+// label_cc_auto samples a few evenly spaced rows of the input to estimate
+// foreground density, mean run length and row occupancy, then dispatches to
+// the batch engine that won on the nearest input in a calibration table.
+// The built-in table was measured on the development machine; regenerate
+// it on the target with `ccl_bench --calibrate FILE` and point
+// CCL_CALIBRATION at the file (or call set_calibration).
+
+struct InputFeatures {
+    int64_t pixels;        // H * W
+    double density;        // foreground fraction of the sampled rows
+    double mean_run;       // mean horizontal foreground run length
+    double row_occupancy;  // fraction of sampled rows with any foreground
+};
+
+// Features from at most `sample_rows` evenly spaced rows
+InputFeatures sample_features(const uint8_t* img, int H, int W, int sample_rows = 64);
+InputFeatures sample_features(const ImageView& img, int sample_rows = 64);
+
+struct CalibrationPoint {
+    InputFeatures features;
+    bool eight_conn;
+    std::string engine;   // batch_engines() name of the fastest engine
+    double median_us;     // its median time on this input
+};
+
+using CalibrationTable = std::vector<CalibrationPoint>;
+
+// Table used by label_cc_auto: CCL_CALIBRATION if set and readable at first
+// use, otherwise the built-in one. set_calibration replaces it and is not
+// synchronized with labeling threads.
+const CalibrationTable& active_calibration();
+void set_calibration(CalibrationTable table);
+const CalibrationTable& builtin_calibration();
+
+// Engine name for `features`: nearest point with the same connectivity
+// (log size, density, log run length, occupancy)
+std::string select_engine(const InputFeatures& features, bool eight_conn,
+                          const CalibrationTable& table);
+
+std::vector<int32_t> label_cc_auto(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity = false
+);
+
+// Traced variant: the trace describes the engine that ran
+std::vector<int32_t> label_cc_auto(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLTrace& trace
+);
+
+// Strided form; returns the number of components
+int label_cc_auto(const ImageView& img, const LabelView& labels, bool eight_connectivity = false);
+
+// Benchmark every batch engine on noise of several densities and on each
+// shape class, per size; one point per input
+CalibrationTable calibrate_engines(const std::vector<int>& sizes, bool eight_conn,
+                                   uint64_t seed, const BenchOptions& opts);
+
+bool write_calibration(const std::string& path, const CalibrationTable& table);
+bool read_calibration(const std::string& path, CalibrationTable& table, std::string& error);
+
+#endif // AUTO_ENGINE_HPP
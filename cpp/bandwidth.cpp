@@ -0,0 +1,87 @@
+#include "bandwidth.hpp"
+#include <vector>
+#include <algorithm>
+#include <numeric>
+
+// Keeps results observable so the kernels are not optimized away
+static volatile uint64_t bandwidth_sink;
+
+BandwidthBaseline measure_bandwidth(size_t bytes, const BenchOptions& opts) {
+    size_t n = std::max<size_t>(1, bytes / sizeof(uint64_t));
+    std::vector<uint64_t> a(n);
+    std::vector<uint64_t> b(n);
+    std::iota(a.begin(), a.end(), 0);
+
+    // One pass per call; run_benchmark's per-call minimum sample time is
+    // irrelevant at these sizes
+    BenchOptions o = opts;
+    o.min_sample_us = 0;
+
+    BandwidthBaseline bw;
+    bw.bytes = n * sizeof(uint64_t);
+    double gb = bw.bytes / 1e9;
+
+    BenchStats copy = run_benchmark([&] {
+        std::copy(a.begin(), a.end(), b.begin());
+        bandwidth_sink = b[n / 2];
+    }, o);
+    bw.copy_gbs = 2.0 * gb / (copy.median_us / 1e6);
+
+    BenchStats scan = run_benchmark([&] {
+        uint64_t sum = 0;
+        for (size_t i = 0; i < n; ++i) sum += a[i];
+        bandwidth_sink = sum;
+    }, o);
+    bw.scan_gbs = gb / (scan.median_us / 1e6);
+
+    uint64_t v = 0;
+    BenchStats fill = run_benchmark([&] {
+        std::fill(b.begin(), b.end(), ++v);
+        bandwidth_sink = b[n / 2];
+    }, o);
+    bw.fill_gbs = gb / (fill.median_us / 1e6);
+
+    return bw;
+}
+
+int64_t traffic_2pass(int H, int W, const CCLTrace& trace) {
+    int64_t N = (int64_t)H * W;
+    int64_t bytes = 0;
+    bytes += 4 * N;                        // labels zero-init
+    bytes += 5 * trace.label_capacity;     // DSU parent (4 B) + rank (1 B) init
+    bytes += N + 4 * N;                    // scan: read input, write provisional labels
+    bytes += 16 * trace.label_capacity;    // flatten: remap init, mark roots, number, resolve
+    bytes += 8 * N;                        // relabel: read + write labels
+    bytes += 4 * trace.find_calls + 8 * trace.find_steps;
+    return bytes;
+}
+
+static int64_t traffic_flood_fill(int H, int W, const CCLTrace& trace) {
+    int64_t N = (int64_t)H * W;
+    int64_t bytes = 0;
+    bytes += 4 * N + N / 8;                // labels and visited bitmap init
+    bytes += N + N / 8;                    // scan: read input, read visited
+    bytes += 4 * N;                        // write labels
+    bytes += 16 * trace.pushes;            // every queued pixel: pair of ints pushed + popped
+    bytes += trace.neighbour_checks + trace.neighbour_checks / 8;  // neighbour reads of input + visited
+    return bytes;
+}
+
+int64_t traffic_bfs(int H, int W, const CCLTrace& trace) {
+    return traffic_flood_fill(H, W, trace);
+}
+
+int64_t traffic_dfs(int H, int W, const CCLTrace& trace) {
+    return traffic_flood_fill(H, W, trace);
+}
+
+int64_t traffic_dsu(int H, int W, const CCLTrace& trace) {
+    int64_t N = (int64_t)H * W;
+    int64_t bytes = 0;
+    bytes += 8 * N;                        // DSU parent + rank init (int each)
+    bytes += N;                            // pass 1: read input
+    bytes += 4 * trace.merges;             // rank updates on successful unions
+    bytes += N + 4 * N + 4 * N;            // pass 2: read input, labels init + write
+    bytes += 4 * trace.find_calls + 8 * trace.find_steps;
+    return bytes;
+}
@@ -0,0 +1,37 @@
+#ifndef BANDWIDTH_HPP
+#define BANDWIDTH_HPP
+
+#include "bench_harness.hpp"
+#include "ccl_trace.hpp"
+#include <cstdint>
+#include <cstddef>
+
+// Memory-bandwidth roofline for the labeling engines.
+//
+// A STREAM-like baseline measures what this machine sustains for a plain
+// copy and a read-only scan over arrays larger than the caches. Each
+// engine's traffic is modelled from its data structures and CCLTrace
+// counters; achieved GB/s divided by the copy baseline tells how close an
+// engine runs to memory bandwidth (near 1: memory-bound, well below:
+// compute- or latency-bound).
+
+struct BandwidthBaseline {
+    size_t bytes;      // size of each array
+    double copy_gbs;   // read + write, counted as 2 * bytes per pass
+    double scan_gbs;   // read only
+    double fill_gbs;   // write only
+};
+
+BandwidthBaseline measure_bandwidth(size_t bytes, const BenchOptions& opts);
+
+// Modelled bytes read + written by one call, per engine. Counts every
+// array pass (input 1 B/px, labels 4 B/px, visited bitmap, DSU arrays)
+// plus 4 B per find (the first parent read) and 8 B per further step (one
+// parent read and write), from the trace. Flood fills add 16 B per queue
+// push and the input + visited reads of each neighbour they examine.
+int64_t traffic_2pass(int H, int W, const CCLTrace& trace);
+int64_t traffic_bfs(int H, int W, const CCLTrace& trace);
+int64_t traffic_dfs(int H, int W, const CCLTrace& trace);
+int64_t traffic_dsu(int H, int W, const CCLTrace& trace);
+
+#endif // BANDWIDTH_HPP
@@ -0,0 +1,301 @@
+#include "bench_harness.hpp"
+#include "dsu_2pass.hpp"
+#include "algorithms.hpp"
+#include "bandwidth.hpp"
+#include <vector>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <map>
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+static double median_of_sorted(const std::vector<double>& v) {
+    size_t n = v.size();
+    if (n == 0) return 0.0;
+    return (n % 2) ? v[n / 2] : 0.5 * (v[n / 2 - 1] + v[n / 2]);
+}
+
+BenchStats summarize_samples(std::vector<double> samples_us) {
+    BenchStats s = {};
+    s.samples = samples_us.size();
+    s.calls_per_sample = 1;
+    if (samples_us.empty()) return s;
+
+    std::sort(samples_us.begin(), samples_us.end());
+    size_t n = samples_us.size();
+    s.median_us = median_of_sorted(samples_us);
+    s.min_us = samples_us.front();
+    s.max_us = samples_us.back();
+
+    std::vector<double> dev(n);
+    for (size_t i = 0; i < n; ++i) {
+        dev[i] = std::fabs(samples_us[i] - s.median_us);
+    }
+    std::sort(dev.begin(), dev.end());
+    s.mad_us = median_of_sorted(dev);
+
+    double sum = 0.0;
+    for (double v : samples_us) sum += v;
+    s.mean_us = sum / n;
+    double sq = 0.0;
+    for (double v : samples_us) sq += (v - s.mean_us) * (v - s.mean_us);
+    s.stddev_us = n > 1 ? std::sqrt(sq / (n - 1)) : 0.0;
+
+    // Order-statistic confidence interval for the median (normal
+    // approximation to the binomial, ~95%)
+    double half_width = 0.98 * std::sqrt((double)n);
+    long lo = (long)std::floor(n / 2.0 - half_width);
+    long hi = (long)std::ceil(n / 2.0 + half_width) - 1;
+    lo = std::max(0L, lo);
+    hi = std::min((long)n - 1, hi);
+    s.ci_low_us = samples_us[lo];
+    s.ci_high_us = samples_us[hi];
+
+    // 1.4826 * MAD estimates sigma for normal data
+    double limit = 3.0 * 1.4826 * s.mad_us;
+    s.outliers = 0;
+    for (double v : samples_us) {
+        if (std::fabs(v - s.median_us) > limit) s.outliers++;
+    }
+
+    return s;
+}
+
+BenchStats run_benchmark(const std::function<void()>& fn, const BenchOptions& opts) {
+    using clock = std::chrono::steady_clock;
+
+    if (opts.cpu >= 0) {
+        pin_to_cpu(opts.cpu);
+    }
+
+    for (int i = 0; i < opts.warmup; ++i) {
+        fn();
+    }
+
+    // Batch fast calls so one sample is well above timer resolution
+    auto t0 = clock::now();
+    fn();
+    double single_us = std::chrono::duration<double, std::micro>(clock::now() - t0).count();
+    int calls = 1;
+    if (single_us > 0.0 && single_us < opts.min_sample_us) {
+        calls = (int)std::ceil(opts.min_sample_us / single_us);
+    }
+
+    std::vector<double> samples;
+    samples.reserve(opts.repetitions);
+    for (int r = 0; r < opts.repetitions; ++r) {
+        auto start = clock::now();
+        for (int c = 0; c < calls; ++c) {
+            fn();
+        }
+        auto end = clock::now();
+        samples.push_back(std::chrono::duration<double, std::micro>(end - start).count() / calls);
+    }
+
+    BenchStats s = summarize_samples(samples);
+    s.calls_per_sample = calls;
+    return s;
+}
+
+bool pin_to_cpu(int cpu) {
+#ifdef __linux__
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+const std::vector<EngineEntry>& batch_engines() {
+    static const std::vector<EngineEntry> engines = {
+        {"2-Pass DSU", label_cc_2pass, label_cc_2pass, traffic_2pass, label_cc_2pass},
+        {"BFS", label_cc_bfs, label_cc_bfs, traffic_bfs, label_cc_bfs},
+        {"DFS", label_cc_dfs, label_cc_dfs, traffic_dfs, label_cc_dfs},
+        {"DSU 1-pass", label_cc_dsu, label_cc_dsu, traffic_dsu, label_cc_dsu},
+    };
+    return engines;
+}
+
+LabelFunc find_engine(const std::string& name) {
+    for (const auto& e : batch_engines()) {
+        if (name == e.name) return e.fn;
+    }
+    return nullptr;
+}
+
+bool write_results_csv(const std::string& path, const std::vector<BenchRecord>& records) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << "Engine,Input,H,W,EightConn,WorkPixels,Components,Samples,CallsPerSample,"
+           "Median_us,MAD_us,Mean_us,Stddev_us,Min_us,Max_us,CI_low_us,CI_high_us,Outliers,Throughput_MPs,"
+           "PeakBytes,TotalBytes,Allocations,Seed,TrafficBytes,GBps\n";
+    out << std::setprecision(6);
+    for (const auto& r : records) {
+        const BenchStats& s = r.stats;
+        out << r.engine << "," << r.input << "," << r.H << "," << r.W << ","
+            << (r.eight_conn ? 1 : 0) << "," << r.work_pixels << "," << r.components << ","
+            << s.samples << "," << s.calls_per_sample << ","
+            << s.median_us << "," << s.mad_us << "," << s.mean_us << "," << s.stddev_us << ","
+            << s.min_us << "," << s.max_us << "," << s.ci_low_us << "," << s.ci_high_us << ","
+            << s.outliers << "," << (r.work_pixels / s.median_us) << ","
+            << r.memory.peak_bytes << "," << r.memory.total_bytes << "," << r.memory.allocations << ","
+            << r.seed << "," << r.traffic_bytes << "," << (r.traffic_bytes / s.median_us / 1e3) << "\n";
+    }
+    return (bool)out;
+}
+
+bool write_results_json(const std::string& path, const std::vector<BenchRecord>& records) {
+    std::ofstream out(path);
+    if (!out) return false;
+    out << std::setprecision(6);
+    out << "[\n";
+    for (size_t i = 0; i < records.size(); ++i) {
+        const BenchRecord& r = records[i];
+        const BenchStats& s = r.stats;
+        out << "  {\"engine\": \"" << r.engine << "\", \"input\": \"" << r.input << "\""
+            << ", \"H\": " << r.H << ", \"W\": " << r.W
+            << ", \"eight_conn\": " << (r.eight_conn ? "true" : "false")
+            << ", \"work_pixels\": " << r.work_pixels
+            << ", \"components\": " << r.components
+            << ", \"samples\": " << s.samples
+            << ", \"calls_per_sample\": " << s.calls_per_sample
+            << ", \"median_us\": " << s.median_us
+            << ", \"mad_us\": " << s.mad_us
+            << ", \"mean_us\": " << s.mean_us
+            << ", \"stddev_us\": " << s.stddev_us
+            << ", \"min_us\": " << s.min_us
+            << ", \"max_us\": " << s.max_us
+            << ", \"ci_low_us\": " << s.ci_low_us
+            << ", \"ci_high_us\": " << s.ci_high_us
+            << ", \"outliers\": " << s.outliers
+            << ", \"peak_bytes\": " << r.memory.peak_bytes
+            << ", \"total_bytes\": " << r.memory.total_bytes
+            << ", \"allocations\": " << r.memory.allocations
+            << ", \"seed\": " << r.seed
+            << ", \"traffic_bytes\": " << r.traffic_bytes
+            << "}" << (i + 1 < records.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+    return (bool)out;
+}
+
+bool read_results_csv(const std::string& path, std::vector<BenchRecord>& records, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+
+    auto split = [](const std::string& line) {
+        std::vector<std::string> fields;
+        std::stringstream ss(line);
+        std::string field;
+        while (std::getline(ss, field, ',')) fields.push_back(field);
+        return fields;
+    };
+
+    std::string line;
+    if (!std::getline(in, line)) {
+        error = path + ": empty file";
+        return false;
+    }
+    std::map<std::string, size_t> column;
+    std::vector<std::string> header = split(line);
+    for (size_t i = 0; i < header.size(); ++i) column[header[i]] = i;
+    for (const char* required : {"Engine", "Input", "H", "W", "Median_us"}) {
+        if (!column.count(required)) {
+            error = path + ": missing column " + required;
+            return false;
+        }
+    }
+
+    int line_no = 1;
+    while (std::getline(in, line)) {
+        line_no++;
+        if (line.empty()) continue;
+        std::vector<std::string> f = split(line);
+        auto get = [&](const char* name) -> std::string {
+            auto it = column.find(name);
+            return (it != column.end() && it->second < f.size()) ? f[it->second] : std::string();
+        };
+        auto num = [&](const char* name) {
+            std::string v = get(name);
+            return v.empty() ? 0.0 : std::stod(v);
+        };
+
+        BenchRecord r = {};
+        try {
+            r.engine = get("Engine");
+            r.input = get("Input");
+            r.H = (int)num("H");
+            r.W = (int)num("W");
+            r.eight_conn = num("EightConn") != 0.0;
+            r.work_pixels = (int64_t)num("WorkPixels");
+            r.components = (int)num("Components");
+            r.stats.samples = (int)num("Samples");
+            r.stats.calls_per_sample = (int)num("CallsPerSample");
+            r.stats.median_us = num("Median_us");
+            r.stats.mad_us = num("MAD_us");
+            r.stats.mean_us = num("Mean_us");
+            r.stats.stddev_us = num("Stddev_us");
+            r.stats.min_us = num("Min_us");
+            r.stats.max_us = num("Max_us");
+            r.stats.ci_low_us = num("CI_low_us");
+            r.stats.ci_high_us = num("CI_high_us");
+            r.stats.outliers = (int)num("Outliers");
+            r.memory.peak_bytes = (size_t)num("PeakBytes");
+            r.memory.total_bytes = (size_t)num("TotalBytes");
+            r.memory.allocations = (size_t)num("Allocations");
+            std::string seed = get("Seed");
+            r.seed = seed.empty() ? 0 : std::stoull(seed);
+            r.traffic_bytes = (int64_t)num("TrafficBytes");
+        } catch (const std::exception&) {
+            error = path + ":" + std::to_string(line_no) + ": bad number";
+            return false;
+        }
+        records.push_back(r);
+    }
+    return true;
+}
+
+double regression_threshold_us(const BenchStats& baseline, const BenchStats& current, double tolerance) {
+    double sigma = 1.4826 * std::sqrt(baseline.mad_us * baseline.mad_us + current.mad_us * current.mad_us);
+    return baseline.median_us * (1.0 + tolerance) + 3.0 * sigma;
+}
+
+std::vector<RegressionResult> compare_to_baseline(
+    const std::vector<BenchRecord>& baseline, const std::vector<BenchRecord>& current,
+    double tolerance, std::vector<BenchRecord>* missing
+) {
+    auto same_case = [](const BenchRecord& a, const BenchRecord& b) {
+        return a.engine == b.engine && a.input == b.input && a.H == b.H && a.W == b.W &&
+               a.eight_conn == b.eight_conn;
+    };
+
+    std::vector<RegressionResult> results;
+    for (const auto& base : baseline) {
+        auto it = std::find_if(current.begin(), current.end(),
+                               [&](const BenchRecord& r) { return same_case(base, r); });
+        if (it == current.end()) {
+            if (missing) missing->push_back(base);
+            continue;
+        }
+        RegressionResult res;
+        res.baseline = base;
+        res.current = *it;
+        res.ratio = base.stats.median_us > 0.0 ? it->stats.median_us / base.stats.median_us : 1.0;
+        res.threshold_us = regression_threshold_us(base.stats, it->stats, tolerance);
+        res.regressed = it->stats.median_us > res.threshold_us;
+        res.mismatch = base.components != it->components;
+        results.push_back(res);
+    }
+    return results;
+}
@@ -0,0 +1,102 @@
+#ifndef BENCH_HARNESS_HPP
+#define BENCH_HARNESS_HPP
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <functional>
+#include "alloc_tracker.hpp"
+#include "ccl_trace.hpp"
+#include "image_view.hpp"
+
+// Shared benchmark harness: warm-up, repeated samples, optional CPU
+// pinning and robust statistics (median / MAD / order-statistic CI).
+
+struct BenchOptions {
+    int repetitions = 15;        // timed samples
+    int warmup = 2;              // untimed runs before sampling
+    double min_sample_us = 1000; // batch calls until one sample takes this long
+    int cpu = -1;                // pin the benchmark thread to this CPU (-1 = no pinning)
+};
+
+struct BenchStats {
+    int samples;           // number of timed samples
+    int calls_per_sample;  // calls batched into each sample
+    double median_us;      // per call
+    double mad_us;         // median absolute deviation, per call
+    double mean_us;
+    double stddev_us;
+    double min_us, max_us;
+    double ci_low_us, ci_high_us;  // ~95% distribution-free CI of the median
+    int outliers;          // samples further than 3 scaled MADs from the median
+};
+
+// Robust summary of per-call sample times (microseconds)
+BenchStats summarize_samples(std::vector<double> samples_us);
+
+// Time `fn` according to `opts`; the returned times are per call
+BenchStats run_benchmark(const std::function<void()>& fn, const BenchOptions& opts);
+
+// Pin the calling thread to one CPU; false if unsupported or refused
+bool pin_to_cpu(int cpu);
+
+// Batch labeling engines shared by every benchmark driver
+using LabelFunc = std::vector<int32_t> (*)(const uint8_t*, int, int, bool);
+using TracedLabelFunc = std::vector<int32_t> (*)(const uint8_t*, int, int, bool, CCLTrace&);
+using ViewLabelFunc = int (*)(const ImageView&, const LabelView&, bool);
+// Modelled memory traffic of one call (see bandwidth.hpp)
+using TrafficModel = int64_t (*)(int H, int W, const CCLTrace&);
+
+struct EngineEntry {
+    const char* name;
+    LabelFunc fn;
+    TracedLabelFunc traced;
+    TrafficModel traffic;
+    ViewLabelFunc view;
+};
+
+const std::vector<EngineEntry>& batch_engines();
+LabelFunc find_engine(const std::string& name);
+
+// One row of harness output
+struct BenchRecord {
+    std::string engine;
+    std::string input;
+    int H, W;
+    bool eight_conn;
+    int64_t work_pixels;  // pixels processed per call (image or stream size)
+    int components;
+    BenchStats stats;
+    AllocStats memory;  // heap use of one call (zero unless alloc_hook.cpp is linked)
+    uint64_t seed;      // workload seed of the run
+    int64_t traffic_bytes;  // modelled bytes moved per call (0 = not measured)
+};
+
+bool write_results_csv(const std::string& path, const std::vector<BenchRecord>& records);
+bool write_results_json(const std::string& path, const std::vector<BenchRecord>& records);
+
+// Read a file written by write_results_csv (columns are matched by name)
+bool read_results_csv(const std::string& path, std::vector<BenchRecord>& records, std::string& error);
+
+// Regression gate: one rerun case against its baseline row
+struct RegressionResult {
+    BenchRecord baseline;
+    BenchRecord current;
+    double ratio;         // current / baseline median
+    double threshold_us;  // slowest median still accepted
+    bool regressed;
+    bool mismatch;        // component counts differ: different workload or a wrong result
+};
+
+// Noise-aware limit: baseline median * (1 + tolerance), widened by three
+// robust standard deviations of the difference (1.4826 * MAD per run)
+double regression_threshold_us(const BenchStats& baseline, const BenchStats& current, double tolerance);
+
+// Match records on engine / input / size / connectivity. Baseline rows
+// with no current counterpart are appended to `missing` if given.
+std::vector<RegressionResult> compare_to_baseline(
+    const std::vector<BenchRecord>& baseline, const std::vector<BenchRecord>& current,
+    double tolerance, std::vector<BenchRecord>* missing = nullptr
+);
+
+#endif // BENCH_HARNESS_HPP
@@ -1,51 +1,27 @@
 #include "dsu_2pass.hpp"
 #include "algorithms.hpp"
+#include "workload.hpp"
+#include "bench_harness.hpp"
 #include <iostream>
 #include <vector>
-#include <chrono>
-#include <random>
 #include <cstring>
 
-// Simple function to generate random test image
-void generate_test_image(uint8_t* img, int H, int W, double density) {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_real_distribution<> dis(0.0, 1.0);
-    
-    for (int i = 0; i < H * W; ++i) {
-        img[i] = (dis(gen) < density) ? 1 : 0;
-    }
-}
-
-double benchmark_function(
-    std::vector<int32_t> (*func)(const uint8_t*, int, int, bool),
-    const uint8_t* img, int H, int W, bool eight_conn,
-    int iterations
-) {
-    auto start = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < iterations; ++i) {
-        func(img, H, W, eight_conn);
-    }
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-    return duration.count() / (double)iterations;
-}
-
 int main(int argc, char* argv[]) {
     int H = 1000;
     int W = 1000;
     double density = 0.3;
     int iterations = 10;
     bool eight_conn = false;
+    uint64_t seed = 42;
 
     if (argc > 1) H = std::stoi(argv[1]);
     if (argc > 2) W = std::stoi(argv[2]);
     if (argc > 3) density = std::stod(argv[3]);
     if (argc > 4) iterations = std::stoi(argv[4]);
     if (argc > 5) eight_conn = (std::stoi(argv[5]) != 0);
+    if (argc > 6) seed = std::stoull(argv[6]);
 
-    std::vector<uint8_t> img(H * W);
-    generate_test_image(img.data(), H, W, density);
+    std::vector<uint8_t> img = generate_random_image(H, W, density, seed);
 
     std::cout << "C++ Benchmark Results\n";
     std::cout << "Image size: " << H << "x" << W << "\n";
@@ -53,10 +29,17 @@ int main(int argc, char* argv[]) {
     std::cout << "Connectivity: " << (eight_conn ? "8" : "4") << "\n";
     std::cout << "Iterations: " << iterations << "\n\n";
 
-    double time_2pass = benchmark_function(label_cc_2pass, img.data(), H, W, eight_conn, iterations);
-    double time_bfs = benchmark_function(label_cc_bfs, img.data(), H, W, eight_conn, iterations);
-    double time_dfs = benchmark_function(label_cc_dfs, img.data(), H, W, eight_conn, iterations);
-    double time_dsu = benchmark_function(label_cc_dsu, img.data(), H, W, eight_conn, iterations);
+    // Median per-call time from the shared harness (see ccl_bench for the full report)
+    BenchOptions opts;
+    opts.repetitions = iterations;
+    auto median_time = [&](LabelFunc func) {
+        return run_benchmark([&] { func(img.data(), H, W, eight_conn); }, opts).median_us;
+    };
+
+    double time_2pass = median_time(label_cc_2pass);
+    double time_bfs = median_time(label_cc_bfs);
+    double time_dfs = median_time(label_cc_dfs);
+    double time_dsu = median_time(label_cc_dsu);
 
     std::cout << "2-Pass (DSU): " << time_2pass << " μs\n";
     std::cout << "BFS:          " << time_bfs << " μs\n";
@@ -0,0 +1,52 @@
+#include "ccl_batch.hpp"
+#include <algorithm>
+#include <chrono>
+
+std::vector<BatchResult> label_batch(
+    const std::vector<ImageView>& images,
+    const BatchOptions& opts,
+    BatchStats* stats
+) {
+    int threads = opts.threads;
+    if (threads <= 0) threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    // No point in idle workers
+    WorkStealingPool pool(std::max(1, std::min<int>(threads, (int)images.size())));
+    return label_batch(pool, images, opts, stats);
+}
+
+std::vector<BatchResult> label_batch(
+    WorkStealingPool& pool,
+    const std::vector<ImageView>& images,
+    const BatchOptions& opts,
+    BatchStats* stats
+) {
+    using clock = std::chrono::steady_clock;
+
+    std::vector<BatchResult> results(images.size());
+    std::vector<CCLWorkspace> workspaces(pool.size());
+    std::vector<int> per_worker(pool.size(), 0);
+    int64_t steals_before = pool.steals();
+
+    auto start = clock::now();
+    pool.run((int64_t)images.size(), [&](int64_t i, int worker) {
+        const ImageView& img = images[i];
+        BatchResult& r = results[i];
+        auto t0 = clock::now();
+        r.labels.resize((size_t)img.H * img.W);
+        LabelView out(r.labels, img.H, img.W);
+        r.components = opts.crop
+            ? label_cc_2pass_roi(img, out, opts.eight_connectivity, workspaces[worker])
+            : label_cc_2pass(img, out, opts.eight_connectivity, workspaces[worker]);
+        r.elapsed_us = std::chrono::duration<double, std::micro>(clock::now() - t0).count();
+        r.worker = worker;
+        per_worker[worker]++;
+    });
+
+    if (stats) {
+        stats->wall_us = std::chrono::duration<double, std::micro>(clock::now() - start).count();
+        stats->threads = pool.size();
+        stats->steals = pool.steals() - steals_before;
+        stats->images_per_worker = per_worker;
+    }
+    return results;
+}
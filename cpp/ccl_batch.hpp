@@ -0,0 +1,53 @@
+#ifndef CCL_BATCH_HPP
+#define CCL_BATCH_HPP
+
+#include "image_view.hpp"
+#include "dsu_2pass.hpp"
+#include "work_pool.hpp"
+#include "roi.hpp"
+#include <vector>
+#include <cstdint>
+
+// Batch labeling for datasets of many independent masks.
+//
+// Images are labeled with the two-pass engine on a WorkStealingPool; each
+// worker owns one CCLWorkspace for the whole batch, so DSU and remap
+// storage is allocated once per worker rather than once per image.
+
+struct BatchOptions {
+    int threads = 0;                  // <= 0: hardware concurrency
+    bool eight_connectivity = false;
+    bool crop = false;                // label only each image's foreground bbox (roi.hpp)
+};
+
+struct BatchResult {
+    std::vector<int32_t> labels;  // H*W, same labeling as label_cc_2pass
+    int components;
+    double elapsed_us;            // labeling time on the worker
+    int worker;                   // which worker labeled it
+};
+
+struct BatchStats {
+    double wall_us;
+    int threads;
+    int64_t steals;                  // images taken from another worker's share
+    std::vector<int> images_per_worker;
+};
+
+// Images may be strided views (tiles or crops of larger frames); results
+// are dense, in input order
+std::vector<BatchResult> label_batch(
+    const std::vector<ImageView>& images,
+    const BatchOptions& opts = BatchOptions(),
+    BatchStats* stats = nullptr
+);
+
+// Same, on an existing pool (its size overrides opts.threads)
+std::vector<BatchResult> label_batch(
+    WorkStealingPool& pool,
+    const std::vector<ImageView>& images,
+    const BatchOptions& opts = BatchOptions(),
+    BatchStats* stats = nullptr
+);
+
+#endif // CCL_BATCH_HPP
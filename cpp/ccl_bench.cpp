@@ -0,0 +1,660 @@
+#include "bench_harness.hpp"
+#include "stream_dsu.hpp"
+#include "incremental_dsu.hpp"
+#include "workload.hpp"
+#include "perf_counters.hpp"
+#include "corpus.hpp"
+#include "bandwidth.hpp"
+#include "auto_engine.hpp"
+#include "ccl_batch.hpp"
+#include "alloc_tracker.hpp"
+#include <iostream>
+#include <vector>
+#include <iomanip>
+#include <set>
+#include <string>
+#include <sstream>
+#include <functional>
+#include <chrono>
+#include <thread>
+
+// Unified benchmark harness: every engine × size × input type, with
+// robust statistics and CSV/JSON export.
+
+struct InputConfig {
+    std::string name;
+    bool is_stream;
+    double ratio;  // foreground density (full image) or stream ratio
+};
+
+struct HarnessConfig {
+    BenchOptions opts;
+    std::vector<int> sizes = {100, 200, 500, 1000, 2000};
+    std::vector<InputConfig> inputs = {
+        {"Full Image", false, 0.3},
+        {"Stream 10%", true, 0.1},
+        {"Stream 50%", true, 0.5},
+        {"Stream 100%", true, 1.0},
+    };
+    std::string engine_filter;
+    bool eight_conn = false;
+    uint64_t seed = 42;
+    std::string csv_path = "bench_results.csv";
+    std::string json_path;
+    bool corpus = false;       // shape-class corpus instead of noise/stream inputs
+    std::string masks_dir;     // PGM masks added to the corpus as class "lesion"
+    bool perf = false;
+    bool trace = false;
+    bool roofline = false;     // modelled GB/s against a copy-bandwidth baseline
+    int bandwidth_mb = 256;    // baseline array size (well above the LLC)
+    int perf_calls = 5;
+    bool auto_engine = false;         // also run label_cc_auto ("Auto")
+    std::string calibration_path;     // table for label_cc_auto
+    std::string calibrate_path;       // regenerate the table and exit
+    int batch_images = 0;             // batch mode: images per size for label_batch scaling
+    std::string baseline_path;        // regression mode: rerun and compare
+    double tolerance = 0.10;          // accepted slowdown on top of measured noise
+    std::set<std::string> engines;    // regression mode: engines present in the baseline
+};
+
+static std::vector<int> parse_int_list(const std::string& s) {
+    std::vector<int> out;
+    std::stringstream ss(s);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(std::stoi(item));
+    }
+    return out;
+}
+
+static void print_usage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "  --reps N           timed samples per case (default 15)\n"
+              << "  --warmup N         untimed warm-up runs (default 2)\n"
+              << "  --min-sample-us X  batch calls until a sample takes X μs (default 1000)\n"
+              << "  --cpu K            pin to CPU K (not with --batch)\n"
+              << "  --sizes a,b,...    square image sizes (default 100,200,500,1000,2000)\n"
+              << "  --engine NAME      only engines whose name contains NAME\n"
+              << "  --eight            8-connectivity\n"
+              << "  --seed S           workload seed (default 42)\n"
+              << "  --csv PATH         CSV output (default bench_results.csv, '' to skip)\n"
+              << "  --json PATH        JSON output\n"
+              << "  --corpus           benchmark the shape-class corpus and rank engines per class\n"
+              << "  --masks DIR        add DIR/*.pgm (python/export_corpus.py) to the corpus\n"
+              << "  --baseline CSV     rerun the configs in CSV and exit 2 on a slowdown\n"
+              << "  --tolerance X      accepted slowdown beyond noise (default 0.10)\n"
+              << "  --auto             also run label_cc_auto and show the engine it picks\n"
+              << "  --calibration CSV  calibration table for label_cc_auto\n"
+              << "  --calibrate CSV    measure a calibration table for this machine (both connectivities) and exit\n"
+              << "  --batch N          label_batch scaling over N images per size and exit\n"
+              << "  --roofline         achieved GB/s per batch engine vs. a STREAM-like copy baseline\n"
+              << "  --bw-mb N          baseline array size in MB (default 256)\n"
+              << "  --trace            per-phase times and internal counters (CCLTrace) for the batch engines\n"
+              << "  --perf             per-phase hardware counters for the batch engines\n"
+              << "  --perf-calls N     instrumented calls averaged per case (default 5)\n";
+}
+
+static bool parse_args(int argc, char* argv[], HarnessConfig& cfg) {
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        auto value = [&](std::string& out) {
+            if (i + 1 >= argc) return false;
+            out = argv[++i];
+            return true;
+        };
+        std::string v;
+        if (a == "--help" || a == "-h") {
+            print_usage(argv[0]);
+            return false;
+        } else if (a == "--eight") {
+            cfg.eight_conn = true;
+        } else if (a == "--corpus") {
+            cfg.corpus = true;
+        } else if (a == "--masks" && value(v)) {
+            cfg.masks_dir = v;
+            cfg.corpus = true;
+        } else if (a == "--baseline" && value(v)) {
+            cfg.baseline_path = v;
+        } else if (a == "--tolerance" && value(v)) {
+            cfg.tolerance = std::stod(v);
+        } else if (a == "--auto") {
+            cfg.auto_engine = true;
+        } else if (a == "--calibration" && value(v)) {
+            cfg.calibration_path = v;
+            cfg.auto_engine = true;
+        } else if (a == "--calibrate" && value(v)) {
+            cfg.calibrate_path = v;
+        } else if (a == "--batch" && value(v)) {
+            cfg.batch_images = std::stoi(v);
+        } else if (a == "--roofline") {
+            cfg.roofline = true;
+        } else if (a == "--bw-mb" && value(v)) {
+            cfg.bandwidth_mb = std::stoi(v);
+        } else if (a == "--trace") {
+            cfg.trace = true;
+        } else if (a == "--perf") {
+            cfg.perf = true;
+        } else if (a == "--perf-calls" && value(v)) {
+            cfg.perf_calls = std::stoi(v);
+        } else if (a == "--reps" && value(v)) {
+            cfg.opts.repetitions = std::stoi(v);
+        } else if (a == "--warmup" && value(v)) {
+            cfg.opts.warmup = std::stoi(v);
+        } else if (a == "--min-sample-us" && value(v)) {
+            cfg.opts.min_sample_us = std::stod(v);
+        } else if (a == "--cpu" && value(v)) {
+            cfg.opts.cpu = std::stoi(v);
+        } else if (a == "--sizes" && value(v)) {
+            cfg.sizes = parse_int_list(v);
+        } else if (a == "--engine" && value(v)) {
+            cfg.engine_filter = v;
+        } else if (a == "--seed" && value(v)) {
+            cfg.seed = std::stoull(v);
+        } else if (a == "--csv" && value(v)) {
+            cfg.csv_path = v;
+        } else if (a == "--json" && value(v)) {
+            cfg.json_path = v;
+        } else {
+            std::cerr << "Unknown or incomplete option: " << a << "\n";
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static int count_components(const std::vector<int32_t>& labels) {
+    std::set<int32_t> comps;
+    for (int32_t l : labels) {
+        if (l > 0) comps.insert(l);
+    }
+    return comps.size();
+}
+
+static void print_record(const BenchRecord& r) {
+    const BenchStats& s = r.stats;
+    std::cout << std::left << std::setw(17) << r.engine;
+    std::cout << std::setw(12) << (std::to_string(r.H) + "x" + std::to_string(r.W));
+    std::cout << std::setw(20) << r.input;
+    std::cout << std::right << std::fixed << std::setprecision(2);
+    std::cout << std::setw(13) << s.median_us;
+    std::cout << std::setw(11) << s.mad_us;
+    std::cout << std::setw(24) << ("[" + std::to_string((int64_t)s.ci_low_us) + ", " +
+                                   std::to_string((int64_t)s.ci_high_us) + "]");
+    std::cout << std::setw(9) << s.outliers;
+    std::cout << std::setw(11) << (r.work_pixels / s.median_us) << " MP/s";
+    std::cout << std::setw(11) << r.components;
+    std::cout << std::setw(12) << r.memory.peak_bytes / 1024;
+    std::cout << "\n";
+}
+
+// One traced call: phase split plus the engine's internal counters
+static void print_trace(const CCLTrace& t) {
+    std::cout << "    trace    " << std::fixed << std::setprecision(1);
+    for (int p = 0; p < (int)CCLPhase::Count; ++p) {
+        if (t.phase_us[p] > 0.0) {
+            std::cout << ccl_phase_name((CCLPhase)p) << " " << t.phase_us[p] << " μs  ";
+        }
+    }
+    std::cout << "| labels " << t.provisional_labels;
+    if (t.label_capacity > 0) {
+        std::cout << "/" << t.label_capacity << " ("
+                  << 100.0 * t.provisional_labels / t.label_capacity << "%)";
+    }
+    if (t.union_calls > 0) {
+        std::cout << "  unions " << t.union_calls << "  merges " << t.merges
+                  << std::setprecision(2) << "  find path " << t.avg_find_path();
+    }
+    if (t.max_frontier > 0) {
+        std::cout << "  frontier " << t.max_frontier;
+    }
+    std::cout << "\n";
+}
+
+// Modelled traffic of the last record against the copy baseline
+static void print_roofline(const BenchRecord& r, const BandwidthBaseline& bw) {
+    double gbs = r.traffic_bytes / r.stats.median_us / 1e3;
+    std::cout << "    roofline " << std::fixed << std::setprecision(1)
+              << r.traffic_bytes / 1e6 << " MB (" << (double)r.traffic_bytes / ((int64_t)r.H * r.W)
+              << " B/px)  " << std::setprecision(2) << gbs << " GB/s  = "
+              << std::setprecision(1) << 100.0 * gbs / bw.copy_gbs << "% of copy bandwidth\n";
+}
+
+// Calibration mode: fastest engine per input, for label_cc_auto
+static int run_calibration(const HarnessConfig& cfg) {
+    std::cout << "\nCalibrating label_cc_auto (sizes";
+    for (int size : cfg.sizes) std::cout << " " << size;
+    std::cout << ")\n\n";
+    std::cout << std::left << std::setw(6) << "Conn" << std::right << std::setw(12) << "Pixels"
+              << std::setw(10) << "Density" << std::setw(10) << "Mean run" << std::setw(11) << "Occupancy"
+              << "   " << std::left << std::setw(14) << "Fastest" << std::right << std::setw(13) << "Median (μs)"
+              << "\n" << std::string(79, '-') << "\n";
+
+    CalibrationTable table;
+    for (bool eight : {false, true}) {
+        for (const auto& p : calibrate_engines(cfg.sizes, eight, cfg.seed, cfg.opts)) {
+            std::cout << std::left << std::setw(6) << (eight ? "8" : "4") << std::right
+                      << std::setw(12) << p.features.pixels << std::fixed << std::setprecision(3)
+                      << std::setw(10) << p.features.density << std::setprecision(2)
+                      << std::setw(10) << p.features.mean_run << std::setw(11) << p.features.row_occupancy
+                      << "   " << std::left << std::setw(14) << p.engine << std::right
+                      << std::setw(13) << p.median_us << "\n";
+            table.push_back(p);
+        }
+    }
+
+    if (!write_calibration(cfg.calibrate_path, table)) {
+        std::cerr << "Failed to write " << cfg.calibrate_path << "\n";
+        return 1;
+    }
+    std::cout << "\nCalibration written to: " << cfg.calibrate_path
+              << " (use with --calibration or CCL_CALIBRATION)\n";
+    return 0;
+}
+
+// Batch mode: sequential label_cc_2pass vs. label_batch at 1, 2, 4, ... threads
+static int run_batch_scaling(const HarnessConfig& cfg) {
+    int max_threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    std::cout << "\nBatch labeling: " << cfg.batch_images << " images per size (shape corpus, cycled), "
+              << max_threads << " hardware threads\n\n";
+    std::cout << std::left << std::setw(12) << "Size" << std::setw(14) << "Mode" << std::right
+              << std::setw(9) << "Threads" << std::setw(14) << "Wall (ms)" << std::setw(14) << "Images/s"
+              << std::setw(10) << "Speedup" << std::setw(12) << "Steals" << std::setw(16) << "Allocs/image"
+              << "\n" << std::string(101, '-') << "\n";
+
+    for (int size : cfg.sizes) {
+        std::vector<CorpusImage> corpus = synthetic_corpus({size}, cfg.seed);
+        std::vector<ImageView> views;
+        for (int i = 0; i < cfg.batch_images; ++i) {
+            const CorpusImage& c = corpus[i % corpus.size()];
+            views.emplace_back(c.mask, c.H, c.W);
+        }
+
+        auto row = [&](const char* mode, int threads, double wall_us, double base_us, int64_t steals,
+                       const AllocStats& mem) {
+            std::cout << std::left << std::setw(12) << (std::to_string(size) + "x" + std::to_string(size))
+                      << std::setw(14) << mode << std::right << std::setw(9) << threads << std::fixed
+                      << std::setprecision(2) << std::setw(14) << wall_us / 1e3 << std::setprecision(1)
+                      << std::setw(14) << views.size() / (wall_us / 1e6) << std::setprecision(2)
+                      << std::setw(10) << base_us / wall_us << std::setw(12) << steals << std::setprecision(1)
+                      << std::setw(16) << (double)mem.allocations / views.size() << "\n";
+        };
+
+        double sequential_us;
+        {
+            AllocScope scope;
+            auto t0 = std::chrono::steady_clock::now();
+            for (const auto& v : views) label_cc_2pass(v.data, v.H, v.W, cfg.eight_conn);
+            sequential_us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+            row("sequential", 1, sequential_us, sequential_us, 0, scope.stop());
+        }
+
+        for (int threads = 1; ; threads = std::min(threads * 2, max_threads)) {
+            BatchOptions opts;
+            opts.threads = threads;
+            opts.eight_connectivity = cfg.eight_conn;
+            WorkStealingPool pool(threads);
+            BatchStats stats;
+            AllocScope scope;
+            label_batch(pool, views, opts, &stats);
+            row("label_batch", threads, stats.wall_us, sequential_us, stats.steals, scope.stop());
+            if (threads == max_threads) break;
+        }
+
+        // Foreground-bbox cropping on top, at full width
+        {
+            BatchOptions opts;
+            opts.threads = max_threads;
+            opts.eight_connectivity = cfg.eight_conn;
+            opts.crop = true;
+            WorkStealingPool pool(max_threads);
+            BatchStats stats;
+            AllocScope scope;
+            label_batch(pool, views, opts, &stats);
+            row("batch + crop", max_threads, stats.wall_us, sequential_us, stats.steals, scope.stop());
+        }
+    }
+    return 0;
+}
+
+static void print_perf_cell(const PerfCounters& counters, const PerfSample& s, PerfEvent e, int width) {
+    if (counters.has(e)) {
+        std::cout << std::setw(width) << (int64_t)s[e];
+    } else {
+        std::cout << std::setw(width) << "n/a";
+    }
+}
+
+static void print_perf_row(const PerfCounters& counters, const char* label, const PerfSample& s) {
+    std::cout << "    " << std::left << std::setw(10) << label << std::right;
+    print_perf_cell(counters, s, PerfEvent::Cycles, 14);
+    print_perf_cell(counters, s, PerfEvent::Instructions, 14);
+    if (counters.has(PerfEvent::Cycles) && counters.has(PerfEvent::Instructions) &&
+        s[PerfEvent::Cycles] > 0) {
+        std::cout << std::setw(7) << std::setprecision(2)
+                  << s[PerfEvent::Instructions] / s[PerfEvent::Cycles];
+    } else {
+        std::cout << std::setw(7) << "n/a";
+    }
+    print_perf_cell(counters, s, PerfEvent::LLCMisses, 12);
+    print_perf_cell(counters, s, PerfEvent::BranchMisses, 12);
+    print_perf_cell(counters, s, PerfEvent::DTLBMisses, 12);
+    std::cout << "\n";
+}
+
+// Per-call counters for the whole engine and each phase it reports
+static void print_perf(PerfCounters& counters, const std::function<void()>& fn, int calls) {
+    PerfPhaseRecorder recorder(counters);
+    recorder.run(fn, calls);
+
+    std::cout << "    " << std::left << std::setw(10) << "phase" << std::right;
+    std::cout << std::setw(14) << "cycles" << std::setw(14) << "instr" << std::setw(7) << "IPC";
+    std::cout << std::setw(12) << "LLC miss" << std::setw(12) << "br miss" << std::setw(12) << "dTLB miss";
+    std::cout << "\n";
+    print_perf_row(counters, "total", recorder.total());
+    for (int p = 0; p < (int)CCLPhase::Count; ++p) {
+        PerfSample s = recorder.phase((CCLPhase)p);
+        bool seen = false;
+        for (int i = 0; i < PERF_EVENT_COUNT; ++i) seen = seen || s.value[i] != 0.0;
+        if (seen) print_perf_row(counters, ccl_phase_name((CCLPhase)p), s);
+    }
+}
+
+static void print_class_ranking(const std::vector<BenchRecord>& records) {
+    std::cout << std::string(139, '=') << "\n";
+    std::cout << "ENGINE RANKING PER CORPUS CLASS (geometric mean throughput)\n";
+    std::cout << std::string(139, '-') << "\n";
+    for (const auto& [cls, ranks] : rank_engines_by_class(records)) {
+        std::cout << std::left << std::setw(12) << cls;
+        for (size_t i = 0; i < ranks.size(); ++i) {
+            std::cout << (i ? "  >  " : "") << ranks[i].engine << " " << std::fixed
+                      << std::setprecision(1) << ranks[i].geomean_mps << " MP/s";
+            if (i > 0) std::cout << " (" << std::setprecision(2) << ranks[i].relative << "x)";
+        }
+        std::cout << "\n";
+    }
+}
+
+// Take sizes, connectivity, seed, input set and engines from a baseline run
+static void configure_from_baseline(const std::vector<BenchRecord>& baseline, HarnessConfig& cfg) {
+    std::set<int> sizes;
+    for (const auto& r : baseline) {
+        cfg.engines.insert(r.engine);
+        if (r.engine == "Auto") cfg.auto_engine = true;  // Auto rows only run with --auto
+        bool standard = false;
+        for (const auto& input : cfg.inputs) standard = standard || r.input == input.name;
+        if (!standard) cfg.corpus = true;
+        if (r.H == r.W && corpus_class(r.input) != "lesion") sizes.insert(r.H);
+    }
+    cfg.sizes.assign(sizes.begin(), sizes.end());
+    cfg.eight_conn = baseline.front().eight_conn;
+    if (baseline.front().seed != 0) cfg.seed = baseline.front().seed;
+}
+
+// Returns the number of failed cases (slower, or different component count)
+static int print_regressions(const std::vector<BenchRecord>& baseline,
+                             const std::vector<BenchRecord>& records, double tolerance) {
+    std::vector<BenchRecord> missing;
+    auto results = compare_to_baseline(baseline, records, tolerance, &missing);
+
+    std::cout << std::string(139, '=') << "\n";
+    std::cout << "REGRESSION CHECK (tolerance " << tolerance * 100 << "% + 3 sigma of MAD noise)\n";
+    std::cout << std::string(139, '-') << "\n";
+    std::cout << std::left << std::setw(17) << "Engine" << std::setw(12) << "Size" << std::setw(20) << "Input";
+    std::cout << std::right << std::setw(16) << "Baseline (μs)" << std::setw(16) << "Current (μs)";
+    std::cout << std::setw(10) << "Ratio" << std::setw(14) << "Limit (μs)" << "  Status\n";
+
+    int regressions = 0;
+    for (const auto& r : results) {
+        std::cout << std::left << std::setw(17) << r.current.engine;
+        std::cout << std::setw(12) << (std::to_string(r.current.H) + "x" + std::to_string(r.current.W));
+        std::cout << std::setw(20) << r.current.input;
+        std::cout << std::right << std::fixed << std::setprecision(2);
+        std::cout << std::setw(16) << r.baseline.stats.median_us;
+        std::cout << std::setw(16) << r.current.stats.median_us;
+        std::cout << std::setw(9) << r.ratio << "x";
+        std::cout << std::setw(14) << r.threshold_us;
+        if (r.mismatch) {
+            std::cout << "  MISMATCH (" << r.baseline.components << " -> " << r.current.components << " components)\n";
+        } else {
+            std::cout << "  " << (r.regressed ? "REGRESSED" : "ok") << "\n";
+        }
+        if (r.regressed || r.mismatch) regressions++;
+    }
+    for (const auto& m : missing) {
+        std::cout << std::left << std::setw(17) << m.engine
+                  << std::setw(12) << (std::to_string(m.H) + "x" + std::to_string(m.W))
+                  << std::setw(20) << m.input << "  not rerun (missing input, e.g. --masks)\n";
+    }
+    std::cout << std::string(139, '-') << "\n";
+    std::cout << results.size() << " cases compared, " << regressions << " failed, "
+              << missing.size() << " not rerun\n";
+    return regressions;
+}
+
+int main(int argc, char* argv[]) {
+    HarnessConfig cfg;
+    if (!parse_args(argc, argv, cfg)) {
+        return 1;
+    }
+
+    std::vector<BenchRecord> baseline;
+    if (!cfg.baseline_path.empty()) {
+        std::string error;
+        if (!read_results_csv(cfg.baseline_path, baseline, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        if (baseline.empty()) {
+            std::cerr << "Error: " << cfg.baseline_path << " has no results\n";
+            return 1;
+        }
+        configure_from_baseline(baseline, cfg);
+        if (cfg.csv_path == cfg.baseline_path) {
+            cfg.csv_path.clear();  // never overwrite the baseline being checked
+        }
+    }
+    // Pool threads inherit the affinity, so a pinned scaling run would only
+    // time-slice one CPU
+    if (cfg.opts.cpu >= 0 && cfg.batch_images > 0) {
+        std::cerr << "Error: --cpu cannot be combined with --batch\n";
+        return 1;
+    }
+    if (cfg.opts.cpu >= 0 && !pin_to_cpu(cfg.opts.cpu)) {
+        std::cerr << "Warning: could not pin to CPU " << cfg.opts.cpu << "\n";
+    }
+    if (!cfg.calibrate_path.empty()) {
+        return run_calibration(cfg);
+    }
+    if (cfg.batch_images > 0) {
+        return run_batch_scaling(cfg);
+    }
+    if (!cfg.calibration_path.empty()) {
+        CalibrationTable table;
+        std::string error;
+        if (!read_calibration(cfg.calibration_path, table, error)) {
+            std::cerr << "Error: " << error << "\n";
+            return 1;
+        }
+        set_calibration(std::move(table));
+    }
+
+    std::cout << "\n" << std::string(139, '=') << "\n";
+    std::cout << "CCL BENCHMARK HARNESS\n";
+    std::cout << std::string(139, '=') << "\n";
+    std::cout << "Connectivity: " << (cfg.eight_conn ? "8" : "4") << "\n";
+    std::cout << "Samples: " << cfg.opts.repetitions << " (warm-up " << cfg.opts.warmup
+              << ", min sample " << cfg.opts.min_sample_us << " μs)\n";
+    std::cout << "CPU pinning: " << (cfg.opts.cpu >= 0 ? std::to_string(cfg.opts.cpu) : "off") << "\n";
+    std::cout << "Seed: " << cfg.seed << "\n";
+    if (!baseline.empty()) {
+        std::cout << "Baseline: " << cfg.baseline_path << " (" << baseline.size() << " cases)\n";
+    }
+
+    BandwidthBaseline bandwidth = {};
+    if (cfg.roofline) {
+        bandwidth = measure_bandwidth((size_t)cfg.bandwidth_mb << 20, cfg.opts);
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Bandwidth baseline (" << cfg.bandwidth_mb << " MB arrays): copy " << bandwidth.copy_gbs
+                  << " GB/s, scan " << bandwidth.scan_gbs << " GB/s, fill " << bandwidth.fill_gbs << " GB/s\n";
+    }
+
+    PerfCounters counters;
+    if (cfg.perf) {
+        if (counters.available()) {
+            std::cout << "Perf counters: on (" << cfg.perf_calls << " calls per case)";
+            if (!counters.error().empty()) std::cout << ", unavailable: " << counters.error();
+            std::cout << "\n";
+        } else {
+            std::cout << "Perf counters: unavailable (" << counters.error() << "), skipping\n";
+            cfg.perf = false;
+        }
+    }
+    std::cout << "\n";
+
+    std::cout << std::left << std::setw(17) << "Engine";
+    std::cout << std::setw(12) << "Size";
+    std::cout << std::setw(20) << "Input";
+    std::cout << std::right << std::setw(13) << "Median (μs)";
+    std::cout << std::setw(11) << "MAD (μs)";
+    std::cout << std::setw(24) << "95% CI (μs)";
+    std::cout << std::setw(9) << "Outl.";
+    std::cout << std::setw(16) << "Throughput";
+    std::cout << std::setw(11) << "Comps";
+    std::cout << std::setw(12) << "Peak (KB)";
+    std::cout << "\n" << std::string(139, '-') << "\n";
+
+    auto selected = [&](const std::string& name) {
+        if (!cfg.engines.empty() && !cfg.engines.count(name)) return false;
+        return cfg.engine_filter.empty() || name.find(cfg.engine_filter) != std::string::npos;
+    };
+
+    std::vector<BenchRecord> records;
+
+    // One input: every selected engine, plus the stream engines when `pixels` is given
+    auto run_case = [&](const std::string& input, int H, int W, const std::vector<uint8_t>& img,
+                        const std::vector<std::pair<int, int>>* pixels) {
+        int64_t work = pixels ? (int64_t)pixels->size() : (int64_t)H * W;
+
+        auto record = [&](const std::string& engine, const std::function<void()>& fn, int comps) {
+            BenchRecord r;
+            r.engine = engine;
+            r.input = input;
+            r.H = H;
+            r.W = W;
+            r.eight_conn = cfg.eight_conn;
+            r.work_pixels = work;
+            r.components = comps;
+            r.seed = cfg.seed;
+            r.stats = run_benchmark(fn, cfg.opts);
+            AllocScope scope;
+            fn();
+            r.memory = scope.stop();
+            print_record(r);
+            records.push_back(r);
+        };
+
+        // Batch engines label the (possibly stream-built) full image
+        for (const auto& e : batch_engines()) {
+            if (!selected(e.name)) continue;
+            LabelFunc fn = e.fn;
+            int comps = count_components(fn(img.data(), H, W, cfg.eight_conn));
+            record(e.name, [&] { fn(img.data(), H, W, cfg.eight_conn); }, comps);
+            if (cfg.trace || cfg.roofline) {
+                CCLTrace trace;
+                e.traced(img.data(), H, W, cfg.eight_conn, trace);
+                if (cfg.trace) print_trace(trace);
+                if (cfg.roofline) {
+                    BenchRecord& r = records.back();
+                    r.traffic_bytes = e.traffic(H, W, trace);
+                    print_roofline(r, bandwidth);
+                }
+            }
+            if (cfg.perf) {
+                print_perf(counters, [&] { fn(img.data(), H, W, cfg.eight_conn); }, cfg.perf_calls);
+            }
+        }
+
+        if (cfg.auto_engine && selected("Auto")) {
+            int comps = count_components(label_cc_auto(img.data(), H, W, cfg.eight_conn));
+            record("Auto", [&] { label_cc_auto(img.data(), H, W, cfg.eight_conn); }, comps);
+            std::cout << "    auto -> "
+                      << select_engine(sample_features(img.data(), H, W), cfg.eight_conn, active_calibration())
+                      << "\n";
+        }
+
+        if (!pixels) return;
+
+        // Stream engines consume the pixel list directly
+        if (selected("Stream DSU")) {
+            StreamDSU check(H, W, cfg.eight_conn);
+            check.add_pixels(*pixels);
+            record("Stream DSU", [&] {
+                StreamDSU stream(H, W, cfg.eight_conn);
+                for (const auto& p : *pixels) stream.add_pixel(p.first, p.second);
+            }, check.get_component_count());
+        }
+        if (selected("Incremental DSU")) {
+            std::vector<uint8_t> empty((size_t)H * W, 0);
+            IncrementalDSU check(H, W, cfg.eight_conn);
+            check.initialize(empty.data());
+            for (const auto& p : *pixels) check.add_pixel(p.first, p.second);
+            record("Incremental DSU", [&] {
+                IncrementalDSU inc(H, W, cfg.eight_conn);
+                inc.initialize(empty.data());
+                for (const auto& p : *pixels) inc.add_pixel(p.first, p.second);
+            }, check.get_component_count());
+        }
+    };
+
+    if (cfg.corpus) {
+        std::vector<CorpusImage> corpus = synthetic_corpus(cfg.sizes, cfg.seed);
+        if (!cfg.masks_dir.empty()) {
+            std::string error;
+            if (!load_mask_corpus(cfg.masks_dir, "lesion", corpus, error)) {
+                std::cerr << "Error: " << error << "\n";
+                return 1;
+            }
+        }
+        for (const auto& c : corpus) {
+            run_case(c.label(), c.H, c.W, c.mask, nullptr);
+        }
+    } else {
+        for (int size : cfg.sizes) {
+            for (const auto& input : cfg.inputs) {
+                uint64_t seed = derive_seed(cfg.seed, input.name + "@" + std::to_string(size));
+                if (input.is_stream) {
+                    auto pixels = sample_pixels(size, size, (int)(size * size * input.ratio), seed);
+                    run_case(input.name, size, size, pixels_to_image(pixels, size, size), &pixels);
+                } else {
+                    run_case(input.name, size, size, generate_random_image(size, size, input.ratio, seed), nullptr);
+                }
+            }
+        }
+    }
+
+    if (cfg.corpus) {
+        print_class_ranking(records);
+    }
+
+    std::cout << std::string(139, '=') << "\n";
+    if (!cfg.csv_path.empty()) {
+        if (write_results_csv(cfg.csv_path, records)) {
+            std::cout << "Results exported to: " << cfg.csv_path << "\n";
+        } else {
+            std::cerr << "Failed to write " << cfg.csv_path << "\n";
+        }
+    }
+    if (!cfg.json_path.empty()) {
+        if (write_results_json(cfg.json_path, records)) {
+            std::cout << "Results exported to: " << cfg.json_path << "\n";
+        } else {
+            std::cerr << "Failed to write " << cfg.json_path << "\n";
+        }
+    }
+
+    if (!baseline.empty() && print_regressions(baseline, records, cfg.tolerance) > 0) {
+        return 2;
+    }
+    return 0;
+}
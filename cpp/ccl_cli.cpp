@@ -0,0 +1,287 @@
+#include "mask_io.hpp"
+#include "component_stats.hpp"
+#include "dsu_2pass.hpp"
+#include "work_pool.hpp"
+#include <iostream>
+#include <iomanip>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <future>
+#include <algorithm>
+#include <filesystem>
+#include <charconv>
+#include <unordered_map>
+
+// Label mask files in parallel: ccl_cli INPUT... --out DIR
+//
+// Files are processed in chunks through a three-stage pipeline. While the
+// pool labels chunk k, one thread maps (and faults in) chunk k + 1 and
+// another writes the labels and stats of chunk k - 1, so disk and CPU
+// overlap.
+
+namespace fs = std::filesystem;
+
+static void print_usage(const char* prog) {
+    std::cout << "Usage: " << prog << " INPUT... [options]\n"
+              << "  INPUT              mask file (.npy uint8/bool, PGM/PBM, or raw with --raw),\n"
+              << "                     directory (its mask files, sorted), or @LIST (one path per line)\n"
+              << "  --out DIR          output directory (default: labels)\n"
+              << "  --raw HxW          size of headerless 8-bit masks\n"
+              << "  --eight            8-connectivity\n"
+              << "  --threads N        labeling threads (default: hardware concurrency)\n"
+              << "  --compress         write deflated .npz instead of .npy\n"
+              << "  --stats FILE       per-component CSV (default: DIR/components.csv)\n"
+              << "  --no-labels        write only the stats\n"
+              << "  --chunk K          files per pipeline stage (default: 2 x threads)\n";
+}
+
+static bool is_mask_file(const fs::path& p) {
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext == ".npy" || ext == ".pgm" || ext == ".pbm" || ext == ".pnm" || ext == ".raw" || ext == ".bin";
+}
+
+static bool collect_inputs(const std::vector<std::string>& args, std::vector<std::string>& files, std::string& error) {
+    for (const auto& a : args) {
+        if (!a.empty() && a[0] == '@') {
+            std::ifstream list(a.substr(1));
+            if (!list) {
+                error = "cannot read list " + a.substr(1);
+                return false;
+            }
+            std::string line;
+            while (std::getline(list, line)) {
+                if (!line.empty() && line[0] != '#') files.push_back(line);
+            }
+        } else if (fs::is_directory(a)) {
+            std::vector<std::string> found;
+            for (const auto& e : fs::directory_iterator(a)) {
+                if (e.is_regular_file() && is_mask_file(e.path())) found.push_back(e.path().string());
+            }
+            std::sort(found.begin(), found.end());
+            files.insert(files.end(), found.begin(), found.end());
+        } else {
+            files.push_back(a);
+        }
+    }
+    return true;
+}
+
+// Outputs are named DIR/<stem>, so two inputs with the same stem (a.npy and
+// a.pgm, or the same name in two directories) would overwrite each other
+static bool check_unique_stems(const std::vector<std::string>& files, std::string& error) {
+    std::unordered_map<std::string, const std::string*> seen;
+    for (const auto& f : files) {
+        auto [it, inserted] = seen.emplace(fs::path(f).stem().string(), &f);
+        if (!inserted) {
+            error = "inputs " + *it->second + " and " + f + " would both write labels named " + it->first;
+            return false;
+        }
+    }
+    return true;
+}
+
+// RFC 4180 field: quoted, with quotes doubled, when it holds a separator,
+// quote or line break
+static std::string csv_field(const std::string& s) {
+    if (s.find_first_of(",\"\r\n") == std::string::npos) return s;
+    std::string q = "\"";
+    for (char c : s) {
+        if (c == '"') q += '"';
+        q += c;
+    }
+    return q + '"';
+}
+
+// CSV rows for one file; formatted on the labeling workers, since a noisy
+// mask can have 10^5 components and iostream formatting would dominate
+static void append_stats_csv(std::string& out, const std::string& path, const std::vector<ComponentStats>& stats) {
+    const std::string file = csv_field(path);
+    char buf[32];
+    auto put = [&](auto v) {
+        auto r = std::to_chars(buf, buf + sizeof(buf), v);
+        out.append(buf, r.ptr);
+    };
+    for (const ComponentStats& s : stats) {
+        out += file;
+        for (int v : {(int)s.id, s.size, s.min_y, s.min_x, s.max_y, s.max_x}) {
+            out += ',';
+            put(v);
+        }
+        out += ',';
+        put(s.centroid_y);
+        out += ',';
+        put(s.centroid_x);
+        out += ',';
+        put(s.perimeter);
+        out += '\n';
+    }
+}
+
+struct Item {
+    std::string path;
+    MaskFile mask;  // released once labeled
+    int H = 0, W = 0;
+    std::vector<int32_t> labels;
+    std::string csv_rows;
+    int components = 0;
+    std::string error;
+};
+
+using Chunk = std::vector<Item>;
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> inputs;
+    std::string out_dir = "labels", stats_path;
+    int raw_h = 0, raw_w = 0, threads = 0, chunk_size = 0;
+    bool eight = false, compress = false, write_labels = true;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (a == "--out" && has_value) {
+            out_dir = argv[++i];
+        } else if (a == "--raw" && has_value) {
+            std::string v = argv[++i];
+            size_t x = v.find('x');
+            if (x == std::string::npos) {
+                std::cerr << "Error: --raw expects HxW\n";
+                return 1;
+            }
+            raw_h = std::stoi(v.substr(0, x));
+            raw_w = std::stoi(v.substr(x + 1));
+        } else if (a == "--eight") {
+            eight = true;
+        } else if (a == "--threads" && has_value) {
+            threads = std::stoi(argv[++i]);
+        } else if (a == "--compress") {
+            compress = true;
+        } else if (a == "--stats" && has_value) {
+            stats_path = argv[++i];
+        } else if (a == "--no-labels") {
+            write_labels = false;
+        } else if (a == "--chunk" && has_value) {
+            chunk_size = std::stoi(argv[++i]);
+        } else if (a == "--help" || a == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (!a.empty() && a[0] == '-' && a.size() > 1) {
+            std::cerr << "Unknown or incomplete option: " << a << "\n";
+            print_usage(argv[0]);
+            return 1;
+        } else {
+            inputs.push_back(a);
+        }
+    }
+    if (inputs.empty()) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (compress && !npz_supported()) {
+        std::cerr << "Error: built without zlib, --compress is unavailable\n";
+        return 1;
+    }
+
+    std::vector<std::string> files;
+    std::string error;
+    if (!collect_inputs(inputs, files, error) || (write_labels && !check_unique_stems(files, error))) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+    std::error_code ec;
+    fs::create_directories(out_dir, ec);
+    if (stats_path.empty()) stats_path = (fs::path(out_dir) / "components.csv").string();
+    std::ofstream csv(stats_path);
+    if (!csv) {
+        std::cerr << "Error: cannot write " << stats_path << "\n";
+        return 1;
+    }
+    csv << "File,Label,Area,MinY,MinX,MaxY,MaxX,CentroidY,CentroidX,Perimeter\n";
+
+    WorkStealingPool pool(threads);
+    std::vector<CCLWorkspace> workspaces(pool.size());
+    if (chunk_size <= 0) chunk_size = 2 * pool.size();
+
+    using clock = std::chrono::steady_clock;
+    auto seconds_since = [](clock::time_point t) { return std::chrono::duration<double>(clock::now() - t).count(); };
+    double read_s = 0, label_s = 0, write_s = 0;
+    int64_t pixels = 0, components = 0;
+    int failures = 0;
+
+    auto read_chunk = [&](size_t begin) {
+        auto t0 = clock::now();
+        Chunk chunk(std::min(files.size(), begin + chunk_size) - begin);
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            chunk[i].path = files[begin + i];
+            if (open_mask(chunk[i].path, raw_h, raw_w, chunk[i].mask, chunk[i].error)) {
+                chunk[i].H = chunk[i].mask.view.H;
+                chunk[i].W = chunk[i].mask.view.W;
+            }
+        }
+        read_s += seconds_since(t0);
+        return chunk;
+    };
+
+    auto write_chunk = [&](Chunk chunk) {
+        auto t0 = clock::now();
+        for (Item& item : chunk) {
+            if (item.error.empty() && write_labels) {
+                fs::path out = fs::path(out_dir) / fs::path(item.path).stem();
+                out += compress ? ".npz" : ".npy";
+                LabelView labels(item.labels, item.H, item.W);
+                if (compress) {
+                    write_npz(out.string(), labels, item.error);
+                } else {
+                    write_npy(out.string(), labels, item.error);
+                }
+            }
+            if (!item.error.empty()) {
+                std::cerr << "Error: " << item.error << "\n";
+                failures++;
+                continue;
+            }
+            csv.write(item.csv_rows.data(), (std::streamsize)item.csv_rows.size());
+            pixels += (int64_t)item.H * item.W;
+            components += item.components;
+        }
+        write_s += seconds_since(t0);
+    };
+
+    auto start = clock::now();
+    std::future<Chunk> next = std::async(std::launch::async, read_chunk, 0);
+    std::future<void> writing;
+    for (size_t begin = 0; begin < files.size(); begin += chunk_size) {
+        Chunk chunk = next.get();
+        if (begin + chunk_size < files.size()) {
+            next = std::async(std::launch::async, read_chunk, begin + chunk_size);
+        }
+
+        auto t0 = clock::now();
+        pool.run((int64_t)chunk.size(), [&](int64_t i, int worker) {
+            Item& item = chunk[i];
+            if (!item.error.empty()) return;
+            item.labels.resize((size_t)item.H * item.W);
+            LabelView labels(item.labels, item.H, item.W);
+            item.components = label_cc_2pass(item.mask.view, labels, eight, workspaces[worker]);
+            append_stats_csv(item.csv_rows, item.path, component_stats(labels, item.components));
+            item.mask = MaskFile();  // unmap the input now, not after the write
+        });
+        label_s += seconds_since(t0);
+
+        if (writing.valid()) writing.get();
+        writing = std::async(std::launch::async, write_chunk, std::move(chunk));
+    }
+    if (writing.valid()) writing.get();
+    double wall_s = seconds_since(start);
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Labeled " << files.size() - failures << " of " << files.size() << " files (" << components
+              << " components, " << pixels / 1e6 << " MP) on " << pool.size() << " threads"
+              << (eight ? ", 8-connectivity" : "") << "\n";
+    std::cout << "Wall " << wall_s << " s (" << pixels / 1e6 / std::max(wall_s, 1e-9) << " MP/s); busy: read "
+              << read_s << " s, label " << label_s << " s, write " << write_s << " s\n";
+    if (write_labels) std::cout << "Labels: " << out_dir << "/*" << (compress ? ".npz" : ".npy") << "\n";
+    std::cout << "Stats: " << stats_path << "\n";
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+#include "label_service.hpp"
+#include "workload.hpp"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#include <unistd.h>
+
+// Load generator for ccl_server: C client threads, each with its own
+// connection and shm segments, send N labeling requests back to back and
+// record the round-trip latency of every call.
+
+static void print_usage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "  --socket PATH      server socket (default /tmp/ccl_server.sock)\n"
+              << "  --clients C        concurrent connections (default 4)\n"
+              << "  --requests N       requests per client (default 200)\n"
+              << "  --size HxW         mask size (default 512x512)\n"
+              << "  --density D        foreground density of the random masks (default 0.3)\n"
+              << "  --eight            8-connectivity\n"
+              << "  --crop             ask the server to label only the foreground bbox\n"
+              << "  --verify           check every reply against in-process label_cc_2pass\n"
+              << "  --shutdown         stop the server when done\n";
+}
+
+struct ClientResult {
+    std::vector<double> latency_us;
+    double queue_us = 0, label_us = 0;
+    int ok = 0;  // replies with status 0
+    int failures = 0;
+    std::string error;
+};
+
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t i = (size_t)std::min<double>(sorted.size() - 1, p * (sorted.size() - 1) + 0.5);
+    return sorted[i];
+}
+
+int main(int argc, char* argv[]) {
+    std::string socket_path = "/tmp/ccl_server.sock";
+    int clients = 4, requests = 200, H = 512, W = 512;
+    double density = 0.3;
+    bool eight = false, crop = false, verify = false, shutdown = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (a == "--socket" && has_value) {
+            socket_path = argv[++i];
+        } else if (a == "--clients" && has_value) {
+            clients = std::max(1, std::stoi(argv[++i]));
+        } else if (a == "--requests" && has_value) {
+            requests = std::max(1, std::stoi(argv[++i]));
+        } else if (a == "--size" && has_value) {
+            std::string v = argv[++i];
+            size_t x = v.find('x');
+            if (x == std::string::npos) {
+                std::cerr << "Error: --size expects HxW\n";
+                return 1;
+            }
+            H = std::stoi(v.substr(0, x));
+            W = std::stoi(v.substr(x + 1));
+        } else if (a == "--density" && has_value) {
+            density = std::stod(argv[++i]);
+        } else if (a == "--eight") {
+            eight = true;
+        } else if (a == "--crop") {
+            crop = true;
+        } else if (a == "--verify") {
+            verify = true;
+        } else if (a == "--shutdown") {
+            shutdown = true;
+        } else if (a == "--help" || a == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown or incomplete option: " << a << "\n";
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    using clock = std::chrono::steady_clock;
+    std::vector<ClientResult> results(clients);
+    std::vector<std::thread> threads;
+    auto start = clock::now();
+    for (int c = 0; c < clients; ++c) {
+        threads.emplace_back([&, c] {
+            ClientResult& r = results[c];
+            std::string prefix = "/ccl_lg_" + std::to_string(getpid()) + "_" + std::to_string(c);
+            SharedMemory in, out;
+            LabelClient client;
+            if (!in.create(prefix + "_in", (size_t)H * W, r.error) ||
+                !out.create(prefix + "_out", (size_t)H * W * sizeof(int32_t), r.error) ||
+                !client.connect(socket_path, r.error)) {
+                r.failures = requests;
+                return;
+            }
+            auto img = generate_random_image(H, W, density, 1000 + c);
+            std::memcpy(in.data(), img.data(), img.size());
+            std::vector<int32_t> expected;
+            if (verify) expected = label_cc_2pass(img.data(), H, W, eight);
+
+            LabelRequest req;
+            std::strncpy(req.input, in.name().c_str(), sizeof(req.input) - 1);
+            std::strncpy(req.output, out.name().c_str(), sizeof(req.output) - 1);
+            req.H = H;
+            req.W = W;
+            req.eight_connectivity = eight;
+            req.crop = crop;
+            r.latency_us.reserve(requests);
+            for (int i = 0; i < requests; ++i) {
+                LabelReply reply;
+                auto t0 = clock::now();
+                if (!client.call(req, reply, r.error)) {
+                    r.failures += requests - i;
+                    return;
+                }
+                r.latency_us.push_back(std::chrono::duration<double, std::micro>(clock::now() - t0).count());
+                if (reply.status != 0) {
+                    r.failures++;
+                    r.error = reply.error;
+                    continue;
+                }
+                r.ok++;
+                r.queue_us += reply.queue_us;
+                r.label_us += reply.label_us;
+                if (verify && std::memcmp(out.data(), expected.data(), expected.size() * sizeof(int32_t)) != 0) {
+                    r.failures++;
+                    r.error = "labels differ from label_cc_2pass";
+                }
+            }
+        });
+    }
+    for (auto& t : threads) t.join();
+    double wall_s = std::chrono::duration<double>(clock::now() - start).count();
+
+    std::vector<double> all;
+    double queue_us = 0, label_us = 0;
+    int failures = 0, ok = 0;
+    for (const auto& r : results) {
+        all.insert(all.end(), r.latency_us.begin(), r.latency_us.end());
+        queue_us += r.queue_us;
+        label_us += r.label_us;
+        failures += r.failures;
+        ok += r.ok;
+        if (!r.error.empty()) std::cerr << "Client error: " << r.error << "\n";
+    }
+    std::sort(all.begin(), all.end());
+
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "Requests: " << all.size() << " (" << clients << " clients x " << requests << ", " << H << "x"
+              << W << ", density " << density << "), failures " << failures << "\n";
+    std::cout << "Throughput: " << all.size() / wall_s << " requests/s, "
+              << all.size() * (double)H * W / wall_s / 1e6 << " MP/s\n";
+    std::cout << "Latency us: p50 " << percentile(all, 0.5) << ", p95 " << percentile(all, 0.95) << ", p99 "
+              << percentile(all, 0.99) << ", max " << (all.empty() ? 0.0 : all.back()) << "\n";
+    std::cout << "Server mean: queue " << queue_us / std::max(ok, 1) << " us, label " << label_us / std::max(ok, 1)
+              << " us (" << ok << " successful replies)\n";
+
+    LabelClient control;
+    std::string error;
+    LabelRequest req;
+    req.op = shutdown ? ServiceOp::Shutdown : ServiceOp::Stats;
+    LabelReply reply;
+    if (control.connect(socket_path, error) && control.call(req, reply, error)) {
+        std::cout << "Server: " << reply.requests << " labels in " << reply.batches << " batches on "
+                  << reply.threads << " threads" << (shutdown ? ", shut down" : "") << "\n";
+    }
+    return failures == 0 ? 0 : 1;
+}
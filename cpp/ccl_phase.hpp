@@ -0,0 +1,73 @@
+#ifndef CCL_PHASE_HPP
+#define CCL_PHASE_HPP
+
+// Phase markers inside the labeling engines.
+//
+// Engines wrap each phase in a CCLPhaseScope. Nothing happens unless a
+// PhaseObserver is installed on the calling thread (e.g. by the perf
+// counter instrumentation), so the cost when unused is one thread-local
+// load and branch per phase, not per pixel.
+
+enum class CCLPhase {
+    Scan,     // first pass over the image (provisional labels / unions / flood fill)
+    Resolve,  // equivalence resolution (DSU roots -> final labels)
+    Relabel,  // final pass writing labels
+    Count
+};
+
+inline const char* ccl_phase_name(CCLPhase phase) {
+    switch (phase) {
+        case CCLPhase::Scan:    return "scan";
+        case CCLPhase::Resolve: return "resolve";
+        case CCLPhase::Relabel: return "relabel";
+        default:                return "?";
+    }
+}
+
+class PhaseObserver {
+public:
+    virtual ~PhaseObserver() = default;
+    virtual void begin_phase(CCLPhase phase) = 0;
+    virtual void end_phase(CCLPhase phase) = 0;
+};
+
+inline PhaseObserver*& current_phase_observer() {
+    static thread_local PhaseObserver* observer = nullptr;
+    return observer;
+}
+
+// Install an observer for the lifetime of this object (restores the previous one)
+class ScopedPhaseObserver {
+private:
+    PhaseObserver* previous;
+
+public:
+    explicit ScopedPhaseObserver(PhaseObserver* observer)
+        : previous(current_phase_observer()) {
+        current_phase_observer() = observer;
+    }
+    ~ScopedPhaseObserver() {
+        current_phase_observer() = previous;
+    }
+    ScopedPhaseObserver(const ScopedPhaseObserver&) = delete;
+    ScopedPhaseObserver& operator=(const ScopedPhaseObserver&) = delete;
+};
+
+class CCLPhaseScope {
+private:
+    PhaseObserver* observer;
+    CCLPhase phase;
+
+public:
+    explicit CCLPhaseScope(CCLPhase p)
+        : observer(current_phase_observer()), phase(p) {
+        if (observer) observer->begin_phase(phase);
+    }
+    ~CCLPhaseScope() {
+        if (observer) observer->end_phase(phase);
+    }
+    CCLPhaseScope(const CCLPhaseScope&) = delete;
+    CCLPhaseScope& operator=(const CCLPhaseScope&) = delete;
+};
+
+#endif // CCL_PHASE_HPP
@@ -0,0 +1,282 @@
+#include <pybind11/pybind11.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+#include "algorithms.hpp"
+#include "dsu_2pass.hpp"
+#include "auto_engine.hpp"
+#include "roi.hpp"
+#include "ccl_batch.hpp"
+#include "stream_dsu.hpp"
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Python bindings (module `ccl_pybind`).
+//
+// Masks arrive through the buffer protocol and are labeled in place through
+// an ImageView, so any 2-D uint8/bool array with unit column stride works
+// without a copy (C-contiguous arrays, row slices, padded buffers). Label
+// arrays returned to Python own the C++ vector they were written into.
+// The GIL is released while labeling.
+
+namespace py = pybind11;
+
+namespace {
+
+// Keeps the exporting object locked while the view is in use
+struct MaskBuffer {
+    py::buffer_info info;
+    ImageView view;
+};
+
+MaskBuffer mask_buffer(const py::buffer& obj) {
+    MaskBuffer m{obj.request(), ImageView()};
+    const py::buffer_info& b = m.info;
+    if (b.ndim != 2) {
+        throw std::invalid_argument("mask must be 2-D, got " + std::to_string(b.ndim) + "-D");
+    }
+    if (b.itemsize != 1 || (b.format != "B" && b.format != "?")) {
+        throw std::invalid_argument("mask must be uint8 or bool, got format '" + b.format + "'");
+    }
+    if (b.strides[1] != 1 || b.strides[0] < b.shape[1]) {
+        throw std::invalid_argument("mask rows must be contiguous with a positive row stride");
+    }
+    m.view = ImageView(static_cast<const uint8_t*>(b.ptr), (int)b.shape[0], (int)b.shape[1], b.strides[0]);
+    return m;
+}
+
+// Caller-supplied int32 output of the same shape, written in place
+LabelView label_buffer(const py::buffer_info& b, const ImageView& img) {
+    if (b.readonly) {
+        throw std::invalid_argument("out must be writable");
+    }
+    if (b.ndim != 2 || b.shape[0] != img.H || b.shape[1] != img.W) {
+        throw std::invalid_argument("out must have the same shape as the mask");
+    }
+    if (b.itemsize != 4 || b.format != py::format_descriptor<int32_t>::format()) {
+        throw std::invalid_argument("out must be int32");
+    }
+    if (b.strides[1] != 4 || b.strides[0] % 4 != 0 || b.strides[0] < 4 * b.shape[1]) {
+        throw std::invalid_argument("out rows must be contiguous with a positive row stride");
+    }
+    return LabelView(static_cast<int32_t*>(b.ptr), img.H, img.W, b.strides[0] / 4);
+}
+
+// H x W array that takes ownership of `labels`
+py::array_t<int32_t> to_array(std::vector<int32_t>&& labels, int H, int W) {
+    auto owned = std::make_unique<std::vector<int32_t>>(std::move(labels));
+    int32_t* data = owned->data();
+    py::capsule free_when_done(owned.get(), [](void* p) { delete static_cast<std::vector<int32_t>*>(p); });
+    owned.release();
+    return py::array_t<int32_t>({(py::ssize_t)H, (py::ssize_t)W},
+                                {(py::ssize_t)W * (py::ssize_t)sizeof(int32_t), (py::ssize_t)sizeof(int32_t)},
+                                data, free_when_done);
+}
+
+int label_roi(const ImageView& img, const LabelView& labels, bool eight_connectivity) {
+    CCLWorkspace ws;
+    return label_cc_2pass_roi(img, labels, eight_connectivity, ws);
+}
+
+ViewLabelFunc find_view_engine(const std::string& name) {
+    if (name == "2pass") return static_cast<ViewLabelFunc>(label_cc_2pass);
+    if (name == "bfs") return static_cast<ViewLabelFunc>(label_cc_bfs);
+    if (name == "dfs") return static_cast<ViewLabelFunc>(label_cc_dfs);
+    if (name == "dsu") return static_cast<ViewLabelFunc>(label_cc_dsu);
+    if (name == "auto") return static_cast<ViewLabelFunc>(label_cc_auto);
+    if (name == "roi") return label_roi;
+    throw std::invalid_argument("unknown engine '" + name + "' (2pass, bfs, dfs, dsu, auto, roi)");
+}
+
+py::tuple label(const py::buffer& mask, bool eight_connectivity, const std::string& engine, const py::object& out) {
+    ViewLabelFunc fn = find_view_engine(engine);
+    MaskBuffer m = mask_buffer(mask);
+    const int H = m.view.H, W = m.view.W;
+
+    if (!out.is_none()) {
+        py::buffer_info ob = out.cast<py::buffer>().request(true);
+        LabelView labels = label_buffer(ob, m.view);
+        int n;
+        {
+            py::gil_scoped_release release;
+            n = fn(m.view, labels, eight_connectivity);
+        }
+        return py::make_tuple(out, n);
+    }
+
+    std::vector<int32_t> labels((size_t)H * W);
+    int n;
+    {
+        py::gil_scoped_release release;
+        n = fn(m.view, LabelView(labels, H, W), eight_connectivity);
+    }
+    return py::make_tuple(to_array(std::move(labels), H, W), n);
+}
+
+py::dict stats_dict(const BatchStats& s) {
+    py::dict d;
+    d["wall_us"] = s.wall_us;
+    d["threads"] = s.threads;
+    d["steals"] = s.steals;
+    d["images_per_worker"] = s.images_per_worker;
+    return d;
+}
+
+// Labels `masks` on `pool`; each result is (labels, components)
+py::list run_batch(WorkStealingPool& pool, const py::list& masks, const BatchOptions& opts, BatchStats& stats) {
+    std::vector<MaskBuffer> buffers;
+    std::vector<ImageView> views;
+    buffers.reserve(masks.size());
+    views.reserve(masks.size());
+    for (const py::handle& h : masks) {
+        buffers.push_back(mask_buffer(py::reinterpret_borrow<py::buffer>(h)));
+        views.push_back(buffers.back().view);
+    }
+
+    std::vector<BatchResult> results;
+    {
+        py::gil_scoped_release release;
+        results = label_batch(pool, views, opts, &stats);
+    }
+
+    py::list out;
+    for (size_t i = 0; i < results.size(); ++i) {
+        out.append(py::make_tuple(to_array(std::move(results[i].labels), views[i].H, views[i].W),
+                                  results[i].components));
+    }
+    return out;
+}
+
+// Keeps one pool across calls so threads are not respawned per batch
+class BatchLabeler {
+public:
+    explicit BatchLabeler(int threads) : pool(threads) {}
+
+    py::list label(const py::list& masks, bool eight_connectivity, bool crop) {
+        BatchOptions opts;
+        opts.eight_connectivity = eight_connectivity;
+        opts.crop = crop;
+        return run_batch(pool, masks, opts, last);
+    }
+
+    int threads() const { return pool.size(); }
+    py::dict last_stats() const { return stats_dict(last); }
+
+private:
+    WorkStealingPool pool;
+    BatchStats last = BatchStats();
+};
+
+// StreamDSU plus the canvas size it does not expose, for bounds checks
+struct StreamLabeler {
+    int H, W;
+    StreamDSU dsu;
+
+    StreamLabeler(int h, int w, bool eight_connectivity)
+        : H(checked_size(h)), W(checked_size(w)), dsu(h, w, eight_connectivity) {}
+
+    static int checked_size(int n) {
+        if (n < 0) throw std::invalid_argument("canvas size must be non-negative");
+        return n;
+    }
+
+    void check(int y, int x) const {
+        if (y < 0 || y >= H || x < 0 || x >= W) {
+            throw py::index_error("pixel (" + std::to_string(y) + ", " + std::to_string(x) + ") outside the canvas");
+        }
+    }
+
+    void add_pixel(int y, int x) {
+        check(y, x);
+        dsu.add_pixel(y, x);
+    }
+
+    // (N, 2) array of (y, x)
+    void add_pixels(const py::array_t<int32_t, py::array::c_style | py::array::forcecast>& yx) {
+        if (yx.ndim() != 2 || yx.shape(1) != 2) {
+            throw std::invalid_argument("pixels must have shape (N, 2)");
+        }
+        auto p = yx.unchecked<2>();
+        std::vector<std::pair<int, int>> pixels((size_t)p.shape(0));
+        for (py::ssize_t i = 0; i < p.shape(0); ++i) {
+            check(p(i, 0), p(i, 1));
+            pixels[i] = {p(i, 0), p(i, 1)};
+        }
+        py::gil_scoped_release release;
+        dsu.add_pixels(pixels);
+    }
+
+    int32_t component_id(int y, int x) {
+        check(y, x);
+        return dsu.get_component_id(y, x);
+    }
+
+    ComponentStats component_stats(int32_t id) {
+        if (!dsu.is_component_id(id)) {
+            throw py::index_error("no component id " + std::to_string(id));
+        }
+        return dsu.get_component_stats(id);
+    }
+};
+
+}  // namespace
+
+PYBIND11_MODULE(ccl_pybind, m) {
+    m.doc() = "Connected component labeling engines (C++)";
+
+    m.def("label", &label, py::arg("mask"), py::arg("eight_connectivity") = false,
+          py::arg("engine") = "2pass", py::arg("out") = py::none(),
+          "Label a 2-D uint8/bool mask (0/1) without copying it. Returns (labels, num_components);\n"
+          "labels is `out` when given (int32, same shape, written in place), otherwise a new int32 array.\n"
+          "engine: 2pass, bfs, dfs, dsu, auto or roi.");
+
+    m.def("label_batch",
+          [](const py::list& masks, bool eight_connectivity, int threads, bool crop) {
+              BatchOptions opts;
+              opts.threads = threads;
+              opts.eight_connectivity = eight_connectivity;
+              opts.crop = crop;
+              WorkStealingPool pool(opts.threads);
+              BatchStats stats;
+              py::list results = run_batch(pool, masks, opts, stats);
+              return py::make_tuple(results, stats_dict(stats));
+          },
+          py::arg("masks"), py::arg("eight_connectivity") = false, py::arg("threads") = 0,
+          py::arg("crop") = false,
+          "Label many masks in parallel. Returns ([(labels, num_components), ...], stats).");
+
+    py::class_<BatchLabeler>(m, "BatchLabeler",
+                             "label_batch on a pool that is kept between calls")
+        .def(py::init<int>(), py::arg("threads") = 0)
+        .def("label", &BatchLabeler::label, py::arg("masks"), py::arg("eight_connectivity") = false,
+             py::arg("crop") = false)
+        .def_property_readonly("threads", &BatchLabeler::threads)
+        .def_property_readonly("last_stats", &BatchLabeler::last_stats);
+
+    py::class_<ComponentStats>(m, "ComponentStats")
+        .def_readonly("id", &ComponentStats::id)
+        .def_readonly("size", &ComponentStats::size)
+        .def_readonly("min_y", &ComponentStats::min_y)
+        .def_readonly("min_x", &ComponentStats::min_x)
+        .def_readonly("max_y", &ComponentStats::max_y)
+        .def_readonly("max_x", &ComponentStats::max_x)
+        .def_readonly("centroid_y", &ComponentStats::centroid_y)
+        .def_readonly("centroid_x", &ComponentStats::centroid_x)
+        .def_readonly("perimeter", &ComponentStats::perimeter);
+
+    // Not safe to share between Python threads
+    py::class_<StreamLabeler>(m, "StreamDSU", "Incremental labeling with per-component statistics")
+        .def(py::init<int, int, bool>(), py::arg("H"), py::arg("W"), py::arg("eight_connectivity") = false)
+        .def("add_pixel", &StreamLabeler::add_pixel, py::arg("y"), py::arg("x"))
+        .def("add_pixels", &StreamLabeler::add_pixels, py::arg("pixels"),
+             "Add an (N, 2) array of (y, x) pixels in one batch")
+        .def_property_readonly("component_count", [](const StreamLabeler& s) { return s.dsu.get_component_count(); })
+        .def("component_id", &StreamLabeler::component_id, py::arg("y"), py::arg("x"))
+        .def("component_stats", &StreamLabeler::component_stats, py::arg("id"),
+             "Stats of a component id from component_id() or all_component_stats(); these are internal\n"
+             "root ids, not the values in labels(). Raises IndexError for an id never handed out.")
+        .def("all_component_stats", [](StreamLabeler& s) { return s.dsu.get_all_component_stats(); })
+        .def("labels", [](StreamLabeler& s) { return to_array(s.dsu.get_labels(), s.H, s.W); })
+        .def_property_readonly("memory_usage", [](const StreamLabeler& s) { return s.dsu.get_memory_usage(); });
+}
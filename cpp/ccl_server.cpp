@@ -0,0 +1,63 @@
+#include "label_service.hpp"
+#include <iostream>
+#include <string>
+#include <thread>
+#include <csignal>
+#include <pthread.h>
+
+// Long-lived labeling daemon (label_service.hpp). Jobs name POSIX shm
+// segments for the mask and the labels; see ccl_loadgen.cpp for a client.
+
+static void print_usage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options]\n"
+              << "  --socket PATH      Unix domain socket to listen on (default /tmp/ccl_server.sock)\n"
+              << "  --threads N        labeling threads (default: hardware concurrency)\n";
+}
+
+int main(int argc, char* argv[]) {
+    std::string socket_path = "/tmp/ccl_server.sock";
+    int threads = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string a = argv[i];
+        bool has_value = i + 1 < argc;
+        if (a == "--socket" && has_value) {
+            socket_path = argv[++i];
+        } else if (a == "--threads" && has_value) {
+            threads = std::stoi(argv[++i]);
+        } else if (a == "--help" || a == "-h") {
+            print_usage(argv[0]);
+            return 0;
+        } else {
+            std::cerr << "Unknown or incomplete option: " << a << "\n";
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    // SIGINT/SIGTERM are taken by a waiter thread, which stops the server
+    // cleanly (socket file removed, in-flight jobs answered)
+    sigset_t signals;
+    sigemptyset(&signals);
+    sigaddset(&signals, SIGINT);
+    sigaddset(&signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+    LabelServer server(threads);
+    std::string error;
+    if (!server.listen(socket_path, error)) {
+        std::cerr << "Error: " << error << "\n";
+        return 1;
+    }
+
+    std::thread waiter([&] {
+        int sig;
+        sigwait(&signals, &sig);
+        server.stop();
+    });
+    waiter.detach();
+
+    std::cout << "ccl_server listening on " << socket_path << " (" << server.threads() << " threads)\n";
+    server.serve();
+    std::cout << "ccl_server stopped\n";
+    return 0;
+}
@@ -0,0 +1,93 @@
+#ifndef CCL_TRACE_HPP
+#define CCL_TRACE_HPP
+
+#include "ccl_phase.hpp"
+#include <cstdint>
+#include <chrono>
+
+// Built-in engine instrumentation that does not need perf.
+//
+// Each engine is a template over a trace policy. The public overloads
+// without a trace use NullTrace, whose hooks are empty inlines, so the
+// untraced build compiles to the same loops as before. The overloads taking
+// a CCLTrace& fill in the counters below.
+
+struct CCLTrace {
+    double phase_us[(int)CCLPhase::Count] = {};  // wall time per phase
+
+    int64_t provisional_labels = 0;  // labels / DSU elements handed out in the scan
+    int64_t label_capacity = 0;      // DSU elements allocated (2-pass: grown per label, background included)
+    int64_t components = 0;          // final label count
+
+    int64_t union_calls = 0;
+    int64_t merges = 0;              // unions that joined two different sets
+    int64_t find_calls = 0;
+    int64_t find_steps = 0;          // parent links followed by all finds
+
+    int64_t max_frontier = 0;        // BFS queue / DFS stack high-water mark
+    int64_t pushes = 0;              // queue / stack pushes, seeds included
+    int64_t neighbour_checks = 0;    // neighbours examined around popped pixels
+
+    double avg_find_path() const {
+        return find_calls ? (double)find_steps / find_calls : 0.0;
+    }
+    double total_us() const {
+        double t = 0.0;
+        for (double v : phase_us) t += v;
+        return t;
+    }
+
+    void on_union() { union_calls++; }
+    void on_merge() { merges++; }
+    void on_find(int steps) {
+        find_calls++;
+        find_steps += steps;
+    }
+    // Called after every push, with the new frontier size
+    void on_frontier(size_t size) {
+        pushes++;
+        if ((int64_t)size > max_frontier) max_frontier = (int64_t)size;
+    }
+    void on_expand(int neighbours) { neighbour_checks += neighbours; }
+
+    std::chrono::steady_clock::time_point phase_start;
+    void begin_phase(CCLPhase) { phase_start = std::chrono::steady_clock::now(); }
+    void end_phase(CCLPhase phase) {
+        phase_us[(int)phase] += std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - phase_start).count();
+    }
+};
+
+// Trace policy for untraced calls: every hook is a no-op
+struct NullTrace {
+    int64_t provisional_labels, label_capacity, components;  // written, never read
+
+    void on_union() {}
+    void on_merge() {}
+    void on_find(int) {}
+    void on_frontier(size_t) {}
+    void on_expand(int) {}
+    void begin_phase(CCLPhase) {}
+    void end_phase(CCLPhase) {}
+};
+
+// One engine phase: notifies the thread's PhaseObserver (if any) and the trace
+template <class Trace>
+class EnginePhaseScope {
+private:
+    CCLPhaseScope observer_scope;
+    Trace& trace;
+    CCLPhase phase;
+
+public:
+    EnginePhaseScope(Trace& t, CCLPhase p) : observer_scope(p), trace(t), phase(p) {
+        trace.begin_phase(phase);
+    }
+    ~EnginePhaseScope() {
+        trace.end_phase(phase);
+    }
+    EnginePhaseScope(const EnginePhaseScope&) = delete;
+    EnginePhaseScope& operator=(const EnginePhaseScope&) = delete;
+};
+
+#endif // CCL_TRACE_HPP
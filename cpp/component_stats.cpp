@@ -0,0 +1,41 @@
+#include "component_stats.hpp"
+#include <algorithm>
+#include <climits>
+
+std::vector<ComponentStats> component_stats(const LabelView& labels, int components) {
+    std::vector<ComponentStats> stats(components);
+    std::vector<int64_t> sum_y(components, 0), sum_x(components, 0);
+    for (int i = 0; i < components; ++i) {
+        stats[i] = ComponentStats{i + 1, 0, INT_MAX, INT_MAX, -1, -1, 0.0, 0.0, 0};
+    }
+
+    for (int y = 0; y < labels.H; ++y) {
+        const int32_t* row = labels.row(y);
+        const int32_t* up = y > 0 ? labels.row(y - 1) : nullptr;
+        const int32_t* down = y + 1 < labels.H ? labels.row(y + 1) : nullptr;
+        for (int x = 0; x < labels.W; ++x) {
+            int32_t l = row[x];
+            if (l <= 0 || l > components) continue;
+            ComponentStats& s = stats[l - 1];
+            s.size++;
+            s.min_y = std::min(s.min_y, y);
+            s.max_y = std::max(s.max_y, y);
+            s.min_x = std::min(s.min_x, x);
+            s.max_x = std::max(s.max_x, x);
+            sum_y[l - 1] += y;
+            sum_x[l - 1] += x;
+            // 4-adjacent foreground always carries the same label
+            int touching = (x > 0 && row[x - 1] != 0) + (x + 1 < labels.W && row[x + 1] != 0) +
+                           (up && up[x] != 0) + (down && down[x] != 0);
+            s.perimeter += 4 - touching;
+        }
+    }
+
+    for (int i = 0; i < components; ++i) {
+        if (stats[i].size > 0) {
+            stats[i].centroid_y = (double)sum_y[i] / stats[i].size;
+            stats[i].centroid_x = (double)sum_x[i] / stats[i].size;
+        }
+    }
+    return stats;
+}
@@ -0,0 +1,14 @@
+#ifndef COMPONENT_STATS_HPP
+#define COMPONENT_STATS_HPP
+
+#include "image_view.hpp"
+#include "stream_dsu.hpp"
+#include <vector>
+
+// ComponentStats (size, bbox, centroid, perimeter) of every component of a
+// finished label image, in one raster pass; entry i describes label i + 1.
+// `components` is the largest label, as returned by the engines. The
+// perimeter counts exposed 4-neighbour edges, as StreamDSU does.
+std::vector<ComponentStats> component_stats(const LabelView& labels, int components);
+
+#endif // COMPONENT_STATS_HPP
@@ -1,132 +1,16 @@
 #include "dsu_2pass.hpp"
 #include "algorithms.hpp"
+#include "stream_dsu.hpp"
+#include "workload.hpp"
 #include <iostream>
 #include <vector>
 #include <chrono>
-#include <random>
 #include <iomanip>
 #include <set>
 #include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
 
-// Stream DSU implementation
-class StreamDSU {
-private:
-    std::vector<int32_t> parent;
-    std::vector<int8_t> rank;
-    std::unordered_map<int, int32_t> coord_to_label;
-    int32_t next_label;
-    int H, W;
-    bool eight_conn;
-
-    int coord_to_idx(int y, int x) const {
-        return y * W + x;
-    }
-
-    int32_t find(int32_t x) {
-        while (parent[x] != x) {
-            parent[x] = parent[parent[x]];
-            x = parent[x];
-        }
-        return x;
-    }
-
-    void union_set(int32_t a, int32_t b) {
-        if (a == b) return;
-        int32_t ra = find(a);
-        int32_t rb = find(b);
-        if (ra == rb) return;
-        
-        if (rank[ra] < rank[rb]) {
-            parent[ra] = rb;
-        } else if (rank[ra] > rank[rb]) {
-            parent[rb] = ra;
-        } else {
-            parent[rb] = ra;
-            rank[ra]++;
-        }
-    }
-
-    std::vector<int32_t> get_neighbors(int y, int x) {
-        std::vector<int32_t> neighbors;
-        int idx = coord_to_idx(y, x);
-        
-        if (x - 1 >= 0) {
-            int left_idx = coord_to_idx(y, x - 1);
-            if (coord_to_label.count(left_idx)) {
-                neighbors.push_back(find(coord_to_label[left_idx]));
-            }
-        }
-        if (y - 1 >= 0) {
-            int top_idx = coord_to_idx(y - 1, x);
-            if (coord_to_label.count(top_idx)) {
-                neighbors.push_back(find(coord_to_label[top_idx]));
-            }
-        }
-        
-        if (eight_conn) {
-            if (x - 1 >= 0 && y - 1 >= 0) {
-                int tl_idx = coord_to_idx(y - 1, x - 1);
-                if (coord_to_label.count(tl_idx)) {
-                    neighbors.push_back(find(coord_to_label[tl_idx]));
-                }
-            }
-            if (x + 1 < W && y - 1 >= 0) {
-                int tr_idx = coord_to_idx(y - 1, x + 1);
-                if (coord_to_label.count(tr_idx)) {
-                    neighbors.push_back(find(coord_to_label[tr_idx]));
-                }
-            }
-        }
-        
-        std::sort(neighbors.begin(), neighbors.end());
-        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
-        return neighbors;
-    }
-
-public:
-    StreamDSU(int h, int w, bool eight_connectivity = false) 
-        : H(h), W(w), eight_conn(eight_connectivity), next_label(1) {
-        parent.resize(H * W + 1);
-        rank.resize(H * W + 1, 0);
-        for (size_t i = 0; i < parent.size(); ++i) {
-            parent[i] = i;
-        }
-    }
-
-    void add_pixel(int y, int x) {
-        int idx = coord_to_idx(y, x);
-        if (coord_to_label.count(idx)) {
-            return;
-        }
-
-        auto neighbors = get_neighbors(y, x);
-        
-        if (neighbors.empty()) {
-            coord_to_label[idx] = next_label;
-            next_label++;
-        } else {
-            int32_t min_label = *std::min_element(neighbors.begin(), neighbors.end());
-            coord_to_label[idx] = min_label;
-            
-            for (int32_t nb : neighbors) {
-                if (nb != min_label) {
-                    union_set(min_label, nb);
-                }
-            }
-        }
-    }
-
-    int get_component_count() {
-        std::unordered_set<int32_t> roots;
-        for (const auto& pair : coord_to_label) {
-            roots.insert(find(pair.second));
-        }
-        return roots.size();
-    }
-};
-
 double benchmark_stream_dsu(
     const std::vector<std::pair<int, int>>& pixels,
     int H, int W, bool eight_conn, int iterations) {
@@ -150,10 +34,7 @@ double benchmark_full_recompute(
     int H, int W, bool eight_conn, int iterations,
     std::vector<int32_t> (*func)(const uint8_t*, int, int, bool)) {
     
-    std::vector<uint8_t> img(H * W, 0);
-    for (const auto& p : pixels) {
-        img[p.first * W + p.second] = 1;
-    }
+    std::vector<uint8_t> img = pixels_to_image(pixels, H, W);
     
     auto start = std::chrono::high_resolution_clock::now();
     for (int iter = 0; iter < iterations; ++iter) {
@@ -181,8 +62,7 @@ void test_different_image_sizes_and_stream_sizes(bool eight_conn, int iterations
     std::cout << "Connectivity: " << (eight_conn ? "8" : "4") << "\n";
     std::cout << "Iterations: " << iterations << "\n\n";
     
-    std::random_device rd;
-    std::mt19937 gen(42);
+    uint64_t seed = 42;
     
     for (const auto& [H, W] : image_sizes) {
         int image_size = H * W;
@@ -206,20 +86,7 @@ void test_different_image_sizes_and_stream_sizes(bool eight_conn, int iterations
             if (stream_size > image_size) stream_size = image_size;
             
             // Generate stream pixels
-            std::vector<std::pair<int, int>> pixels;
-            std::set<std::pair<int, int>> used;
-            std::uniform_int_distribution<> y_dist(0, H - 1);
-            std::uniform_int_distribution<> x_dist(0, W - 1);
-            
-            for (int i = 0; i < stream_size; ++i) {
-                int y, x;
-                do {
-                    y = y_dist(gen);
-                    x = x_dist(gen);
-                } while (used.count({y, x}));
-                used.insert({y, x});
-                pixels.push_back({y, x});
-            }
+            std::vector<std::pair<int, int>> pixels = sample_pixels(H, W, stream_size, seed++);
             
             // Benchmark
             double stream_time = benchmark_stream_dsu(pixels, H, W, eight_conn, iterations);
@@ -270,8 +137,7 @@ void test_large_image_scenario(bool eight_conn, int iterations) {
     
     std::vector<double> stream_ratios = {0.01, 0.05, 0.10, 0.20};
     
-    std::random_device rd;
-    std::mt19937 gen(42);
+    uint64_t seed = 42;
     
     for (const auto& [H, W] : large_sizes) {
         int image_size = H * W;
@@ -282,20 +148,7 @@ void test_large_image_scenario(bool eight_conn, int iterations) {
             int stream_size = (int)(image_size * ratio);
             if (stream_size < 1000) continue;
             
-            std::vector<std::pair<int, int>> pixels;
-            std::set<std::pair<int, int>> used;
-            std::uniform_int_distribution<> y_dist(0, H - 1);
-            std::uniform_int_distribution<> x_dist(0, W - 1);
-            
-            for (int i = 0; i < stream_size; ++i) {
-                int y, x;
-                do {
-                    y = y_dist(gen);
-                    x = x_dist(gen);
-                } while (used.count({y, x}));
-                used.insert({y, x});
-                pixels.push_back({y, x});
-            }
+            std::vector<std::pair<int, int>> pixels = sample_pixels(H, W, stream_size, seed++);
             
             double stream_time = benchmark_stream_dsu(pixels, H, W, eight_conn, iterations);
             double bfs_time = benchmark_full_recompute(pixels, H, W, eight_conn, iterations, label_cc_bfs);
@@ -0,0 +1,119 @@
+#include "connectivity.hpp"
+#include <algorithm>
+
+namespace {
+
+enum class Step { Continue, Met };
+
+// Pop one seed of `side` and fill its span. Spans are always maximal runs,
+// so a pixel next to one of our spans is either ours already or unvisited
+// by us; meeting the other side's mark anywhere in our component ends the
+// query.
+Step fill_span(const ImageView& img, FloodWorkspace& ws, int side, int reach) {
+    const int H = img.H, W = img.W;
+    const uint32_t own = ws.generation + side, other = ws.generation + 1 - side;
+    auto& stack = ws.stack[side];
+    auto [y, x] = stack.back();
+    stack.pop_back();
+
+    const uint8_t* row = img.row(y);
+    uint32_t* m = ws.mark.data() + (size_t)y * W;
+    if (m[x] == own) return Step::Continue;
+    if (m[x] == other) return Step::Met;
+
+    int l = x, r = x;
+    while (l > 0 && row[l - 1] != 0) {
+        if (m[l - 1] == other) return Step::Met;
+        --l;
+    }
+    while (r + 1 < W && row[r + 1] != 0) {
+        if (m[r + 1] == other) return Step::Met;
+        ++r;
+    }
+    std::fill(m + l, m + r + 1, own);
+    ws.explored += r - l + 1;
+
+    // One seed per run of unvisited foreground touching the span above
+    // and below (one column wider with 8-connectivity)
+    const int lo = std::max(0, l - reach), hi = std::min(W - 1, r + reach);
+    for (int ny : {y - 1, y + 1}) {
+        if (ny < 0 || ny >= H) continue;
+        const uint8_t* nrow = img.row(ny);
+        const uint32_t* nm = ws.mark.data() + (size_t)ny * W;
+        for (int i = lo; i <= hi; ++i) {
+            if (nrow[i] == 0 || nm[i] == own) continue;
+            if (nm[i] == other) return Step::Met;
+            stack.push_back({ny, i});
+            while (i + 1 <= hi && nrow[i + 1] != 0) {
+                if (nm[i + 1] == other) return Step::Met;
+                ++i;
+            }
+        }
+    }
+    return Step::Continue;
+}
+
+bool in_foreground(const ImageView& img, int y, int x) {
+    return y >= 0 && y < img.H && x >= 0 && x < img.W && img.at(y, x) != 0;
+}
+
+}  // namespace
+
+bool connected(const ImageView& img, int y0, int x0, int y1, int x1, bool eight_connectivity, FloodWorkspace& ws) {
+    ws.explored = 0;
+    if (!in_foreground(img, y0, x0) || !in_foreground(img, y1, x1)) return false;
+    if (y0 == y1 && x0 == x1) return true;
+
+    // Two marks per query; start over when the generation would wrap
+    if (ws.H != img.H || ws.W != img.W || ws.generation > UINT32_MAX - 2) {
+        ws.mark.assign((size_t)img.H * img.W, 0);
+        ws.generation = 0;
+        ws.H = img.H;
+        ws.W = img.W;
+    }
+    ws.generation += 2;
+    const int reach = eight_connectivity ? 1 : 0;
+    ws.stack[0].assign(1, {y0, x0});
+    ws.stack[1].assign(1, {y1, x1});
+
+    // Both seeds' spans are marked before the loop, so a fill that runs
+    // out has seen every pixel of its component without meeting the other
+    int64_t done[2] = {0, 0};
+    for (int side : {0, 1}) {
+        int64_t before = ws.explored;
+        if (fill_span(img, ws, side, reach) == Step::Met) return true;
+        done[side] += ws.explored - before;
+    }
+    while (!ws.stack[0].empty() && !ws.stack[1].empty()) {
+        int side = done[0] <= done[1] ? 0 : 1;
+        int64_t before = ws.explored;
+        if (fill_span(img, ws, side, reach) == Step::Met) return true;
+        done[side] += ws.explored - before;
+    }
+    return false;
+}
+
+bool connected(const uint8_t* img, int H, int W, int y0, int x0, int y1, int x1, bool eight_connectivity) {
+    thread_local FloodWorkspace ws;
+    return connected(ImageView(img, H, W), y0, x0, y1, x1, eight_connectivity, ws);
+}
+
+std::vector<uint8_t> connected(
+    const ImageView& img, const std::vector<SeedPair>& queries,
+    bool eight_connectivity, FloodWorkspace& ws
+) {
+    std::vector<uint8_t> answers(queries.size());
+    for (size_t i = 0; i < queries.size(); ++i) {
+        const SeedPair& s = queries[i];
+        answers[i] = connected(img, s.y0, s.x0, s.y1, s.x1, eight_connectivity, ws);
+    }
+    return answers;
+}
+
+std::vector<uint8_t> connected(
+    const ImageView& img, const std::vector<SeedPair>& queries,
+    bool eight_connectivity
+) {
+    FloodWorkspace ws;
+    return connected(img, queries, eight_connectivity, ws);
+}
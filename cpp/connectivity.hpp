@@ -0,0 +1,51 @@
+#ifndef CONNECTIVITY_HPP
+#define CONNECTIVITY_HPP
+
+#include "image_view.hpp"
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+// Point-to-point connectivity without labeling the image: are (y0, x0)
+// and (y1, x1) foreground pixels of the same component?
+//
+// Two scanline flood fills grow from the seeds, one span at a time,
+// always advancing the side that has explored less. The query stops as
+// soon as one fill reaches a pixel the other has marked (connected) or
+// one fill runs out of spans (its whole component was explored without
+// meeting the other). Work is proportional to the explored region, not
+// to H * W.
+
+// Scratch for connectivity queries, reused across calls on images of the
+// same size. Marks carry a per-query generation, so nothing is cleared
+// between queries; only a change of image size reallocates (O(H * W) once).
+struct FloodWorkspace {
+    std::vector<uint32_t> mark;                  // pixel -> generation (+1 for the second seed)
+    uint32_t generation = 0;
+    std::vector<std::pair<int, int>> stack[2];   // pending span seeds per side
+    int H = 0, W = 0;
+    int64_t explored = 0;                        // pixels marked by the last query
+};
+
+struct SeedPair {
+    int y0, x0, y1, x1;
+};
+
+// Background or out-of-range seeds are never connected; a foreground seed
+// is connected to itself
+bool connected(const ImageView& img, int y0, int x0, int y1, int x1, bool eight_connectivity, FloodWorkspace& ws);
+// Uses a per-thread workspace: the first query on each image size, and
+// the first after switching sizes, allocates the H * W marks
+bool connected(const uint8_t* img, int H, int W, int y0, int x0, int y1, int x1, bool eight_connectivity = false);
+
+// One answer (0/1) per query, in order, sharing one workspace
+std::vector<uint8_t> connected(
+    const ImageView& img, const std::vector<SeedPair>& queries,
+    bool eight_connectivity, FloodWorkspace& ws
+);
+std::vector<uint8_t> connected(
+    const ImageView& img, const std::vector<SeedPair>& queries,
+    bool eight_connectivity = false
+);
+
+#endif // CONNECTIVITY_HPP
@@ -0,0 +1,100 @@
+#include "corpus.hpp"
+#include "workload.hpp"
+#include "pnm.hpp"
+#include <vector>
+#include <algorithm>
+#include <cmath>
+#include <map>
+#include <filesystem>
+
+std::vector<CorpusImage> synthetic_corpus(const std::vector<int>& sizes, uint64_t seed) {
+    std::vector<CorpusImage> corpus;
+    for (ShapeClass cls : all_shape_classes()) {
+        for (int size : sizes) {
+            CorpusImage img;
+            img.cls = shape_class_name(cls);
+            img.H = size;
+            img.W = size;
+            img.mask = generate_shape_image(cls, size, size,
+                                            derive_seed(seed, img.cls + "@" + std::to_string(size)));
+            corpus.push_back(std::move(img));
+        }
+    }
+    return corpus;
+}
+
+bool load_mask_corpus(const std::string& dir, const std::string& cls,
+                      std::vector<CorpusImage>& out, std::string& error) {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) {
+        error = "not a directory: " + dir;
+        return false;
+    }
+
+    std::vector<fs::path> files;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        std::string ext = entry.path().extension().string();
+        if (entry.is_regular_file() && (ext == ".pgm" || ext == ".pbm")) {
+            files.push_back(entry.path());
+        }
+    }
+    std::sort(files.begin(), files.end());
+
+    for (const auto& path : files) {
+        PnmImage pnm;
+        if (!read_pnm(path.string(), pnm, error)) {
+            return false;
+        }
+        CorpusImage img;
+        img.cls = cls;
+        img.name = path.stem().string();
+        img.H = pnm.H;
+        img.W = pnm.W;
+        img.mask = pnm_to_mask(pnm);
+        out.push_back(std::move(img));
+    }
+    return true;
+}
+
+std::string corpus_class(const std::string& input) {
+    size_t slash = input.find('/');
+    return slash == std::string::npos ? input : input.substr(0, slash);
+}
+
+std::vector<std::pair<std::string, std::vector<EngineRank>>> rank_engines_by_class(
+    const std::vector<BenchRecord>& records
+) {
+    // class -> engine -> (sum of log throughput, samples)
+    std::vector<std::string> class_order;
+    std::map<std::string, std::vector<std::string>> engine_order;
+    std::map<std::string, std::map<std::string, std::pair<double, int>>> acc;
+
+    for (const auto& r : records) {
+        if (r.stats.median_us <= 0.0) continue;
+        std::string cls = corpus_class(r.input);
+        if (!acc.count(cls)) class_order.push_back(cls);
+        auto& engines = acc[cls];
+        if (!engines.count(r.engine)) engine_order[cls].push_back(r.engine);
+        auto& a = engines[r.engine];
+        a.first += std::log(r.work_pixels / r.stats.median_us);
+        a.second++;
+    }
+
+    std::vector<std::pair<std::string, std::vector<EngineRank>>> ranking;
+    for (const auto& cls : class_order) {
+        std::vector<EngineRank> ranks;
+        for (const auto& engine : engine_order[cls]) {
+            const auto& a = acc[cls][engine];
+            ranks.push_back({engine, std::exp(a.first / a.second), 0.0});
+        }
+        std::stable_sort(ranks.begin(), ranks.end(), [](const EngineRank& a, const EngineRank& b) {
+            return a.geomean_mps > b.geomean_mps;
+        });
+        for (auto& rank : ranks) {
+            rank.relative = rank.geomean_mps / ranks.front().geomean_mps;
+        }
+        ranking.push_back({cls, ranks});
+    }
+    return ranking;
+}
@@ -0,0 +1,45 @@
+#ifndef CORPUS_HPP
+#define CORPUS_HPP
+
+#include "bench_harness.hpp"
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// Benchmark corpus: synthetic shape classes plus real masks exported as
+// PGM (see python/export_corpus.py). Records from a corpus run carry the
+// class (or "class/name" for files) in BenchRecord::input, so results can
+// be grouped per class.
+
+struct CorpusImage {
+    std::string cls;    // e.g. "blobs", "lesion"
+    std::string name;   // file stem; empty for synthetic images
+    int H, W;
+    std::vector<uint8_t> mask;  // 0/1
+
+    std::string label() const { return name.empty() ? cls : cls + "/" + name; }
+};
+
+// One image per shape class and size
+std::vector<CorpusImage> synthetic_corpus(const std::vector<int>& sizes, uint64_t seed);
+
+// Every .pgm/.pbm file in `dir` (sorted by name) as class `cls`
+bool load_mask_corpus(const std::string& dir, const std::string& cls,
+                      std::vector<CorpusImage>& out, std::string& error);
+
+// Class part of a "class/name" input label
+std::string corpus_class(const std::string& input);
+
+struct EngineRank {
+    std::string engine;
+    double geomean_mps;  // geometric mean throughput over the class's images
+    double relative;     // geomean_mps / best engine's geomean_mps
+};
+
+// Per class (in first-seen order): engines ranked fastest first
+std::vector<std::pair<std::string, std::vector<EngineRank>>> rank_engines_by_class(
+    const std::vector<BenchRecord>& records
+);
+
+#endif // CORPUS_HPP
@@ -1,107 +1,253 @@
 #include "dsu_2pass.hpp"
 #include <vector>
 #include <algorithm>
-#include <unordered_map>
-#include <unordered_set>
 
-std::vector<int32_t> label_cc_2pass(
-    const uint8_t* img, int H, int W, 
-    bool eight_connectivity
+// Foreground sources for the two-pass scan: begin_row(y) is called
+// once per row in order, then operator()(x) tests pixels of that row. This
+// lets callers label a thresholded or bit-packed image without building
+// the binary byte mask.
+namespace {
+
+struct ByteRows {
+    const uint8_t* img;
+    int64_t stride;
+    const uint8_t* r = nullptr;
+    void begin_row(int y) { r = img + y * stride; }
+    bool operator()(int x) const { return r[x] != 0; }
+};
+
+struct ThresholdRows {
+    const uint8_t* gray;
+    int W;
+    uint8_t threshold;
+    bool invert;
+    const uint8_t* r = nullptr;
+    void begin_row(int y) { r = gray + (size_t)y * W; }
+    bool operator()(int x) const { return (r[x] <= threshold) != invert; }
+};
+
+struct PackedRows {
+    const std::function<const uint64_t*(int)>& fetch;
+    const uint64_t* r = nullptr;
+    void begin_row(int y) { r = fetch(y); }
+    bool operator()(int x) const { return (r[x >> 6] >> (x & 63)) & 1; }
+};
+
+}  // namespace
+
+// First pass: provisional labels into `labels` (left, up, then the
+// diagonals; a pixel takes the smallest neighbour label) and their
+// equivalences into ws.dsu, which grows one set per new label
+template <class Source, class Trace>
+static void scan_2pass(
+    Source is_foreground, int H, int W,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels, int64_t label_stride, Trace& trace
 ) {
-    std::vector<int32_t> labels(H * W, 0);
-    int next_label = 1;
-    
-    // Upper bound: H*W/2 + 10
-    DSUInt32 dsu(H * W / 2 + 10);
+    DSUInt32& dsu = ws.dsu;
+    dsu.clear();
+    dsu.make_set();  // label 0 is background
 
-    // First pass: assign temporary labels and union neighbors
+    EnginePhaseScope<Trace> scan(trace, CCLPhase::Scan);
     for (int y = 0; y < H; ++y) {
+        is_foreground.begin_row(y);
+        int32_t* cur = labels + y * label_stride;
+        const int32_t* up = y > 0 ? cur - label_stride : nullptr;
+        std::fill(cur, cur + W, 0);
         for (int x = 0; x < W; ++x) {
-            if (img[y * W + x] == 0) {
+            if (!is_foreground(x)) {
                 continue;
             }
 
-            std::vector<int> neighbors;
-            
-            // left
-            if (x - 1 >= 0 && labels[y * W + (x - 1)] > 0) {
-                neighbors.push_back(labels[y * W + (x - 1)]);
+            int neighbors[4];
+            int count = 0;
+            if (x - 1 >= 0 && cur[x - 1] > 0) {
+                neighbors[count++] = cur[x - 1];
             }
-            // upper
-            if (y - 1 >= 0 && labels[(y - 1) * W + x] > 0) {
-                neighbors.push_back(labels[(y - 1) * W + x]);
+            if (up && up[x] > 0) {
+                neighbors[count++] = up[x];
             }
-            
-            if (eight_connectivity) {
-                // upper-left
-                if (x - 1 >= 0 && y - 1 >= 0 && labels[(y - 1) * W + (x - 1)] > 0) {
-                    neighbors.push_back(labels[(y - 1) * W + (x - 1)]);
+            if (eight_connectivity && up) {
+                if (x - 1 >= 0 && up[x - 1] > 0) {
+                    neighbors[count++] = up[x - 1];
                 }
-                // upper-right
-                if (x + 1 < W && y - 1 >= 0 && labels[(y - 1) * W + (x + 1)] > 0) {
-                    neighbors.push_back(labels[(y - 1) * W + (x + 1)]);
+                if (x + 1 < W && up[x + 1] > 0) {
+                    neighbors[count++] = up[x + 1];
                 }
             }
 
-            if (neighbors.empty()) {
-                // allocate new label
-                labels[y * W + x] = next_label;
-                next_label++;
+            if (count == 0) {
+                cur[x] = dsu.make_set();
             } else {
-                // get min label
-                int m = *std::min_element(neighbors.begin(), neighbors.end());
-                labels[y * W + x] = m;
-                // Union with other neighbors
-                for (int nb : neighbors) {
-                    if (nb != m) {
-                        dsu.union_set(m, nb);
+                int m = *std::min_element(neighbors, neighbors + count);
+                cur[x] = m;
+                for (int i = 0; i < count; ++i) {
+                    if (neighbors[i] != m) {
+                        dsu.union_set(m, neighbors[i], trace);
                     }
                 }
             }
         }
     }
+    trace.provisional_labels = dsu.size() - 1;
+    trace.label_capacity = dsu.size();
+}
 
-    // Second pass: map to representative and compress to continuous labels
-    // Find all used labels
-    std::unordered_set<int> used_set;
-    for (int i = 0; i < H * W; ++i) {
-        if (labels[i] > 0) {
-            used_set.insert(labels[i]);
-        }
+// Flatten ws.dsu into ws.remap (provisional label -> final label, 0 -> 0)
+// and return the component count. Every provisional label was placed on a
+// pixel, so the roots are numbered in ascending order directly instead of
+// collecting the used labels.
+template <class Trace>
+static int flatten_2pass(CCLWorkspace& ws, Trace& trace) {
+    DSUInt32& dsu = ws.dsu;
+    int provisional = dsu.size();  // one past the last label
+    int components = 0;
+    EnginePhaseScope<Trace> resolve(trace, CCLPhase::Resolve);
+    ws.remap.assign(provisional, 0);
+    for (int lab = 1; lab < provisional; ++lab) {
+        ws.remap[dsu.find(lab, trace)] = 1;
     }
-    
-    if (used_set.empty()) {
-        return labels; // all background
+    for (int lab = 1; lab < provisional; ++lab) {
+        if (ws.remap[lab]) ws.remap[lab] = ++components;
     }
-
-    // Representative mapping
-    std::unordered_map<int, int> rep;
-    for (int lab : used_set) {
-        rep[lab] = dsu.find(lab);
+    for (int lab = 1; lab < provisional; ++lab) {
+        ws.remap[lab] = ws.remap[dsu.find(lab, trace)];
     }
+    trace.components = components;
+    return components;
+}
 
-    // Compress to continuous labels
-    std::unordered_set<int> rep_vals;
-    for (const auto& pair : rep) {
-        rep_vals.insert(pair.second);
-    }
-    
-    std::vector<int> rep_vals_sorted(rep_vals.begin(), rep_vals.end());
-    std::sort(rep_vals_sorted.begin(), rep_vals_sorted.end());
-    
-    std::unordered_map<int, int> rep2final;
-    for (size_t i = 0; i < rep_vals_sorted.size(); ++i) {
-        rep2final[rep_vals_sorted[i]] = i + 1;
-    }
+template <class Source, class Trace>
+static int label_cc_2pass_ws(
+    Source is_foreground, int H, int W,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels, int64_t label_stride, Trace& trace
+) {
+    scan_2pass(is_foreground, H, W, eight_connectivity, ws, labels, label_stride, trace);
+    int components = flatten_2pass(ws, trace);
 
-    // Apply final mapping
-    for (int i = 0; i < H * W; ++i) {
-        int v = labels[i];
-        if (v > 0) {
-            labels[i] = rep2final[rep[v]];
+    EnginePhaseScope<Trace> relabel(trace, CCLPhase::Relabel);
+    for (int y = 0; y < H; ++y) {
+        int32_t* cur = labels + y * label_stride;
+        for (int x = 0; x < W; ++x) {
+            cur[x] = ws.remap[cur[x]];
         }
     }
+    return components;
+}
+
+template <class Source>
+static int label_cc_2pass_ws(
+    Source is_foreground, int H, int W,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels, int64_t label_stride
+) {
+    NullTrace trace;
+    return label_cc_2pass_ws(is_foreground, H, W, eight_connectivity, ws, labels, label_stride, trace);
+}
+
+std::vector<int32_t> label_cc_2pass(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity
+) {
+    std::vector<int32_t> labels((size_t)H * W);
+    CCLWorkspace ws;
+    label_cc_2pass_ws(ByteRows{img, W}, H, W, eight_connectivity, ws, labels.data(), W);
+    return labels;
+}
+
+std::vector<int32_t> label_cc_2pass(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLTrace& trace
+) {
+    trace = CCLTrace();
+    std::vector<int32_t> labels((size_t)H * W);
+    CCLWorkspace ws;
+    label_cc_2pass_ws(ByteRows{img, W}, H, W, eight_connectivity, ws, labels.data(), W, trace);
+    return labels;
+}
+
+int label_cc_2pass(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels
+) {
+    return label_cc_2pass_ws(ByteRows{img, W}, H, W, eight_connectivity, ws, labels, W);
+}
+
+int label_cc_2pass(
+    const uint8_t* img, int64_t img_stride, int H, int W,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels, int64_t label_stride
+) {
+    return label_cc_2pass_ws(ByteRows{img, img_stride}, H, W, eight_connectivity, ws, labels, label_stride);
+}
+
+int label_cc_2pass(const ImageView& img, const LabelView& labels, bool eight_connectivity) {
+    CCLWorkspace ws;
+    return label_cc_2pass(img, labels, eight_connectivity, ws);
+}
+
+int label_cc_2pass(
+    const ImageView& img, const LabelView& labels,
+    bool eight_connectivity, CCLWorkspace& ws
+) {
+    return label_cc_2pass_ws(ByteRows{img.data, img.stride}, img.H, img.W,
+                             eight_connectivity, ws, labels.data, labels.stride);
+}
+
+int label_cc_2pass_threshold(
+    const uint8_t* gray, int H, int W, uint8_t threshold, bool invert,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels
+) {
+    return label_cc_2pass_ws(ThresholdRows{gray, W, threshold, invert}, H, W, eight_connectivity, ws, labels, W);
+}
+
+int label_cc_2pass_rows(
+    const std::function<const uint64_t*(int)>& row, int H, int W,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels
+) {
+    return label_cc_2pass_ws(PackedRows{row}, H, W, eight_connectivity, ws, labels, W);
+}
+
+// ------------------------------------------------------------------ lazy
+
+void label_cc_2pass_lazy(const ImageView& img, bool eight_connectivity, LazyLabels& out) {
+    out.H = img.H;
+    out.W = img.W;
+    out.labels.resize((size_t)img.H * img.W);
+    out.resolved.assign(img.H, 0);
+    out.unresolved_rows = img.H;
+    NullTrace trace;
+    scan_2pass(ByteRows{img.data, img.stride}, img.H, img.W, eight_connectivity, out.ws, out.labels.data(), img.W,
+               trace);
+    out.num_components = flatten_2pass(out.ws, trace);
+}
+
+LazyLabels label_cc_2pass_lazy(const ImageView& img, bool eight_connectivity) {
+    LazyLabels out;
+    label_cc_2pass_lazy(img, eight_connectivity, out);
+    return out;
+}
+
+const int32_t* LazyLabels::row(int y) {
+    int32_t* r = labels.data() + (size_t)y * W;
+    if (!resolved[y]) {
+        for (int x = 0; x < W; ++x) r[x] = ws.remap[r[x]];
+        resolved[y] = 1;
+        unresolved_rows--;
+    }
+    return r;
+}
 
+const std::vector<int32_t>& LazyLabels::materialize() {
+    for (int y = 0; unresolved_rows > 0 && y < H; ++y) row(y);
     return labels;
 }
 
+void LazyLabels::materialize(const LabelView& out) const {
+    for (int y = 0; y < H; ++y) {
+        const int32_t* r = labels.data() + (size_t)y * W;
+        int32_t* o = out.row(y);
+        if (resolved[y]) {
+            std::copy(r, r + W, o);
+        } else {
+            for (int x = 0; x < W; ++x) o[x] = ws.remap[r[x]];
+        }
+    }
+}
@@ -6,6 +6,9 @@
 #include <algorithm>
 #include <unordered_map>
 #include <unordered_set>
+#include <functional>
+#include "ccl_trace.hpp"
+#include "image_view.hpp"
 
 class DSUInt32 {
 private:
@@ -13,26 +16,63 @@ private:
     std::vector<int8_t> rank;
 
 public:
+    DSUInt32() = default;
+
     DSUInt32(int n) : parent(n), rank(n, 0) {
         for (int i = 0; i < n; ++i) {
             parent[i] = i;
         }
     }
 
+    // Drop all sets but keep the storage, for reuse across images
+    void clear() {
+        parent.clear();
+        rank.clear();
+    }
+
+    // Append a singleton set and return its id
+    int make_set() {
+        int id = (int)parent.size();
+        parent.push_back(id);
+        rank.push_back(0);
+        return id;
+    }
+
+    int size() const {
+        return (int)parent.size();
+    }
+
     int find(int x) {
+        NullTrace trace;
+        return find(x, trace);
+    }
+
+    template <class Trace>
+    int find(int x, Trace& trace) {
         // path compression (iteration)
+        int steps = 0;
         while (parent[x] != x) {
             parent[x] = parent[parent[x]];
             x = parent[x];
+            steps++;
         }
+        trace.on_find(steps);
         return x;
     }
 
     void union_set(int a, int b) {
+        NullTrace trace;
+        union_set(a, b, trace);
+    }
+
+    template <class Trace>
+    void union_set(int a, int b, Trace& trace) {
+        trace.on_union();
         if (a == b) return;
-        int ra = find(a);
-        int rb = find(b);
+        int ra = find(a, trace);
+        int rb = find(b, trace);
         if (ra == rb) return;
+        trace.on_merge();
         
         if (rank[ra] < rank[rb]) {
             parent[ra] = rb;
@@ -52,5 +92,107 @@ std::vector<int32_t> label_cc_2pass(
     bool eight_connectivity = false
 );
 
+// Same, filling `trace` with phase times and DSU counters
+std::vector<int32_t> label_cc_2pass(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLTrace& trace
+);
+
+// Scratch buffers for the workspace overload below. They keep their
+// capacity between calls, so labeling a stream of similar images
+// allocates only while the first few grow them.
+struct CCLWorkspace {
+    DSUInt32 dsu;                 // one set per provisional label, created on demand
+    std::vector<int32_t> remap;   // provisional label -> final label
+};
+
+// Same labeling as label_cc_2pass, written to `labels` (H*W entries) with
+// all scratch taken from `ws`; returns the number of components
+int label_cc_2pass(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels
+);
+
+// Strided: pixel (y, x) is img[y * img_stride + x] and its label goes to
+// labels[y * label_stride + x]; entries between rows are left untouched.
+// Labels a sub-rectangle of a larger buffer in place.
+int label_cc_2pass(
+    const uint8_t* img, int64_t img_stride, int H, int W,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels, int64_t label_stride
+);
+
+// View forms of the strided overload; `labels` must be img.H x img.W.
+// The first uses a temporary workspace.
+int label_cc_2pass(const ImageView& img, const LabelView& labels, bool eight_connectivity = false);
+int label_cc_2pass(
+    const ImageView& img, const LabelView& labels,
+    bool eight_connectivity, CCLWorkspace& ws
+);
+
+// Fused binarization: foreground is gray <= threshold (gray > threshold
+// with `invert`), tested inside the first pass; no mask is built
+int label_cc_2pass_threshold(
+    const uint8_t* gray, int H, int W, uint8_t threshold, bool invert,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels
+);
+
+// Foreground supplied row by row as bit-packed words (bit x % 64 of word
+// x / 64); `row(y)` is called once per row, in order, before the scan
+// reaches it (see morphology.hpp)
+int label_cc_2pass_rows(
+    const std::function<const uint64_t*(int)>& row, int H, int W,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels
+);
+
+// First pass of label_cc_2pass only: provisional labels plus the
+// flattened equivalence table (provisional -> final label), built from the
+// DSU in one sweep over the labels, not the pixels. Reads resolve on
+// access, so a caller that checks a few seeds skips the relabel pass over
+// H * W. Every read gives the label label_cc_2pass would have written.
+class LazyLabels {
+public:
+    int height() const { return H; }
+    int width() const { return W; }
+    int components() const { return num_components; }
+
+    // O(1) per pixel
+    int32_t at(int y, int x) const {
+        int32_t v = labels[(size_t)y * W + x];
+        return resolved[y] ? v : ws.remap[v];
+    }
+
+    // Both foreground and in the same component
+    bool connected(int y0, int x0, int y1, int x1) const {
+        int32_t a = at(y0, x0);
+        return a != 0 && a == at(y1, x1);
+    }
+
+    // Row y with final labels; resolved in place on first access, O(W) once
+    const int32_t* row(int y);
+
+    // Resolve every remaining row in place and return the H x W labels
+    const std::vector<int32_t>& materialize();
+
+    // Final labels into `out` (H x W), leaving this object unchanged
+    void materialize(const LabelView& out) const;
+
+    // Provisional label -> final label; entry 0 is background
+    const std::vector<int32_t>& equivalence() const { return ws.remap; }
+
+private:
+    friend void label_cc_2pass_lazy(const ImageView& img, bool eight_connectivity, LazyLabels& out);
+
+    CCLWorkspace ws;              // DSU of the first pass; remap is the equivalence table
+    std::vector<int32_t> labels;  // provisional, or final once the row is resolved
+    std::vector<uint8_t> resolved;
+    int H = 0, W = 0;
+    int num_components = 0;
+    int unresolved_rows = 0;
+};
+
+// `out` keeps its buffers between calls
+void label_cc_2pass_lazy(const ImageView& img, bool eight_connectivity, LazyLabels& out);
+LazyLabels label_cc_2pass_lazy(const ImageView& img, bool eight_connectivity = false);
+
 #endif // DSU_2PASS_HPP
 
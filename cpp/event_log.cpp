@@ -0,0 +1,199 @@
+#include "event_log.hpp"
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static const char EVENT_LOG_MAGIC[8] = {'C', 'C', 'L', 'E', 'V', 'T', '0', '1'};
+static const size_t EVENT_LOG_HEADER_SIZE = 28;
+
+static void put_u32(std::vector<uint8_t>& out, uint32_t v) {
+    for (int i = 0; i < 4; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static void put_u64(std::vector<uint8_t>& out, uint64_t v) {
+    for (int i = 0; i < 8; ++i) out.push_back((uint8_t)(v >> (8 * i)));
+}
+
+static uint32_t get_u32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; ++i) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+static uint64_t get_u64(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; ++i) v |= (uint64_t)p[i] << (8 * i);
+    return v;
+}
+
+static void put_varint(std::vector<uint8_t>& out, uint64_t v) {
+    while (v >= 0x80) {
+        out.push_back((uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out.push_back((uint8_t)v);
+}
+
+// Returns false if the varint runs past `end`
+static bool get_varint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p >= end) return false;
+        uint8_t b = *p++;
+        v |= (uint64_t)(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+    }
+    return false;
+}
+
+static uint64_t zigzag(int64_t v) {
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+static int64_t unzigzag(uint64_t v) {
+    return (int64_t)(v >> 1) ^ -(int64_t)(v & 1);
+}
+
+void encode_event_log(
+    const std::vector<PixelEvent>& events, int H, int W,
+    bool with_timestamps, std::vector<uint8_t>& out
+) {
+    out.clear();
+    out.reserve(EVENT_LOG_HEADER_SIZE + events.size() * (with_timestamps ? 4 : 2));
+    out.insert(out.end(), EVENT_LOG_MAGIC, EVENT_LOG_MAGIC + 8);
+    put_u32(out, with_timestamps ? EVENT_LOG_TIMESTAMPS : 0u);
+    put_u32(out, (uint32_t)H);
+    put_u32(out, (uint32_t)W);
+    put_u64(out, events.size());
+
+    int64_t prev_idx = 0;
+    uint64_t prev_t = 0;
+    for (const auto& e : events) {
+        int64_t idx = (int64_t)e.y * W + e.x;
+        put_varint(out, zigzag(idx - prev_idx));
+        prev_idx = idx;
+        if (with_timestamps) {
+            put_varint(out, e.t_us - prev_t);
+            prev_t = e.t_us;
+        }
+    }
+}
+
+bool write_event_log(
+    const std::string& path, const std::vector<PixelEvent>& events,
+    int H, int W, bool with_timestamps
+) {
+    std::vector<uint8_t> buf;
+    encode_event_log(events, H, W, with_timestamps, buf);
+    std::ofstream file(path, std::ios::binary);
+    if (!file) return false;
+    file.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+    return (bool)file;
+}
+
+EventLogReader::EventLogReader()
+    : base(nullptr), length(0), mapped(false), cursor(nullptr), body(nullptr),
+      flags(0), H(0), W(0), count(0), consumed(0), prev_idx(0), prev_t(0) {}
+
+EventLogReader::~EventLogReader() {
+    unmap();
+}
+
+void EventLogReader::unmap() {
+    if (mapped && base) {
+        munmap(const_cast<uint8_t*>(base), length);
+    }
+    base = nullptr;
+    length = 0;
+    mapped = false;
+}
+
+bool EventLogReader::open(const std::string& path) {
+    unmap();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error_msg = "cannot open " + path;
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)EVENT_LOG_HEADER_SIZE) {
+        ::close(fd);
+        error_msg = "not an event log: " + path;
+        return false;
+    }
+    void* p = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        error_msg = "mmap failed: " + path;
+        return false;
+    }
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+
+    base = static_cast<const uint8_t*>(p);
+    length = st.st_size;
+    mapped = true;
+    return parse_header();
+}
+
+bool EventLogReader::open_buffer(const uint8_t* data, size_t size) {
+    unmap();
+    base = data;
+    length = size;
+    return parse_header();
+}
+
+bool EventLogReader::parse_header() {
+    if (length < EVENT_LOG_HEADER_SIZE || std::memcmp(base, EVENT_LOG_MAGIC, 8) != 0) {
+        error_msg = "bad event log header";
+        return false;
+    }
+    flags = get_u32(base + 8);
+    H = (int)get_u32(base + 12);
+    W = (int)get_u32(base + 16);
+    count = get_u64(base + 20);
+    body = base + EVENT_LOG_HEADER_SIZE;
+    rewind();
+    return true;
+}
+
+void EventLogReader::rewind() {
+    cursor = body;
+    consumed = 0;
+    prev_idx = 0;
+    prev_t = 0;
+}
+
+bool EventLogReader::next(PixelEvent& event) {
+    if (consumed >= count) return false;
+
+    const uint8_t* end = base + length;
+    uint64_t v;
+    if (!get_varint(cursor, end, v)) {
+        error_msg = "truncated event log";
+        return false;
+    }
+    int64_t idx = prev_idx + unzigzag(v);
+    if (idx < 0 || idx >= (int64_t)H * W) {
+        error_msg = "event outside the image";
+        return false;
+    }
+    prev_idx = idx;
+
+    if (has_timestamps()) {
+        if (!get_varint(cursor, end, v)) {
+            error_msg = "truncated event log";
+            return false;
+        }
+        prev_t += v;
+    }
+
+    event.y = (int)(idx / W);
+    event.x = (int)(idx % W);
+    event.t_us = prev_t;
+    consumed++;
+    return true;
+}
@@ -0,0 +1,82 @@
+#ifndef EVENT_LOG_HPP
+#define EVENT_LOG_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// Compact binary pixel-event log
+//
+// Layout (little endian):
+//   header  "CCLEVT01" magic, u32 flags, i32 H, i32 W, u64 event count
+//   events  zigzag varint of (index - previous index), index = y*W + x
+//           [+ varint of (t_us - previous t_us) if EVENT_LOG_TIMESTAMPS]
+// Nearby pixels cost one or two bytes each instead of eight.
+
+const uint32_t EVENT_LOG_TIMESTAMPS = 1u;
+
+struct PixelEvent {
+    int y, x;
+    uint64_t t_us;  // microseconds since capture start, 0 without timestamps
+};
+
+// Encode events into `out`. Timestamps must be non-decreasing.
+void encode_event_log(
+    const std::vector<PixelEvent>& events, int H, int W,
+    bool with_timestamps, std::vector<uint8_t>& out
+);
+
+// Encode and write to `path`; returns false on I/O error
+bool write_event_log(
+    const std::string& path, const std::vector<PixelEvent>& events,
+    int H, int W, bool with_timestamps
+);
+
+// Memory-mapped, streaming decoder. Events are decoded on the fly from the
+// mapping, so replaying never materializes the whole trace.
+class EventLogReader {
+private:
+    const uint8_t* base;
+    size_t length;
+    bool mapped;
+    const uint8_t* cursor;
+    const uint8_t* body;
+    uint32_t flags;
+    int H, W;
+    uint64_t count;
+    uint64_t consumed;
+    int64_t prev_idx;
+    uint64_t prev_t;
+    std::string error_msg;
+
+    bool parse_header();
+    void unmap();
+
+public:
+    EventLogReader();
+    ~EventLogReader();
+    EventLogReader(const EventLogReader&) = delete;
+    EventLogReader& operator=(const EventLogReader&) = delete;
+
+    // Map a log file; returns false (see error()) if missing or malformed
+    bool open(const std::string& path);
+
+    // Decode from a caller-owned buffer that must outlive the reader
+    bool open_buffer(const uint8_t* data, size_t size);
+
+    // Decode the next event; false at the end or on a truncated log
+    bool next(PixelEvent& event);
+
+    // Restart from the first event
+    void rewind();
+
+    int height() const { return H; }
+    int width() const { return W; }
+    uint64_t size() const { return count; }
+    bool has_timestamps() const { return (flags & EVENT_LOG_TIMESTAMPS) != 0; }
+    size_t bytes() const { return length; }
+    const std::string& error() const { return error_msg; }
+};
+
+#endif // EVENT_LOG_HPP
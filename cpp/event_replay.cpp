@@ -0,0 +1,215 @@
+#include "dsu_2pass.hpp"
+#include "stream_dsu.hpp"
+#include "incremental_dsu.hpp"
+#include "event_log.hpp"
+#include "workload.hpp"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <iomanip>
+#include <set>
+#include <string>
+#include <algorithm>
+
+struct ReplayMetrics {
+    uint64_t events;
+    double total_us;
+    double throughput_mevents_per_sec;
+    double p50_us, p99_us, max_us;
+    int components;
+};
+
+double percentile(std::vector<double>& sorted_values, double q) {
+    if (sorted_values.empty()) return 0.0;
+    size_t k = (size_t)(q * (sorted_values.size() - 1));
+    return sorted_values[k];
+}
+
+// Feed every event of the log into `engine`. With `paced`, each event is
+// held until its recorded timestamp and latency counts from that due time.
+template <class Engine>
+ReplayMetrics replay(EventLogReader& log, Engine& engine, bool paced) {
+    using clock = std::chrono::steady_clock;
+
+    ReplayMetrics m;
+    std::vector<double> latencies;
+    latencies.reserve(log.size());
+    log.rewind();
+
+    PixelEvent e;
+    auto start = clock::now();
+    while (log.next(e)) {
+        auto due = clock::now();
+        if (paced) {
+            due = start + std::chrono::microseconds(e.t_us);
+            std::this_thread::sleep_until(due);
+        }
+        engine.add_pixel(e.y, e.x);
+        auto done = clock::now();
+        latencies.push_back(std::max(0.0, std::chrono::duration<double, std::micro>(done - due).count()));
+    }
+    auto end = clock::now();
+
+    m.events = latencies.size();
+    m.total_us = std::chrono::duration<double, std::micro>(end - start).count();
+    m.throughput_mevents_per_sec = m.events / m.total_us;
+    std::sort(latencies.begin(), latencies.end());
+    m.p50_us = percentile(latencies, 0.50);
+    m.p99_us = percentile(latencies, 0.99);
+    m.max_us = latencies.empty() ? 0.0 : latencies.back();
+    m.components = engine.get_component_count();
+    return m;
+}
+
+void print_metrics(const std::string& name, const ReplayMetrics& m) {
+    std::cout << std::left << std::setw(16) << name;
+    std::cout << std::right << std::fixed << std::setprecision(2);
+    std::cout << std::setw(14) << m.total_us;
+    std::cout << std::setw(13) << m.throughput_mevents_per_sec << " M/s";
+    std::cout << std::setw(10) << std::setprecision(3) << m.p50_us;
+    std::cout << std::setw(10) << m.p99_us;
+    std::cout << std::setw(12) << m.max_us;
+    std::cout << std::setw(12) << m.components;
+    std::cout << "\n";
+}
+
+// Write a synthetic trace so the replay path can be exercised without a capture
+int record_synthetic(int argc, char* argv[]) {
+    if (argc < 3) {
+        std::cerr << "Usage: " << argv[0] << " record <out.log> [H] [W] [count] [order] [seed] [rate_hz]\n";
+        return 1;
+    }
+    std::string path = argv[2];
+    int H = 1000;
+    int W = 1000;
+    int count = 100000;
+    StreamOrder order = StreamOrder::Random;
+    uint64_t seed = 42;
+    double rate_hz = 0.0;  // 0 = no timestamps
+
+    if (argc > 3) H = std::stoi(argv[3]);
+    if (argc > 4) W = std::stoi(argv[4]);
+    if (argc > 5) count = std::stoi(argv[5]);
+    if (argc > 6 && !parse_stream_order(argv[6], order)) {
+        std::cerr << "Unknown stream order: " << argv[6] << "\n";
+        return 1;
+    }
+    if (argc > 7) seed = std::stoull(argv[7]);
+    if (argc > 8) rate_hz = std::stod(argv[8]);
+
+    auto pixels = generate_stream(H, W, count, order, seed);
+    std::vector<PixelEvent> events;
+    events.reserve(pixels.size());
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        uint64_t t = rate_hz > 0 ? (uint64_t)(i * 1e6 / rate_hz) : 0;
+        events.push_back({pixels[i].first, pixels[i].second, t});
+    }
+
+    if (!write_event_log(path, events, H, W, rate_hz > 0)) {
+        std::cerr << "Failed to write " << path << "\n";
+        return 1;
+    }
+    std::cout << "Wrote " << events.size() << " events (" << H << "x" << W << ", "
+              << stream_order_name(order) << ") to " << path << "\n";
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "record") {
+        return record_synthetic(argc, argv);
+    }
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <log> [engine: stream|incremental|both] [paced] [eight_conn]\n";
+        std::cerr << "       " << argv[0] << " record <out.log> [H] [W] [count] [order] [seed] [rate_hz]\n";
+        return 1;
+    }
+
+    std::string path = argv[1];
+    std::string engine = "both";
+    bool paced = false;
+    bool eight_conn = false;
+    if (argc > 2) engine = argv[2];
+    if (argc > 3) paced = (std::stoi(argv[3]) != 0);
+    if (argc > 4) eight_conn = (std::stoi(argv[4]) != 0);
+
+    EventLogReader log;
+    if (!log.open(path)) {
+        std::cerr << "Error: " << log.error() << "\n";
+        return 1;
+    }
+    int H = log.height();
+    int W = log.width();
+    if (paced && !log.has_timestamps()) {
+        std::cerr << "Log has no timestamps; replaying at full speed\n";
+        paced = false;
+    }
+
+    std::cout << "============================================================\n";
+    std::cout << "Event Log Replay\n";
+    std::cout << "============================================================\n";
+    std::cout << "Log: " << path << "\n";
+    std::cout << "Image size: " << H << "x" << W << "\n";
+    std::cout << "Events: " << log.size() << " (" << std::fixed << std::setprecision(2)
+              << (double)log.bytes() / std::max<uint64_t>(1, log.size()) << " bytes/event)\n";
+    std::cout << "Pacing: " << (paced ? "recorded" : "full speed") << "\n";
+    std::cout << "Connectivity: " << (eight_conn ? "8" : "4") << "\n\n";
+
+    std::cout << std::left << std::setw(16) << "Engine";
+    std::cout << std::right << std::setw(14) << "Total (μs)";
+    std::cout << std::setw(17) << "Throughput";
+    std::cout << std::setw(10) << "p50 (μs)";
+    std::cout << std::setw(10) << "p99 (μs)";
+    std::cout << std::setw(12) << "max (μs)";
+    std::cout << std::setw(12) << "Components";
+    std::cout << "\n";
+    std::cout << std::string(91, '-') << "\n";
+
+    std::vector<int> component_counts;
+    if (engine == "stream" || engine == "both") {
+        StreamDSU stream(H, W, eight_conn);
+        ReplayMetrics m = replay(log, stream, paced);
+        print_metrics("Stream DSU", m);
+        component_counts.push_back(m.components);
+    }
+    if (engine == "incremental" || engine == "both") {
+        IncrementalDSU inc(H, W, eight_conn);
+        std::vector<uint8_t> empty((size_t)H * W, 0);
+        inc.initialize(empty.data());
+        ReplayMetrics m = replay(log, inc, paced);
+        print_metrics("Incremental DSU", m);
+        component_counts.push_back(m.components);
+    }
+    if (component_counts.empty()) {
+        std::cerr << "Unknown engine: " << engine << "\n";
+        return 1;
+    }
+    if (!log.error().empty()) {
+        std::cerr << "Error: " << log.error() << "\n";
+        return 1;
+    }
+
+    // Verify against a batch labeling of the final image
+    std::vector<uint8_t> img((size_t)H * W, 0);
+    PixelEvent e;
+    log.rewind();
+    while (log.next(e)) {
+        img[e.y * W + e.x] = 1;
+    }
+    auto labels = label_cc_2pass(img.data(), H, W, eight_conn);
+    std::set<int32_t> comps;
+    for (size_t i = 0; i < labels.size(); ++i) {
+        if (labels[i] > 0) comps.insert(labels[i]);
+    }
+
+    bool ok = true;
+    for (int c : component_counts) {
+        ok = ok && (c == (int)comps.size());
+    }
+    if (ok) {
+        std::cout << "\n✓ Results verified: " << comps.size() << " components\n";
+    } else {
+        std::cerr << "\nWARNING: Component count mismatch against 2-Pass (" << comps.size() << ")!\n";
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,39 @@
+#ifndef IMAGE_VIEW_HPP
+#define IMAGE_VIEW_HPP
+
+#include <cstdint>
+#include <vector>
+#include <type_traits>
+
+// Non-owning H x W view of a row-major buffer whose rows are `stride`
+// elements apart (stride >= W). Sub-rectangles, padded camera buffers and
+// numpy slices with a positive row stride are all views of their parent
+// buffer, so they can be labeled without copying. The caller keeps the
+// buffer alive.
+template <class T>
+struct StridedView {
+    T* data;
+    int H, W;
+    int64_t stride;  // in elements
+
+    StridedView() : data(nullptr), H(0), W(0), stride(0) {}
+    StridedView(T* d, int h, int w) : data(d), H(h), W(w), stride(w) {}
+    StridedView(T* d, int h, int w, int64_t s) : data(d), H(h), W(w), stride(s) {}
+
+    // Dense view of a vector; the const overload only compiles for read-only views
+    StridedView(std::vector<std::remove_const_t<T>>& v, int h, int w) : data(v.data()), H(h), W(w), stride(w) {}
+    StridedView(const std::vector<std::remove_const_t<T>>& v, int h, int w)
+        : data(v.data()), H(h), W(w), stride(w) {}
+
+    T* row(int y) const { return data + y * stride; }
+    T& at(int y, int x) const { return data[y * stride + x]; }
+    bool dense() const { return stride == W; }
+
+    // Rows [y, y + h), columns [x, x + w) of this view
+    StridedView sub(int y, int x, int h, int w) const { return StridedView(row(y) + x, h, w, stride); }
+};
+
+using ImageView = StridedView<const uint8_t>;   // 0/1 mask input
+using LabelView = StridedView<int32_t>;         // label output
+
+#endif // IMAGE_VIEW_HPP
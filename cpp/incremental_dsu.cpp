@@ -0,0 +1,169 @@
+#include "incremental_dsu.hpp"
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+IncrementalDSU::IncrementalDSU(int h, int w, bool eight_connectivity)
+    : H(h), W(w), eight_conn(eight_connectivity), next_label(1) {
+    labels.resize(H * W, 0);
+    parent.resize(H * W + 1);
+    rank.resize(H * W + 1, 0);
+    for (size_t i = 0; i < parent.size(); ++i) {
+        parent[i] = i;
+    }
+}
+
+void IncrementalDSU::union_set(int32_t a, int32_t b) {
+    if (a == b) return;
+    int32_t ra = find(a);
+    int32_t rb = find(b);
+    if (ra == rb) return;
+
+    if (rank[ra] < rank[rb]) {
+        parent[ra] = rb;
+    } else if (rank[ra] > rank[rb]) {
+        parent[rb] = ra;
+    } else {
+        parent[rb] = ra;
+        rank[ra]++;
+    }
+}
+
+std::vector<int32_t> IncrementalDSU::get_neighbor_labels(int y, int x, bool all_directions) {
+    // left, top, (top-left, top-right) first; right, bottom, (bottom-left,
+    // bottom-right) only when pixels can arrive out of raster order
+    static const int CAUSAL_4[2][2] = {{0,-1}, {-1,0}};
+    static const int CAUSAL_8[4][2] = {{0,-1}, {-1,0}, {-1,-1}, {-1,1}};
+    static const int ALL_4[4][2] = {{0,-1}, {-1,0}, {0,1}, {1,0}};
+    static const int ALL_8[8][2] = {{0,-1}, {-1,0}, {-1,-1}, {-1,1},
+                                    {0,1}, {1,0}, {1,-1}, {1,1}};
+    const int (*offsets)[2];
+    int num_offsets;
+    if (all_directions) {
+        offsets = eight_conn ? ALL_8 : ALL_4;
+        num_offsets = eight_conn ? 8 : 4;
+    } else {
+        offsets = eight_conn ? CAUSAL_8 : CAUSAL_4;
+        num_offsets = eight_conn ? 4 : 2;
+    }
+
+    std::vector<int32_t> roots;
+    for (int i = 0; i < num_offsets; ++i) {
+        int ny = y + offsets[i][0];
+        int nx = x + offsets[i][1];
+        if (ny < 0 || ny >= H || nx < 0 || nx >= W) {
+            continue;
+        }
+        int32_t lab = labels[coord_to_idx(ny, nx)];
+        if (lab > 0) {
+            roots.push_back(find(lab));
+        }
+    }
+
+    // Remove duplicates
+    std::sort(roots.begin(), roots.end());
+    roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+    return roots;
+}
+
+void IncrementalDSU::label_pixel(int y, int x, bool all_directions) {
+    auto neighbor_roots = get_neighbor_labels(y, x, all_directions);
+
+    if (neighbor_roots.empty()) {
+        labels[coord_to_idx(y, x)] = next_label;
+        next_label++;
+    } else {
+        int32_t min_label = neighbor_roots.front();
+        labels[coord_to_idx(y, x)] = min_label;
+
+        for (int32_t nb : neighbor_roots) {
+            if (nb != min_label) {
+                union_set(min_label, nb);
+            }
+        }
+    }
+}
+
+void IncrementalDSU::initialize(const uint8_t* img) {
+    initialize(ImageView(img, H, W));
+}
+
+bool IncrementalDSU::initialize(const ImageView& img) {
+    if (img.H != H || img.W != W) {
+        return false;
+    }
+
+    // First pass: assign temporary labels
+    for (int y = 0; y < H; ++y) {
+        const uint8_t* row = img.row(y);
+        for (int x = 0; x < W; ++x) {
+            if (row[x] == 0) {
+                continue;
+            }
+            label_pixel(y, x, false);
+        }
+    }
+
+    // Second pass: compress labels
+    compress_labels();
+    return true;
+}
+
+void IncrementalDSU::compress_labels() {
+    std::unordered_set<int32_t> used_roots;
+    for (int i = 0; i < H * W; ++i) {
+        if (labels[i] > 0) {
+            used_roots.insert(find(labels[i]));
+        }
+    }
+
+    std::vector<int32_t> roots_sorted(used_roots.begin(), used_roots.end());
+    std::sort(roots_sorted.begin(), roots_sorted.end());
+
+    std::unordered_map<int32_t, int32_t> root_to_final;
+    for (size_t i = 0; i < roots_sorted.size(); ++i) {
+        root_to_final[roots_sorted[i]] = i + 1;
+    }
+
+    for (int i = 0; i < H * W; ++i) {
+        if (labels[i] > 0) {
+            labels[i] = root_to_final[find(labels[i])];
+        }
+    }
+
+    // Final labels reuse the low DSU ids, so the old forest must go
+    for (int i = 0; i < next_label; ++i) {
+        parent[i] = i;
+        rank[i] = 0;
+    }
+    next_label = roots_sorted.size() + 1;
+}
+
+void IncrementalDSU::add_pixel(int y, int x) {
+    int idx = coord_to_idx(y, x);
+    if (labels[idx] > 0) {
+        return;  // Already foreground
+    }
+    label_pixel(y, x, true);
+}
+
+int IncrementalDSU::get_component_count() {
+    std::unordered_set<int32_t> roots;
+    for (int i = 0; i < H * W; ++i) {
+        if (labels[i] > 0) {
+            roots.insert(find(labels[i]));
+        }
+    }
+    return roots.size();
+}
+
+std::vector<int32_t> IncrementalDSU::get_labels() {
+    compress_labels();
+    return labels;
+}
+
+RunLabels IncrementalDSU::get_label_runs() {
+    compress_labels();
+    return runs_from_dense(LabelView(labels, H, W));
+}
@@ -0,0 +1,63 @@
+#ifndef INCREMENTAL_DSU_HPP
+#define INCREMENTAL_DSU_HPP
+
+#include <vector>
+#include <cstdint>
+#include "image_view.hpp"
+#include "run_labels.hpp"
+
+// Incremental DSU for updating existing image
+class IncrementalDSU {
+private:
+    std::vector<int32_t> parent;
+    std::vector<int8_t> rank;
+    std::vector<int32_t> labels;  // Full label map
+    int H, W;
+    bool eight_conn;
+    int next_label;
+
+    int coord_to_idx(int y, int x) const {
+        return y * W + x;
+    }
+
+    int32_t find(int32_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    void union_set(int32_t a, int32_t b);
+
+    // Roots of labeled neighbours. The raster initialization only needs the
+    // causal (left/top) half; stream updates must look in every direction.
+    std::vector<int32_t> get_neighbor_labels(int y, int x, bool all_directions);
+
+    void label_pixel(int y, int x, bool all_directions);
+
+public:
+    IncrementalDSU(int h, int w, bool eight_connectivity = false);
+
+    // Initialize from existing image
+    void initialize(const uint8_t* img);
+
+    // Same from a strided view, e.g. a tile of a larger frame; false (and
+    // nothing labeled) if the view is not H x W
+    bool initialize(const ImageView& img);
+
+    void compress_labels();
+
+    // Add a new pixel incrementally
+    void add_pixel(int y, int x);
+
+    // Get component count
+    int get_component_count();
+
+    std::vector<int32_t> get_labels();
+
+    // Snapshot of get_labels() as run-length rows
+    RunLabels get_label_runs();
+};
+
+#endif // INCREMENTAL_DSU_HPP
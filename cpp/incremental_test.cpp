@@ -1,192 +1,15 @@
 #include "dsu_2pass.hpp"
 #include "algorithms.hpp"
+#include "incremental_dsu.hpp"
+#include "workload.hpp"
 #include <iostream>
 #include <vector>
 #include <chrono>
-#include <random>
 #include <unordered_map>
 #include <unordered_set>
 #include <set>
 #include <algorithm>
 
-// Incremental DSU for updating existing image
-class IncrementalDSU {
-private:
-    std::vector<int32_t> parent;
-    std::vector<int8_t> rank;
-    std::vector<int32_t> labels;  // Full label map
-    int H, W;
-    bool eight_conn;
-    int next_label;
-
-    int coord_to_idx(int y, int x) const {
-        return y * W + x;
-    }
-
-    int32_t find(int32_t x) {
-        while (parent[x] != x) {
-            parent[x] = parent[parent[x]];
-            x = parent[x];
-        }
-        return x;
-    }
-
-    void union_set(int32_t a, int32_t b) {
-        if (a == b) return;
-        int32_t ra = find(a);
-        int32_t rb = find(b);
-        if (ra == rb) return;
-        
-        if (rank[ra] < rank[rb]) {
-            parent[ra] = rb;
-        } else if (rank[ra] > rank[rb]) {
-            parent[rb] = ra;
-        } else {
-            parent[rb] = ra;
-            rank[ra]++;
-        }
-    }
-
-    std::vector<int32_t> get_neighbor_labels(int y, int x) {
-        std::vector<int32_t> neighbor_labels;
-        
-        // left
-        if (x - 1 >= 0 && labels[coord_to_idx(y, x - 1)] > 0) {
-            neighbor_labels.push_back(labels[coord_to_idx(y, x - 1)]);
-        }
-        // top
-        if (y - 1 >= 0 && labels[coord_to_idx(y - 1, x)] > 0) {
-            neighbor_labels.push_back(labels[coord_to_idx(y - 1, x)]);
-        }
-        
-        if (eight_conn) {
-            // top-left
-            if (x - 1 >= 0 && y - 1 >= 0 && labels[coord_to_idx(y - 1, x - 1)] > 0) {
-                neighbor_labels.push_back(labels[coord_to_idx(y - 1, x - 1)]);
-            }
-            // top-right
-            if (x + 1 < W && y - 1 >= 0 && labels[coord_to_idx(y - 1, x + 1)] > 0) {
-                neighbor_labels.push_back(labels[coord_to_idx(y - 1, x + 1)]);
-            }
-        }
-        
-        // Get roots and remove duplicates
-        std::set<int32_t> roots;
-        for (int32_t lab : neighbor_labels) {
-            roots.insert(find(lab));
-        }
-        return std::vector<int32_t>(roots.begin(), roots.end());
-    }
-
-public:
-    IncrementalDSU(int h, int w, bool eight_connectivity = false) 
-        : H(h), W(w), eight_conn(eight_connectivity), next_label(1) {
-        labels.resize(H * W, 0);
-        parent.resize(H * W + 1);
-        rank.resize(H * W + 1, 0);
-        for (size_t i = 0; i < parent.size(); ++i) {
-            parent[i] = i;
-        }
-    }
-
-    // Initialize from existing image
-    void initialize(const uint8_t* img) {
-        // First pass: assign temporary labels
-        for (int y = 0; y < H; ++y) {
-            for (int x = 0; x < W; ++x) {
-                if (img[coord_to_idx(y, x)] == 0) {
-                    continue;
-                }
-
-                auto neighbor_roots = get_neighbor_labels(y, x);
-                
-                if (neighbor_roots.empty()) {
-                    labels[coord_to_idx(y, x)] = next_label;
-                    next_label++;
-                } else {
-                    int32_t min_label = *std::min_element(neighbor_roots.begin(), neighbor_roots.end());
-                    labels[coord_to_idx(y, x)] = min_label;
-                    
-                    for (int32_t nb : neighbor_roots) {
-                        if (nb != min_label) {
-                            union_set(min_label, nb);
-                        }
-                    }
-                }
-            }
-        }
-        
-        // Second pass: compress labels
-        compress_labels();
-    }
-
-    void compress_labels() {
-        std::unordered_set<int32_t> used_roots;
-        for (int i = 0; i < H * W; ++i) {
-            if (labels[i] > 0) {
-                used_roots.insert(find(labels[i]));
-            }
-        }
-        
-        std::vector<int32_t> roots_sorted(used_roots.begin(), used_roots.end());
-        std::sort(roots_sorted.begin(), roots_sorted.end());
-        
-        std::unordered_map<int32_t, int32_t> root_to_final;
-        for (size_t i = 0; i < roots_sorted.size(); ++i) {
-            root_to_final[roots_sorted[i]] = i + 1;
-        }
-        
-        for (int i = 0; i < H * W; ++i) {
-            if (labels[i] > 0) {
-                labels[i] = root_to_final[find(labels[i])];
-            }
-        }
-        
-        next_label = roots_sorted.size() + 1;
-    }
-
-    // Add a new pixel incrementally
-    void add_pixel(int y, int x) {
-        int idx = coord_to_idx(y, x);
-        if (labels[idx] > 0) {
-            return;  // Already foreground
-        }
-
-        labels[idx] = 0;  // Temporarily mark
-        auto neighbor_roots = get_neighbor_labels(y, x);
-        
-        if (neighbor_roots.empty()) {
-            labels[idx] = next_label;
-            next_label++;
-        } else {
-            int32_t min_label = *std::min_element(neighbor_roots.begin(), neighbor_roots.end());
-            labels[idx] = min_label;
-            
-            for (int32_t nb : neighbor_roots) {
-                if (nb != min_label) {
-                    union_set(min_label, nb);
-                }
-            }
-        }
-    }
-
-    // Get component count
-    int get_component_count() {
-        std::unordered_set<int32_t> roots;
-        for (int i = 0; i < H * W; ++i) {
-            if (labels[i] > 0) {
-                roots.insert(find(labels[i]));
-            }
-        }
-        return roots.size();
-    }
-
-    std::vector<int32_t> get_labels() {
-        compress_labels();
-        return labels;
-    }
-};
-
 double benchmark_incremental_updates(
     const std::vector<uint8_t>& base_img,
     const std::vector<std::pair<int, int>>& new_pixels,
@@ -252,36 +75,17 @@ int main(int argc, char* argv[]) {
     std::cout << "Connectivity: " << (eight_conn ? "8" : "4") << "\n";
     std::cout << "Iterations: " << iterations << "\n\n";
 
+    // Sample base and new pixels together so the two sets are disjoint
+    std::vector<std::pair<int, int>> all_pixels =
+        sample_pixels(H, W, base_pixels + new_pixels_count, 42);  // Fixed seed for reproducibility
+    base_pixels = std::min(base_pixels, (int)all_pixels.size());
+
     // Generate base image
-    std::random_device rd;
-    std::mt19937 gen(42);  // Fixed seed for reproducibility
-    std::uniform_int_distribution<> y_dist(0, H - 1);
-    std::uniform_int_distribution<> x_dist(0, W - 1);
-    
-    std::vector<uint8_t> base_img(H * W, 0);
-    std::set<std::pair<int, int>> used;
-    
-    for (int i = 0; i < base_pixels; ++i) {
-        int y, x;
-        do {
-            y = y_dist(gen);
-            x = x_dist(gen);
-        } while (used.count({y, x}));
-        used.insert({y, x});
-        base_img[y * W + x] = 1;
-    }
+    std::vector<std::pair<int, int>> base_list(all_pixels.begin(), all_pixels.begin() + base_pixels);
+    std::vector<uint8_t> base_img = pixels_to_image(base_list, H, W);
 
     // Generate new pixels to add
-    std::vector<std::pair<int, int>> new_pixels;
-    for (int i = 0; i < new_pixels_count; ++i) {
-        int y, x;
-        do {
-            y = y_dist(gen);
-            x = x_dist(gen);
-        } while (used.count({y, x}));
-        used.insert({y, x});
-        new_pixels.push_back({y, x});
-    }
+    std::vector<std::pair<int, int>> new_pixels(all_pixels.begin() + base_pixels, all_pixels.end());
 
     std::cout << "Generated " << base_pixels << " base pixels and ";
     std::cout << new_pixels.size() << " new pixels\n\n";
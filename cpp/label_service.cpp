@@ -0,0 +1,664 @@
+#include "label_service.hpp"
+#include "roi.hpp"
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+#include <future>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+
+using ServiceClock = std::chrono::steady_clock;
+
+static bool read_full(int fd, void* buf, size_t n) {
+    auto* p = static_cast<uint8_t*>(buf);
+    while (n > 0) {
+        ssize_t r = ::recv(fd, p, n, 0);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= (size_t)r;
+    }
+    return true;
+}
+
+// One request, collecting any fds passed with it (SCM_RIGHTS) into `fds`
+static bool read_request(int fd, LabelRequest& req, std::vector<int>& fds) {
+    auto* p = reinterpret_cast<uint8_t*>(&req);
+    size_t n = sizeof(req);
+    while (n > 0) {
+        alignas(cmsghdr) char control[CMSG_SPACE(2 * sizeof(int))];
+        iovec iov{p, n};
+        msghdr msg{};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        ssize_t r = ::recvmsg(fd, &msg, MSG_CMSG_CLOEXEC);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        for (cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+            if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) continue;
+            size_t count = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            for (size_t i = 0; i < count; ++i) {
+                int passed;
+                std::memcpy(&passed, CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+                fds.push_back(passed);
+            }
+        }
+        p += r;
+        n -= (size_t)r;
+    }
+    return true;
+}
+
+static void close_fds(std::vector<int>& fds) {
+    for (int f : fds) {
+        if (f >= 0) ::close(f);
+    }
+    fds.clear();
+}
+
+static bool write_full(int fd, const void* buf, size_t n) {
+    auto* p = static_cast<const uint8_t*>(buf);
+    while (n > 0) {
+        ssize_t r = ::send(fd, p, n, MSG_NOSIGNAL);
+        if (r < 0 && errno == EINTR) continue;
+        if (r <= 0) return false;
+        p += r;
+        n -= (size_t)r;
+    }
+    return true;
+}
+
+static void set_error(LabelReply& reply, const std::string& msg) {
+    reply.status = 1;
+    std::strncpy(reply.error, msg.c_str(), sizeof(reply.error) - 1);
+}
+
+// ---------------------------------------------------------------- SharedMemory
+
+SharedMemory::~SharedMemory() {
+    reset();
+}
+
+SharedMemory::SharedMemory(SharedMemory&& other) noexcept {
+    *this = std::move(other);
+}
+
+SharedMemory& SharedMemory::operator=(SharedMemory&& other) noexcept {
+    if (this != &other) {
+        reset();
+        ptr = other.ptr;
+        bytes = other.bytes;
+        shm_name = std::move(other.shm_name);
+        seg_fd = other.seg_fd;
+        owner = other.owner;
+        rw = other.rw;
+        other.ptr = nullptr;
+        other.bytes = 0;
+        other.seg_fd = -1;
+        other.owner = false;
+    }
+    return *this;
+}
+
+void SharedMemory::reset() {
+    if (ptr) ::munmap(ptr, bytes);
+    if (seg_fd >= 0) ::close(seg_fd);
+    if (owner) ::shm_unlink(shm_name.c_str());
+    ptr = nullptr;
+    bytes = 0;
+    seg_fd = -1;
+    owner = false;
+}
+
+size_t SharedMemory::current_size() const {
+    struct stat st;
+    if (seg_fd < 0 || ::fstat(seg_fd, &st) != 0 || st.st_size < 0) return 0;
+    return (size_t)st.st_size;
+}
+
+bool SharedMemory::create(const std::string& name, size_t size, std::string& error) {
+    reset();
+    ::shm_unlink(name.c_str());
+    int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        error = "shm_open " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    if (::ftruncate(fd, (off_t)size) != 0) {
+        error = "ftruncate " + name + ": " + std::strerror(errno);
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        error = "mmap " + name + ": " + std::strerror(errno);
+        ::close(fd);
+        ::shm_unlink(name.c_str());
+        return false;
+    }
+    ptr = static_cast<uint8_t*>(p);
+    bytes = size;
+    shm_name = name;
+    seg_fd = fd;
+    owner = true;
+    rw = true;
+    return true;
+}
+
+bool SharedMemory::open(const std::string& name, bool writable, std::string& error) {
+    reset();
+    int fd = ::shm_open(name.c_str(), writable ? O_RDWR : O_RDONLY, 0);
+    if (fd < 0) {
+        error = "shm_open " + name + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        error = "empty shared memory segment " + name;
+        ::close(fd);
+        return false;
+    }
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* p = ::mmap(nullptr, (size_t)st.st_size, prot, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        error = "mmap " + name + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    ptr = static_cast<uint8_t*>(p);
+    bytes = (size_t)st.st_size;
+    shm_name = name;
+    seg_fd = fd;  // kept to re-check the size before each use
+    owner = false;
+    rw = writable;
+    return true;
+}
+
+bool SharedMemory::create_sealed(size_t size, std::string& error) {
+    reset();
+    int fd = ::memfd_create("ccl_segment", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd < 0) {
+        error = std::string("memfd_create: ") + std::strerror(errno);
+        return false;
+    }
+    if (::ftruncate(fd, (off_t)size) != 0 ||
+        ::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL) != 0) {
+        error = std::string("sealing memfd: ") + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    void* p = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        error = std::string("mmap memfd: ") + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    ptr = static_cast<uint8_t*>(p);
+    bytes = size;
+    shm_name.clear();
+    seg_fd = fd;
+    owner = false;
+    rw = true;
+    return true;
+}
+
+bool SharedMemory::adopt(int fd, bool writable, std::string& error) {
+    reset();
+    struct stat st;
+    int seals = ::fcntl(fd, F_GET_SEALS);
+    if (seals < 0 || !(seals & F_SEAL_SHRINK)) {
+        error = "segment passed by fd is not sealed against shrinking";
+        ::close(fd);
+        return false;
+    }
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        error = "empty segment passed by fd";
+        ::close(fd);
+        return false;
+    }
+    int prot = writable ? PROT_READ | PROT_WRITE : PROT_READ;
+    void* p = ::mmap(nullptr, (size_t)st.st_size, prot, MAP_SHARED, fd, 0);
+    if (p == MAP_FAILED) {
+        error = std::string("mmap of passed segment: ") + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    ptr = static_cast<uint8_t*>(p);
+    bytes = (size_t)st.st_size;
+    // Client names start with '/', so this key never collides with one
+    shm_name = "@" + std::to_string(st.st_dev) + ":" + std::to_string(st.st_ino);
+    seg_fd = fd;
+    owner = false;
+    rw = writable;
+    return true;
+}
+
+// ---------------------------------------------------------------- LabelServer
+
+struct LabelServer::Job {
+    ImageView img;
+    LabelView labels;
+    bool eight_connectivity;
+    bool crop;
+    ServiceClock::time_point queued;
+    int components = 0;
+    double queue_us = 0, label_us = 0;
+    std::string error;
+    std::promise<void> done;
+};
+
+LabelServer::LabelServer(int threads) : pool(threads), workspaces(pool.size()), label_buffers(pool.size()) {}
+
+LabelServer::~LabelServer() {
+    stop();
+    if (dispatcher.joinable()) dispatcher.join();
+    for (auto& t : connection_threads) {
+        if (t.joinable()) t.join();
+    }
+    if (listen_fd >= 0) {
+        ::close(listen_fd);
+        ::unlink(path.c_str());
+    }
+}
+
+bool LabelServer::listen(const std::string& socket_path, std::string& error) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    if (socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path)) {
+        error = "socket path must be 1-" + std::to_string(sizeof(addr.sun_path) - 1) + " characters";
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size());
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        error = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    ::unlink(socket_path.c_str());
+    // Only the owner may connect: requests name shm segments to map
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        ::chmod(socket_path.c_str(), 0600) != 0 || ::listen(fd, 64) != 0) {
+        error = socket_path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+    listen_fd = fd;
+    path = socket_path;
+    return true;
+}
+
+void LabelServer::serve() {
+    dispatcher = std::thread(&LabelServer::dispatch_loop, this);
+    while (!stopping) {
+        int fd = ::accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (stopping) break;
+            if (errno != EINTR && errno != ECONNABORTED) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));  // e.g. out of fds
+            }
+            continue;
+        }
+        std::lock_guard<std::mutex> lk(connections_lock);
+        if (stopping) {
+            ::close(fd);
+            break;
+        }
+        // Reap connections that have ended, so a client connecting per call
+        // does not leave a thread stack behind each time
+        for (std::thread::id id : finished_connections) {
+            auto it = std::find_if(connection_threads.begin(), connection_threads.end(),
+                                   [&](const std::thread& t) { return t.get_id() == id; });
+            it->join();
+            connection_threads.erase(it);
+        }
+        finished_connections.clear();
+        connection_fds.push_back(fd);
+        connection_threads.emplace_back(&LabelServer::connection_loop, this, fd);
+    }
+
+    stop();
+    for (auto& t : connection_threads) t.join();
+    connection_threads.clear();
+    finished_connections.clear();
+    dispatcher.join();
+    ::close(listen_fd);
+    ::unlink(path.c_str());
+    listen_fd = -1;
+}
+
+size_t LabelServer::connection_threads_held() {
+    std::lock_guard<std::mutex> lk(connections_lock);
+    return connection_threads.size();
+}
+
+void LabelServer::stop() {
+    if (stopping.exchange(true)) return;
+    if (listen_fd >= 0) ::shutdown(listen_fd, SHUT_RDWR);  // wakes accept()
+    {
+        std::lock_guard<std::mutex> lk(connections_lock);
+        for (int fd : connection_fds) ::shutdown(fd, SHUT_RDWR);
+    }
+    std::lock_guard<std::mutex> lk(queue_lock);
+    queue_ready.notify_all();
+}
+
+void LabelServer::connection_loop(int fd) {
+    // Segments stay mapped for the life of the connection, keyed by name
+    std::vector<SharedMemory> inputs, outputs;
+    std::vector<int> fds;
+    LabelRequest req;
+    while (read_request(fd, req, fds)) {
+        LabelReply reply;
+        bool shutdown = false;
+        if (req.magic != LABEL_SERVICE_MAGIC) {
+            set_error(reply, "bad request magic");
+            write_full(fd, &reply, sizeof(reply));
+            break;
+        }
+        switch (req.op) {
+            case ServiceOp::Label:
+                handle_label(req, reply, fds, inputs, outputs);
+                break;
+            case ServiceOp::Stats:
+                break;
+            case ServiceOp::Shutdown:
+                shutdown = true;
+                break;
+            default:
+                set_error(reply, "unknown op");
+        }
+        close_fds(fds);  // any the request did not use
+        fill_stats(reply);
+        if (!write_full(fd, &reply, sizeof(reply))) break;
+        if (shutdown) {
+            stop();
+            break;
+        }
+    }
+
+    close_fds(fds);
+    std::lock_guard<std::mutex> lk(connections_lock);
+    connection_fds.erase(std::find(connection_fds.begin(), connection_fds.end(), fd));
+    finished_connections.push_back(std::this_thread::get_id());
+    ::close(fd);
+}
+
+// Each cached mapping holds an fd, so a connection keeps only the most
+// recently added ones
+static const size_t MAX_CACHED_SEGMENTS = 16;
+
+static std::vector<SharedMemory>::iterator cache_segment(std::vector<SharedMemory>& cache, SharedMemory m) {
+    if (cache.size() >= MAX_CACHED_SEGMENTS) cache.erase(cache.begin());
+    cache.push_back(std::move(m));
+    return cache.end() - 1;
+}
+
+static const SharedMemory* check_size(const SharedMemory& m, size_t need, std::string& error) {
+    if (m.size() < need) {
+        error = "segment is " + std::to_string(m.size()) + " bytes, need " + std::to_string(need);
+        return nullptr;
+    }
+    return &m;
+}
+
+// Mapping of `name` from `cache`, (re)opened if missing, smaller than
+// `need` or resized by the client since it was mapped (touching pages past
+// the new end would raise SIGBUS)
+static const SharedMemory* map_segment(std::vector<SharedMemory>& cache, const char* raw_name, size_t need,
+                                       bool writable, std::string& error) {
+    std::string name(raw_name, strnlen(raw_name, sizeof(LabelRequest::input)));
+    if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos) {
+        error = "bad shared memory name '" + name + "'";
+        return nullptr;
+    }
+    auto it = std::find_if(cache.begin(), cache.end(), [&](const SharedMemory& m) { return m.name() == name; });
+    if (it == cache.end() || it->size() < need || it->current_size() != it->size()) {
+        SharedMemory m;
+        if (!m.open(name, writable, error)) return nullptr;
+        if (it == cache.end()) {
+            it = cache_segment(cache, std::move(m));
+        } else {
+            *it = std::move(m);
+        }
+    }
+    return check_size(*it, need, error);
+}
+
+// Mapping of a memfd passed with the request; takes ownership of `fd`.
+// Sealed segments cannot shrink, so a cached mapping of the same file is
+// reused as is.
+static const SharedMemory* map_passed(std::vector<SharedMemory>& cache, int fd, size_t need,
+                                      bool writable, std::string& error) {
+    SharedMemory m;
+    if (!m.adopt(fd, writable, error)) return nullptr;
+    auto it = std::find_if(cache.begin(), cache.end(), [&](const SharedMemory& c) { return c.name() == m.name(); });
+    if (it == cache.end() || (writable && !it->writable())) {
+        if (it != cache.end()) cache.erase(it);
+        it = cache_segment(cache, std::move(m));
+    }
+    return check_size(*it, need, error);
+}
+
+// Bytes spanned by an H x W view with row stride `stride` (elements of
+// `elem` bytes), from its first element to one past its last; false on
+// overflow
+static bool view_extent(int64_t H, int64_t W, int64_t stride, uint64_t elem, uint64_t& bytes) {
+    uint64_t elems;
+    return !__builtin_mul_overflow((uint64_t)(H - 1), (uint64_t)stride, &elems) &&
+           !__builtin_add_overflow(elems, (uint64_t)W, &elems) &&
+           !__builtin_mul_overflow(elems, elem, &bytes);
+}
+
+void LabelServer::handle_label(const LabelRequest& req, LabelReply& reply, std::vector<int>& fds,
+                               std::vector<SharedMemory>& inputs, std::vector<SharedMemory>& outputs) {
+    const int64_t H = req.H, W = req.W;
+    const int64_t in_stride = req.input_stride ? req.input_stride : W;
+    const int64_t out_stride = req.output_stride ? req.output_stride : W;
+    if (H <= 0 || W <= 0 || in_stride < W || out_stride < W || req.output_offset % 4 != 0 ||
+        in_stride > (int64_t(1) << 40) || out_stride > (int64_t(1) << 40)) {
+        set_error(reply, "bad shape, stride or offset");
+        return;
+    }
+    // Every size below comes from the client, so all arithmetic is checked
+    uint64_t in_extent, out_extent, in_need, out_need;
+    if (!view_extent(H, W, in_stride, 1, in_extent) || !view_extent(H, W, out_stride, sizeof(int32_t), out_extent) ||
+        __builtin_add_overflow(req.input_offset, in_extent, &in_need) ||
+        __builtin_add_overflow(req.output_offset, out_extent, &out_need)) {
+        set_error(reply, "view does not fit in a segment");
+        return;
+    }
+
+    std::string error;
+    const SharedMemory* in = nullptr;
+    const SharedMemory* out = nullptr;
+    if (req.sealed) {
+        if (fds.size() != 2) {
+            set_error(reply, "sealed request needs the input and output fds");
+            return;
+        }
+        int in_fd = fds[0], out_fd = fds[1];
+        fds.clear();
+        in = map_passed(inputs, in_fd, in_need, false, error);
+        if (in) {
+            out = map_passed(outputs, out_fd, out_need, true, error);
+        } else {
+            ::close(out_fd);
+        }
+    } else {
+        in = map_segment(inputs, req.input, in_need, false, error);
+        out = in ? map_segment(outputs, req.output, out_need, true, error) : nullptr;
+    }
+    if (!out) {
+        set_error(reply, error);
+        return;
+    }
+    if (req.input_offset > in->size() || in_extent > in->size() - req.input_offset ||
+        req.output_offset > out->size() || out_extent > out->size() - req.output_offset) {
+        set_error(reply, "view does not fit in its segment");
+        return;
+    }
+
+    Job job;
+    job.img = ImageView(in->data() + req.input_offset, (int)H, (int)W, in_stride);
+    job.labels = LabelView(reinterpret_cast<int32_t*>(out->data() + req.output_offset), (int)H, (int)W, out_stride);
+    job.eight_connectivity = req.eight_connectivity != 0;
+    job.crop = req.crop != 0;
+    job.queued = ServiceClock::now();
+    std::future<void> done = job.done.get_future();
+    {
+        std::lock_guard<std::mutex> lk(queue_lock);
+        if (stopping) {
+            set_error(reply, "server is stopping");
+            return;
+        }
+        queue.push_back(&job);
+    }
+    queue_ready.notify_one();
+    done.wait();
+
+    if (!job.error.empty()) {
+        set_error(reply, job.error);
+        return;
+    }
+    reply.components = job.components;
+    reply.queue_us = job.queue_us;
+    reply.label_us = job.label_us;
+}
+
+void LabelServer::dispatch_loop() {
+    std::vector<Job*> batch;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lk(queue_lock);
+            queue_ready.wait(lk, [&] { return stopping || !queue.empty(); });
+            if (queue.empty()) return;  // stopping, nothing left to run
+            batch.assign(queue.begin(), queue.end());
+            queue.clear();
+        }
+
+        // Everything that arrived while the previous batch ran goes out together
+        std::string failure;
+        try {
+            pool.run((int64_t)batch.size(), [&](int64_t i, int worker) {
+                Job& job = *batch[i];
+                auto t0 = ServiceClock::now();
+                job.queue_us = std::chrono::duration<double, std::micro>(t0 - job.queued).count();
+                // The client can write to its segment at any time, so only
+                // final labels are copied into it
+                const int H = job.labels.H, W = job.labels.W;
+                std::vector<int32_t>& buffer = label_buffers[worker];
+                buffer.resize((size_t)H * W);
+                LabelView own(buffer, H, W);
+                job.components = job.crop
+                    ? label_cc_2pass_roi(job.img, own, job.eight_connectivity, workspaces[worker])
+                    : label_cc_2pass(job.img, own, job.eight_connectivity, workspaces[worker]);
+                for (int y = 0; y < H; ++y) {
+                    std::copy(own.row(y), own.row(y) + W, job.labels.row(y));
+                }
+                auto elapsed = ServiceClock::now() - t0;
+                job.label_us = std::chrono::duration<double, std::micro>(elapsed).count();
+                label_ns += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+            });
+        } catch (const std::exception& e) {
+            failure = e.what();
+        }
+        requests += batch.size();
+        batches++;
+        for (Job* job : batch) {
+            job->error = failure;
+            job->done.set_value();
+        }
+    }
+}
+
+void LabelServer::fill_stats(LabelReply& reply) {
+    reply.requests = requests;
+    reply.batches = batches;
+    reply.total_label_us = label_ns / 1e3;
+    reply.threads = pool.size();
+}
+
+// ---------------------------------------------------------------- LabelClient
+
+LabelClient::~LabelClient() {
+    if (fd >= 0) ::close(fd);
+}
+
+bool LabelClient::connect(const std::string& socket_path, std::string& error) {
+    sockaddr_un addr;
+    std::memset(&addr, 0, sizeof(addr));
+    if (socket_path.empty() || socket_path.size() >= sizeof(addr.sun_path)) {
+        error = "socket path too long";
+        return false;
+    }
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, socket_path.c_str(), socket_path.size());
+
+    if (fd >= 0) ::close(fd);
+    fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        error = socket_path + ": " + std::strerror(errno);
+        if (fd >= 0) ::close(fd);
+        fd = -1;
+        return false;
+    }
+    return true;
+}
+
+bool LabelClient::call(const LabelRequest& req, LabelReply& reply, std::string& error) {
+    if (fd < 0) {
+        error = "not connected";
+        return false;
+    }
+    if (!write_full(fd, &req, sizeof(req)) || !read_full(fd, &reply, sizeof(reply))) {
+        error = "connection to the label server lost";
+        return false;
+    }
+    return true;
+}
+
+bool LabelClient::call_sealed(const LabelRequest& req, const SharedMemory& input, const SharedMemory& output,
+                              LabelReply& reply, std::string& error) {
+    if (fd < 0) {
+        error = "not connected";
+        return false;
+    }
+    LabelRequest sealed = req;
+    sealed.sealed = 1;
+    int passed[2] = {input.fd(), output.fd()};
+    alignas(cmsghdr) char control[CMSG_SPACE(sizeof(passed))] = {};
+    iovec iov{&sealed, sizeof(sealed)};
+    msghdr msg{};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    cmsghdr* c = CMSG_FIRSTHDR(&msg);
+    c->cmsg_level = SOL_SOCKET;
+    c->cmsg_type = SCM_RIGHTS;
+    c->cmsg_len = CMSG_LEN(sizeof(passed));
+    std::memcpy(CMSG_DATA(c), passed, sizeof(passed));
+
+    // The fds travel with the first byte; the rest of a short send follows as usual
+    ssize_t r;
+    do {
+        r = ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+    } while (r < 0 && errno == EINTR);
+    if (r <= 0 ||
+        !write_full(fd, reinterpret_cast<const uint8_t*>(&sealed) + r, sizeof(sealed) - (size_t)r) ||
+        !read_full(fd, &reply, sizeof(reply))) {
+        error = "connection to the label server lost";
+        return false;
+    }
+    return true;
+}
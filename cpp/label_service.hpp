@@ -0,0 +1,191 @@
+#ifndef LABEL_SERVICE_HPP
+#define LABEL_SERVICE_HPP
+
+#include "dsu_2pass.hpp"
+#include "work_pool.hpp"
+#include <vector>
+#include <deque>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <memory>
+
+// Local labeling service: a long-lived process labels masks that clients
+// place in POSIX shared memory, so a call costs one small socket round
+// trip instead of a process spawn, file encode/decode and copies.
+//
+// Clients connect to a Unix domain socket and send fixed-size requests
+// naming an input segment (uint8 0/1 mask) and an output segment (int32
+// labels); the server labels from the input mapping into a buffer of its
+// own, copies the final labels out and replies with the component count
+// and timings. Requests from all connections are labeled in batches on a
+// WorkStealingPool with one CCLWorkspace per worker (see ccl_batch.hpp).
+//
+// Segments can be named POSIX shm or sealed memfds passed with the request
+// (LabelClient::call_sealed). The server checks a named segment's size on
+// every request, but a client that shrinks one while its call is running
+// can still fault the server; sealed memfds cannot shrink, so they are the
+// safe choice when clients are not trusted.
+
+const uint32_t LABEL_SERVICE_MAGIC = 0x314c4343;  // "CCL1"
+
+enum class ServiceOp : uint32_t {
+    Label = 1,
+    Stats = 2,     // server counters only
+    Shutdown = 3   // stop serving after replying
+};
+
+struct LabelRequest {
+    uint32_t magic = LABEL_SERVICE_MAGIC;
+    ServiceOp op = ServiceOp::Label;
+    char input[64] = {};    // shm name of the mask, e.g. "/ccl_in_0"
+    char output[64] = {};   // shm name of the labels (may hold other data around them)
+    int32_t H = 0, W = 0;
+    int64_t input_stride = 0;   // bytes between mask rows (0 = W)
+    int64_t output_stride = 0;  // int32 entries between label rows (0 = W)
+    uint64_t input_offset = 0;  // byte offset of pixel (0, 0) in the segment
+    uint64_t output_offset = 0; // byte offset of label (0, 0), a multiple of 4
+    uint8_t eight_connectivity = 0;
+    uint8_t crop = 0;           // label only the foreground bbox (roi.hpp)
+    uint8_t sealed = 0;         // segments arrive as memfds with the request; names unused
+    uint8_t reserved[5] = {};
+};
+
+struct LabelReply {
+    int32_t status = 0;       // 0 = ok, otherwise `error` says why
+    int32_t components = 0;
+    double queue_us = 0;      // waiting for a worker
+    double label_us = 0;      // labeling on the worker
+    // Stats (filled for every op)
+    uint64_t requests = 0;    // labels served so far
+    uint64_t batches = 0;     // pool runs they were grouped into
+    double total_label_us = 0;
+    int32_t threads = 0;
+    char error[100] = {};
+};
+
+// POSIX shared-memory segment mapped into this process; move-only
+class SharedMemory {
+public:
+    SharedMemory() = default;
+    ~SharedMemory();
+    SharedMemory(SharedMemory&& other) noexcept;
+    SharedMemory& operator=(SharedMemory&& other) noexcept;
+    SharedMemory(const SharedMemory&) = delete;
+    SharedMemory& operator=(const SharedMemory&) = delete;
+
+    // New read/write segment of `bytes` (replacing any stale one of that
+    // name); removed again when this object is destroyed
+    bool create(const std::string& name, size_t bytes, std::string& error);
+
+    // Existing segment, mapped at its current size
+    bool open(const std::string& name, bool writable, std::string& error);
+
+    // Anonymous read/write memfd of `bytes` that can no longer be resized
+    // (F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_SEAL), for call_sealed
+    bool create_sealed(size_t bytes, std::string& error);
+
+    // Map a received memfd, taking ownership of `fd`; fails unless it is
+    // sealed against shrinking
+    bool adopt(int fd, bool writable, std::string& error);
+
+    uint8_t* data() const { return ptr; }
+    size_t size() const { return bytes; }           // as mapped
+    size_t current_size() const;                    // of the file now; 0 on error
+    const std::string& name() const { return shm_name; }
+    bool writable() const { return rw; }
+    int fd() const { return seg_fd; }
+
+private:
+    void reset();
+
+    uint8_t* ptr = nullptr;
+    size_t bytes = 0;
+    std::string shm_name;
+    int seg_fd = -1;
+    bool owner = false;
+    bool rw = false;
+};
+
+class LabelServer {
+public:
+    // threads <= 0: hardware concurrency
+    explicit LabelServer(int threads = 0);
+    ~LabelServer();
+
+    // Bind and listen on `socket_path` (an existing socket file is replaced)
+    bool listen(const std::string& socket_path, std::string& error);
+
+    // Accept and serve connections until stop() or a Shutdown request
+    void serve();
+
+    // Safe from any thread; serve() returns once connections are closed
+    void stop();
+
+    int threads() const { return pool.size(); }
+
+    // Connection threads not yet joined: open connections plus those that
+    // ended since the last accept
+    size_t connection_threads_held();
+
+private:
+    struct Job;
+
+    void connection_loop(int fd);
+    void dispatch_loop();
+    void handle_label(const LabelRequest& req, LabelReply& reply, std::vector<int>& fds,
+                      std::vector<SharedMemory>& inputs, std::vector<SharedMemory>& outputs);
+    void fill_stats(LabelReply& reply);
+
+    WorkStealingPool pool;
+    std::vector<CCLWorkspace> workspaces;
+    // Labels are built here, never in a client-writable segment: the scan
+    // reads provisional labels back as DSU indices
+    std::vector<std::vector<int32_t>> label_buffers;
+    std::string path;
+    int listen_fd = -1;
+    std::atomic<bool> stopping{false};
+
+    // Pending jobs, taken in batches by the dispatcher
+    std::mutex queue_lock;
+    std::condition_variable queue_ready;
+    std::deque<Job*> queue;
+    std::thread dispatcher;
+
+    std::mutex connections_lock;
+    std::vector<int> connection_fds;
+    std::vector<std::thread> connection_threads;
+    std::vector<std::thread::id> finished_connections;  // joined at the next accept
+
+    std::atomic<uint64_t> requests{0};
+    std::atomic<uint64_t> batches{0};
+    std::atomic<uint64_t> label_ns{0};
+};
+
+// One connection; calls are synchronous
+class LabelClient {
+public:
+    LabelClient() = default;
+    ~LabelClient();
+    LabelClient(const LabelClient&) = delete;
+    LabelClient& operator=(const LabelClient&) = delete;
+
+    bool connect(const std::string& socket_path, std::string& error);
+
+    // Send `req` and wait for the reply; false on a transport error
+    bool call(const LabelRequest& req, LabelReply& reply, std::string& error);
+
+    // Same, passing `input` and `output` (from create_sealed) with the
+    // request instead of by name
+    bool call_sealed(const LabelRequest& req, const SharedMemory& input, const SharedMemory& output,
+                     LabelReply& reply, std::string& error);
+
+private:
+    int fd = -1;
+};
+
+#endif // LABEL_SERVICE_HPP
@@ -0,0 +1,388 @@
+#include "mask_io.hpp"
+#include "pnm.hpp"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#ifdef CCL_HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+// ------------------------------------------------------------------ MappedFile
+
+MappedFile::~MappedFile() {
+    reset();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        reset();
+        ptr = other.ptr;
+        bytes = other.bytes;
+        other.ptr = nullptr;
+        other.bytes = 0;
+    }
+    return *this;
+}
+
+void MappedFile::reset() {
+    if (ptr) ::munmap(ptr, bytes);
+    ptr = nullptr;
+    bytes = 0;
+}
+
+bool MappedFile::open(const std::string& path, bool populate, std::string& error) {
+    reset();
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+        error = path + ": empty or unreadable file";
+        ::close(fd);
+        return false;
+    }
+    int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+    if (populate) flags |= MAP_POPULATE;
+#else
+    (void)populate;
+#endif
+    void* p = ::mmap(nullptr, (size_t)st.st_size, PROT_READ, flags, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        error = path + ": mmap: " + std::strerror(errno);
+        return false;
+    }
+    ptr = static_cast<uint8_t*>(p);
+    bytes = (size_t)st.st_size;
+    return true;
+}
+
+// ------------------------------------------------------------------ NPY
+
+static const char NPY_MAGIC[] = "\x93NUMPY";
+
+// Text of `key`'s value in the header dict, up to the next top-level ',' or '}'
+static bool npy_field(const std::string& dict, const std::string& key, std::string& value) {
+    size_t k = dict.find("'" + key + "'");
+    if (k == std::string::npos) return false;
+    size_t p = dict.find(':', k);
+    if (p == std::string::npos) return false;
+    ++p;
+    while (p < dict.size() && dict[p] == ' ') ++p;
+    int depth = 0;
+    size_t end = p;
+    for (; end < dict.size(); ++end) {
+        char ch = dict[end];
+        if (ch == '(') depth++;
+        if (ch == ')') depth--;
+        if (depth == 0 && (ch == ',' || ch == '}')) break;
+    }
+    value = dict.substr(p, end - p);
+    return true;
+}
+
+bool parse_npy_header(const uint8_t* data, size_t size, NpyHeader& header, std::string& error) {
+    header = NpyHeader();
+    if (size < 10 || std::memcmp(data, NPY_MAGIC, 6) != 0) {
+        error = "not an NPY file";
+        return false;
+    }
+    size_t len, start;
+    if (data[6] == 1) {
+        len = data[8] | (size_t)data[9] << 8;
+        start = 10;
+    } else if ((data[6] == 2 || data[6] == 3) && size >= 12) {
+        len = data[8] | (size_t)data[9] << 8 | (size_t)data[10] << 16 | (size_t)data[11] << 24;
+        start = 12;
+    } else {
+        error = "unsupported NPY version";
+        return false;
+    }
+    if (start + len > size) {
+        error = "truncated NPY header";
+        return false;
+    }
+    std::string dict(reinterpret_cast<const char*>(data + start), len);
+
+    std::string descr, fortran, shape;
+    if (!npy_field(dict, "descr", descr) || !npy_field(dict, "fortran_order", fortran) ||
+        !npy_field(dict, "shape", shape) || descr.size() < 2) {
+        error = "bad NPY header";
+        return false;
+    }
+    header.descr = descr.substr(1, descr.size() - 2);  // strip quotes
+    header.fortran_order = fortran.compare(0, 4, "True") == 0;
+    for (size_t i = 0; i < shape.size();) {
+        if (std::isdigit((unsigned char)shape[i])) {
+            int64_t v = 0;
+            while (i < shape.size() && std::isdigit((unsigned char)shape[i])) v = v * 10 + (shape[i++] - '0');
+            header.shape.push_back(v);
+        } else {
+            ++i;
+        }
+    }
+    header.data_offset = start + len;
+    return true;
+}
+
+static std::string npy_header(int H, int W) {
+    std::string dict = "{'descr': '<i4', 'fortran_order': False, 'shape': (" + std::to_string(H) + ", " +
+                       std::to_string(W) + "), }";
+    // Data starts on a 64-byte boundary; the header ends with '\n'
+    size_t unpadded = 10 + dict.size() + 1;
+    dict.append((64 - unpadded % 64) % 64, ' ');
+    dict += '\n';
+    std::string header(NPY_MAGIC, 6);
+    header += '\x01';
+    header += '\x00';
+    header += (char)(dict.size() & 0xff);
+    header += (char)(dict.size() >> 8);
+    return header + dict;
+}
+
+// ------------------------------------------------------------------ masks
+
+bool open_mask(const std::string& path, int raw_h, int raw_w, MaskFile& mask, std::string& error) {
+    mask = MaskFile();
+    mask.path = path;
+    if (!mask.file.open(path, true, error)) return false;
+    const uint8_t* data = mask.file.data();
+    size_t size = mask.file.size();
+
+    if (size >= 6 && std::memcmp(data, NPY_MAGIC, 6) == 0) {
+        NpyHeader h;
+        if (!parse_npy_header(data, size, h, error)) {
+            error = path + ": " + error;
+            return false;
+        }
+        if (h.descr != "|u1" && h.descr != "|b1" && h.descr != "|i1") {
+            error = path + ": NPY dtype " + h.descr + " (expected uint8 or bool)";
+            return false;
+        }
+        if (h.shape.size() != 2 || h.fortran_order || h.shape[0] <= 0 || h.shape[1] <= 0 ||
+            h.shape[0] > INT32_MAX || h.shape[1] > INT32_MAX) {
+            error = path + ": expected a 2-D C-order array";
+            return false;
+        }
+        if (h.data_offset + (size_t)(h.shape[0] * h.shape[1]) > size) {
+            error = path + ": truncated NPY data";
+            return false;
+        }
+        mask.view = ImageView(data + h.data_offset, (int)h.shape[0], (int)h.shape[1]);
+        return true;
+    }
+
+    if (size >= 2 && data[0] == 'P' && data[1] >= '1' && data[1] <= '6') {
+        PnmHeader h;
+        if (!parse_pnm_header(data, size, h, error)) {
+            error = path + ": " + error;
+            return false;
+        }
+        if (h.kind == '5' && h.maxval <= 255) {
+            if (h.data_offset + (size_t)h.H * h.W > size) {
+                error = path + ": truncated pixel data";
+                return false;
+            }
+            mask.view = ImageView(data + h.data_offset, h.H, h.W);
+            return true;
+        }
+        PnmImage image;
+        if (!parse_pnm(data, size, image, error)) {
+            error = path + ": " + error;
+            return false;
+        }
+        mask.decoded = pnm_to_mask(image);
+        mask.view = ImageView(mask.decoded, image.H, image.W);
+        return true;
+    }
+
+    if (raw_h <= 0 || raw_w <= 0) {
+        error = path + ": not NPY or Netpbm (pass the size of raw masks)";
+        return false;
+    }
+    if (size != (size_t)raw_h * raw_w) {
+        error = path + ": " + std::to_string(size) + " bytes, expected " + std::to_string((size_t)raw_h * raw_w);
+        return false;
+    }
+    mask.view = ImageView(data, raw_h, raw_w);
+    return true;
+}
+
+// ------------------------------------------------------------------ output
+
+bool write_npy(const std::string& path, const LabelView& labels, std::string& error) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+    std::string header = npy_header(labels.H, labels.W);
+    bool ok = std::fwrite(header.data(), 1, header.size(), f) == header.size();
+    if (labels.dense()) {
+        size_t n = (size_t)labels.H * labels.W;
+        ok = ok && std::fwrite(labels.data, sizeof(int32_t), n, f) == n;
+    } else {
+        for (int y = 0; ok && y < labels.H; ++y) {
+            ok = std::fwrite(labels.row(y), sizeof(int32_t), (size_t)labels.W, f) == (size_t)labels.W;
+        }
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) error = path + ": write failed";
+    return ok;
+}
+
+bool write_npy(const std::string& path, const RunLabels& runs, std::string& error) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+    std::string header = npy_header(runs.H, runs.W);
+    bool ok = std::fwrite(header.data(), 1, header.size(), f) == header.size();
+    std::vector<int32_t> row((size_t)runs.W);
+    for (int y = 0; ok && y < runs.H; ++y) {
+        runs_to_dense(runs, y, row.data());
+        ok = std::fwrite(row.data(), sizeof(int32_t), row.size(), f) == row.size();
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) error = path + ": write failed";
+    return ok;
+}
+
+#ifdef CCL_HAVE_ZLIB
+
+bool npz_supported() {
+    return true;
+}
+
+static void put16(std::string& s, uint32_t v) {
+    s += (char)(v & 0xff);
+    s += (char)((v >> 8) & 0xff);
+}
+
+static void put32(std::string& s, uint32_t v) {
+    put16(s, v & 0xffff);
+    put16(s, v >> 16);
+}
+
+// Zip local (central = false) or central directory header of the one entry
+static std::string zip_header(bool central, uint32_t crc, uint32_t csize, uint32_t usize, const std::string& name) {
+    std::string h;
+    put32(h, central ? 0x02014b50 : 0x04034b50);
+    if (central) put16(h, 20);  // version made by
+    put16(h, 20);               // version needed
+    put16(h, 0);                // flags
+    put16(h, 8);                // deflate
+    put16(h, 0);                // time 00:00
+    put16(h, (1 << 5) | 1);     // date 1980-01-01
+    put32(h, crc);
+    put32(h, csize);
+    put32(h, usize);
+    put16(h, (uint32_t)name.size());
+    put16(h, 0);                // extra length
+    if (central) {
+        put16(h, 0);            // comment length
+        put16(h, 0);            // disk
+        put16(h, 0);            // internal attributes
+        put32(h, 0);            // external attributes
+        put32(h, 0);            // local header offset
+    }
+    return h + name;
+}
+
+bool write_npz(const std::string& path, const LabelView& labels, std::string& error) {
+    const std::string name = "labels.npy";
+    std::string header = npy_header(labels.H, labels.W);
+    uint64_t usize = header.size() + (uint64_t)labels.H * labels.W * sizeof(int32_t);
+    if (usize > 0xffffffffu) {
+        error = path + ": labels over 4 GiB need zip64; write NPY instead";
+        return false;
+    }
+
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) {
+        error = path + ": " + std::strerror(errno);
+        return false;
+    }
+    std::string local = zip_header(false, 0, 0, 0, name);  // rewritten once sizes are known
+    bool ok = std::fwrite(local.data(), 1, local.size(), f) == local.size();
+
+    z_stream zs;
+    std::memset(&zs, 0, sizeof(zs));
+    ok = ok && deflateInit2(&zs, Z_BEST_SPEED, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK;
+    uLong crc = crc32(0L, Z_NULL, 0);
+    uint64_t csize = 0;
+    std::vector<uint8_t> out(1 << 16);
+
+    // Feed the NPY header and then each label row; flush on the last one
+    auto feed = [&](const void* data, size_t n, bool last) {
+        crc = crc32(crc, static_cast<const Bytef*>(data), (uInt)n);
+        zs.next_in = static_cast<Bytef*>(const_cast<void*>(data));
+        zs.avail_in = (uInt)n;
+        int flush = last ? Z_FINISH : Z_NO_FLUSH;
+        int rc;
+        do {
+            zs.next_out = out.data();
+            zs.avail_out = (uInt)out.size();
+            rc = deflate(&zs, flush);
+            size_t produced = out.size() - zs.avail_out;
+            csize += produced;
+            ok = ok && std::fwrite(out.data(), 1, produced, f) == produced;
+        } while (ok && (zs.avail_out == 0 || (last && rc != Z_STREAM_END)));
+    };
+    if (ok) {
+        feed(header.data(), header.size(), labels.H == 0);
+        for (int y = 0; ok && y < labels.H; ++y) {
+            feed(labels.row(y), (size_t)labels.W * sizeof(int32_t), y == labels.H - 1);
+        }
+        deflateEnd(&zs);
+    }
+
+    if (ok && csize <= 0xffffffffu) {
+        uint32_t offset = (uint32_t)(local.size() + csize);
+        std::string central = zip_header(true, (uint32_t)crc, (uint32_t)csize, (uint32_t)usize, name);
+        std::string end;
+        put32(end, 0x06054b50);
+        put16(end, 0);
+        put16(end, 0);
+        put16(end, 1);
+        put16(end, 1);
+        put32(end, (uint32_t)central.size());
+        put32(end, offset);
+        put16(end, 0);
+        ok = std::fwrite(central.data(), 1, central.size(), f) == central.size() &&
+             std::fwrite(end.data(), 1, end.size(), f) == end.size();
+        local = zip_header(false, (uint32_t)crc, (uint32_t)csize, (uint32_t)usize, name);
+        ok = ok && std::fseek(f, 0, SEEK_SET) == 0 && std::fwrite(local.data(), 1, local.size(), f) == local.size();
+    } else {
+        ok = false;
+    }
+    ok = (std::fclose(f) == 0) && ok;
+    if (!ok) error = path + ": write failed";
+    return ok;
+}
+
+#else
+
+bool npz_supported() {
+    return false;
+}
+
+bool write_npz(const std::string& path, const LabelView&, std::string& error) {
+    error = path + ": built without zlib, NPZ output unavailable";
+    return false;
+}
+
+#endif
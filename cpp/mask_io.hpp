@@ -0,0 +1,73 @@
+#ifndef MASK_IO_HPP
+#define MASK_IO_HPP
+
+#include "image_view.hpp"
+#include "run_labels.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// File I/O for batch labeling (ccl_cli): memory-mapped mask inputs and
+// NPY / NPZ label outputs.
+//
+// Binary PGM (P5, 8-bit), NPY (uint8 or bool, C order) and headerless raw
+// masks are labeled straight from the mapping through an ImageView; other
+// Netpbm variants are decoded into a buffer. Nonzero is foreground.
+
+// Read-only mapping of a whole file; move-only
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // `populate` faults every page in now (on the calling thread)
+    bool open(const std::string& path, bool populate, std::string& error);
+
+    const uint8_t* data() const { return ptr; }
+    size_t size() const { return bytes; }
+
+private:
+    void reset();
+
+    uint8_t* ptr = nullptr;
+    size_t bytes = 0;
+};
+
+struct NpyHeader {
+    std::string descr;          // e.g. "|u1", "<i4"
+    bool fortran_order = false;
+    std::vector<int64_t> shape;
+    size_t data_offset = 0;
+};
+
+bool parse_npy_header(const uint8_t* data, size_t size, NpyHeader& header, std::string& error);
+
+struct MaskFile {
+    std::string path;
+    MappedFile file;
+    std::vector<uint8_t> decoded;  // only for formats that cannot be used in place
+    ImageView view;                // into `file` or `decoded`
+};
+
+// Map `path` (".npy", Netpbm, or raw bytes when raw_h > 0) and locate its
+// raster. Files are mapped with populate so the disk read happens here.
+bool open_mask(const std::string& path, int raw_h, int raw_w, MaskFile& mask, std::string& error);
+
+// int32 labels as NPY (version 1.0, C order)
+bool write_npy(const std::string& path, const LabelView& labels, std::string& error);
+
+// Same array from run-length labels, expanded one row at a time so the
+// dense image never exists in memory
+bool write_npy(const std::string& path, const RunLabels& runs, std::string& error);
+
+// Same array as "labels.npy" inside a deflated NPZ (np.load(path)["labels"]).
+// Needs zlib at build time; npz_supported() says whether it was available.
+bool write_npz(const std::string& path, const LabelView& labels, std::string& error);
+bool npz_supported();
+
+#endif // MASK_IO_HPP
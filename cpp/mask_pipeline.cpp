@@ -0,0 +1,141 @@
+#include "mask_pipeline.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+
+void gray_histogram(const uint8_t* gray, size_t n, uint32_t hist[256]) {
+    uint32_t bank[4][256];
+    std::memset(bank, 0, sizeof(bank));
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        bank[0][gray[i]]++;
+        bank[1][gray[i + 1]]++;
+        bank[2][gray[i + 2]]++;
+        bank[3][gray[i + 3]]++;
+    }
+    for (; i < n; ++i) {
+        bank[0][gray[i]]++;
+    }
+    for (int v = 0; v < 256; ++v) {
+        hist[v] = bank[0][v] + bank[1][v] + bank[2][v] + bank[3][v];
+    }
+}
+
+int otsu_threshold(const uint32_t hist[256]) {
+    double total = 0, sum_total = 0;
+    for (int t = 0; t < 256; ++t) {
+        total += hist[t];
+        sum_total += (double)t * hist[t];
+    }
+
+    double sum_b = 0, w_b = 0, var_max = 0;
+    int threshold = 0;
+    for (int t = 0; t < 256; ++t) {
+        w_b += hist[t];
+        if (w_b == 0) continue;
+        double w_f = total - w_b;
+        if (w_f == 0) break;
+
+        sum_b += (double)t * hist[t];
+        double m_b = sum_b / w_b;
+        double m_f = (sum_total - sum_b) / w_f;
+        double var_between = w_b * w_f * (m_b - m_f) * (m_b - m_f);
+        if (var_between > var_max) {
+            var_max = var_between;
+            threshold = t;
+        }
+    }
+    return threshold;
+}
+
+void gaussian_blur(const uint8_t* gray, int H, int W, double sigma, uint8_t* out) {
+    size_t n = (size_t)H * W;
+    if (sigma <= 0) {
+        std::copy(gray, gray + n, out);
+        return;
+    }
+
+    // 14-bit fixed-point taps, radius 3 sigma
+    int r = std::max(1, (int)std::ceil(3 * sigma));
+    std::vector<double> w(2 * r + 1);
+    double sum = 0;
+    for (int k = -r; k <= r; ++k) sum += w[k + r] = std::exp(-0.5 * k * k / (sigma * sigma));
+    std::vector<int32_t> taps(2 * r + 1);
+    for (int k = 0; k <= 2 * r; ++k) taps[k] = (int32_t)std::lround(w[k] / sum * (1 << 14));
+
+    auto norm = [](int32_t acc) { return (uint8_t)std::min(255, std::max(0, (acc + (1 << 13)) >> 14)); };
+
+    // Horizontal: through an edge-padded copy of the row, so the tap loop
+    // has no bounds checks
+    std::vector<uint8_t> tmp(n);
+    std::vector<uint8_t> padded(W + 2 * r);
+    for (int y = 0; y < H; ++y) {
+        const uint8_t* row = gray + (size_t)y * W;
+        std::fill(padded.begin(), padded.begin() + r, row[0]);
+        std::copy(row, row + W, padded.begin() + r);
+        std::fill(padded.begin() + r + W, padded.end(), row[W - 1]);
+        uint8_t* dst = tmp.data() + (size_t)y * W;
+        for (int x = 0; x < W; ++x) {
+            int32_t acc = 0;
+            for (int k = 0; k <= 2 * r; ++k) acc += taps[k] * padded[x + k];
+            dst[x] = norm(acc);
+        }
+    }
+
+    // Vertical: accumulate whole source rows, contiguous in x
+    std::vector<int32_t> acc(W);
+    for (int y = 0; y < H; ++y) {
+        std::fill(acc.begin(), acc.end(), 0);
+        for (int k = -r; k <= r; ++k) {
+            const uint8_t* src = tmp.data() + (size_t)std::min(H - 1, std::max(0, y + k)) * W;
+            int32_t tap = taps[k + r];
+            for (int x = 0; x < W; ++x) acc[x] += tap * src[x];
+        }
+        uint8_t* dst = out + (size_t)y * W;
+        for (int x = 0; x < W; ++x) dst[x] = norm(acc[x]);
+    }
+}
+
+MaskPipelineResult run_mask_pipeline(const uint8_t* gray, int H, int W,
+                                     const MaskPipelineOptions& opts, CCLWorkspace& ws) {
+    using clock = std::chrono::steady_clock;
+    auto us_since = [](clock::time_point t0) {
+        return std::chrono::duration<double, std::micro>(clock::now() - t0).count();
+    };
+
+    MaskPipelineResult result;
+    size_t n = (size_t)H * W;
+
+    std::vector<uint8_t> blurred;
+    const uint8_t* src = gray;
+    if (opts.smooth > 0) {
+        auto t0 = clock::now();
+        blurred.resize(n);
+        gaussian_blur(gray, H, W, opts.smooth, blurred.data());
+        src = blurred.data();
+        result.times.blur_us = us_since(t0);
+    }
+
+    auto t0 = clock::now();
+    uint32_t hist[256];
+    gray_histogram(src, n, hist);
+    result.threshold = opts.threshold >= 0 ? std::min(opts.threshold, 255) : otsu_threshold(hist);
+    int64_t below = 0;
+    for (int t = 0; t <= result.threshold; ++t) below += hist[t];
+    result.foreground = opts.invert ? (int64_t)n - below : below;
+    result.times.histogram_us = us_since(t0);
+
+    t0 = clock::now();
+    result.labels.resize(n);
+    if (opts.open_iterations > 0) {
+        result.components = label_cc_2pass_morphology(src, H, W, (uint8_t)result.threshold, opts.invert,
+                                                      opening_steps(opts.open_se, opts.open_iterations),
+                                                      opts.eight_connectivity, ws, result.labels.data());
+    } else {
+        result.components = label_cc_2pass_threshold(src, H, W, (uint8_t)result.threshold, opts.invert,
+                                                     opts.eight_connectivity, ws, result.labels.data());
+    }
+    result.times.label_us = us_since(t0);
+    return result;
+}
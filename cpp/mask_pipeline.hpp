@@ -0,0 +1,55 @@
+#ifndef MASK_PIPELINE_HPP
+#define MASK_PIPELINE_HPP
+
+#include "dsu_2pass.hpp"
+#include "morphology.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Native version of python/make_mask.py's "otsu" method, fused with
+// labeling: grayscale (decoded by pnm.hpp) -> optional Gaussian blur ->
+// histogram -> Otsu threshold -> two-pass labeling that tests
+// `gray <= threshold` in its first pass. The binary mask is never stored;
+// with an opening, each gray row is thresholded into bits only when the
+// morphology chain needs it, and cleaned up just ahead of the labeling
+// scan, so the only scratch is a few bit-packed rows (morphology.hpp).
+
+struct MaskPipelineOptions {
+    double smooth = 1.0;      // Gaussian sigma in pixels (GaussianBlur radius); 0 disables
+    int threshold = -1;       // fixed threshold; -1 selects Otsu
+    bool invert = false;      // foreground is gray > threshold
+    bool eight_connectivity = false;
+    int open_iterations = 0;  // binary opening before labeling (make_mask's morph_open)
+    StructElem open_se = StructElem::Cross;
+};
+
+struct MaskPipelineTimes {
+    double blur_us = 0;
+    double histogram_us = 0;
+    double label_us = 0;      // including the opening, which is fused with it
+};
+
+struct MaskPipelineResult {
+    int threshold;
+    int components;
+    int64_t foreground;         // pixels on the foreground side of the threshold (before opening)
+    std::vector<int32_t> labels;
+    MaskPipelineTimes times;
+};
+
+// 256-bin histogram. Counts go to four interleaved banks that are summed
+// at the end, so consecutive equal samples do not serialize on one counter.
+void gray_histogram(const uint8_t* gray, size_t n, uint32_t hist[256]);
+
+// Threshold maximizing between-class variance; same loop (and ties) as
+// make_mask.otsu_threshold
+int otsu_threshold(const uint32_t hist[256]);
+
+// Separable Gaussian with edge clamping, into `out` (H*W)
+void gaussian_blur(const uint8_t* gray, int H, int W, double sigma, uint8_t* out);
+
+MaskPipelineResult run_mask_pipeline(const uint8_t* gray, int H, int W,
+                                     const MaskPipelineOptions& opts, CCLWorkspace& ws);
+
+#endif // MASK_PIPELINE_HPP
@@ -1,31 +1,24 @@
 #include "dsu_2pass.hpp"
 #include "algorithms.hpp"
+#include "workload.hpp"
+#include "bench_harness.hpp"
+#include "alloc_tracker.hpp"
 #include <iostream>
 #include <vector>
-#include <chrono>
-#include <random>
 #include <iomanip>
 #include <map>
 #include <set>
 #include <algorithm>
 #include <cstring>
-#include <sys/resource.h>
 
 struct Metrics {
     double time_us;
-    size_t memory_kb;
+    AllocStats memory;  // heap use of one call, including the returned labels
     int components;
     int num_operations;
     double throughput_mpixels_per_sec;
 };
 
-// Get memory usage in KB
-size_t get_memory_usage() {
-    struct rusage usage;
-    getrusage(RUSAGE_SELF, &usage);
-    return usage.ru_maxrss;  // KB on macOS/Linux
-}
-
 Metrics benchmark_with_metrics(
     std::vector<int32_t> (*func)(const uint8_t*, int, int, bool),
     const uint8_t* img, int H, int W, bool eight_conn,
@@ -34,28 +27,15 @@ Metrics benchmark_with_metrics(
     Metrics m;
     m.num_operations = iterations;
     
-    // Warm up
-    func(img, H, W, eight_conn);
-    
-    // Measure memory before
-    size_t mem_before = get_memory_usage();
-    
-    // Time measurement
-    auto start = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < iterations; ++i) {
-        func(img, H, W, eight_conn);
-    }
-    auto end = std::chrono::high_resolution_clock::now();
-    
-    // Measure memory after
-    size_t mem_after = get_memory_usage();
+    // Time measurement (median per call, with warm-up)
+    BenchOptions opts;
+    opts.repetitions = iterations;
+    m.time_us = run_benchmark([&] { func(img, H, W, eight_conn); }, opts).median_us;
     
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-    m.time_us = duration.count() / (double)iterations;
-    m.memory_kb = mem_after > mem_before ? (mem_after - mem_before) : 0;
-    
-    // Get component count
+    // Heap accounting and component count from one more call
+    AllocScope scope;
     auto result = func(img, H, W, eight_conn);
+    m.memory = scope.stop();
     std::set<int32_t> comps;
     for (int i = 0; i < H * W; ++i) {
         if (result[i] > 0) comps.insert(result[i]);
@@ -70,9 +50,9 @@ Metrics benchmark_with_metrics(
 }
 
 void print_metrics_table(const std::vector<std::pair<std::string, Metrics>>& results, int H, int W) {
-    std::cout << "\n" << std::string(100, '=') << "\n";
+    std::cout << "\n" << std::string(110, '=') << "\n";
     std::cout << "DETAILED METRICS COMPARISON\n";
-    std::cout << std::string(100, '=') << "\n";
+    std::cout << std::string(110, '=') << "\n";
     std::cout << "Image Size: " << H << "x" << W << " (" << (H*W/1e6) << " MPixels)\n\n";
     
     // Find best time
@@ -84,11 +64,13 @@ void print_metrics_table(const std::vector<std::pair<std::string, Metrics>>& res
     std::cout << std::left << std::setw(20) << "Algorithm";
     std::cout << std::right << std::setw(12) << "Time (μs)";
     std::cout << std::setw(15) << "Speedup";
-    std::cout << std::setw(12) << "Memory (KB)";
+    std::cout << std::setw(12) << "Peak (KB)";
+    std::cout << std::setw(12) << "Total (KB)";
+    std::cout << std::setw(9) << "Allocs";
     std::cout << std::setw(15) << "Throughput";
     std::cout << std::setw(12) << "Components";
     std::cout << "\n";
-    std::cout << std::string(100, '-') << "\n";
+    std::cout << std::string(110, '-') << "\n";
     
     for (const auto& [name, m] : results) {
         std::cout << std::left << std::setw(20) << name;
@@ -98,12 +80,14 @@ void print_metrics_table(const std::vector<std::pair<std::string, Metrics>>& res
         double speedup = best_time / m.time_us;
         std::cout << std::setw(14) << std::setprecision(2) << speedup << "x";
         
-        std::cout << std::setw(12) << m.memory_kb;
+        std::cout << std::setw(12) << m.memory.peak_bytes / 1024;
+        std::cout << std::setw(12) << m.memory.total_bytes / 1024;
+        std::cout << std::setw(9) << m.memory.allocations;
         std::cout << std::setw(13) << std::setprecision(2) << m.throughput_mpixels_per_sec << " MP/s";
         std::cout << std::setw(12) << m.components;
         std::cout << "\n";
     }
-    std::cout << std::string(100, '=') << "\n\n";
+    std::cout << std::string(110, '=') << "\n\n";
 }
 
 void test_different_densities(int H, int W, bool eight_conn, int iterations) {
@@ -125,14 +109,7 @@ void test_different_densities(int H, int W, bool eight_conn, int iterations) {
     
     for (double density : densities) {
         // Generate test image
-        std::random_device rd;
-        std::mt19937 gen(42);
-        std::uniform_real_distribution<> dis(0.0, 1.0);
-        
-        std::vector<uint8_t> img(H * W);
-        for (int i = 0; i < H * W; ++i) {
-            img[i] = (dis(gen) < density) ? 1 : 0;
-        }
+        std::vector<uint8_t> img = generate_random_image(H, W, density, 42);
         
         // Benchmark all algorithms
         auto m_2pass = benchmark_with_metrics(label_cc_2pass, img.data(), H, W, eight_conn, iterations, "2-Pass");
@@ -173,14 +150,7 @@ void test_different_sizes(bool eight_conn, int iterations) {
     
     for (const auto& [H, W] : sizes) {
         // Generate test image
-        std::random_device rd;
-        std::mt19937 gen(42);
-        std::uniform_real_distribution<> dis(0.0, 1.0);
-        
-        std::vector<uint8_t> img(H * W);
-        for (int i = 0; i < H * W; ++i) {
-            img[i] = (dis(gen) < density) ? 1 : 0;
-        }
+        std::vector<uint8_t> img = generate_random_image(H, W, density, 42);
         
         // Benchmark all algorithms
         auto m_2pass = benchmark_with_metrics(label_cc_2pass, img.data(), H, W, eight_conn, iterations, "2-Pass");
@@ -217,14 +187,9 @@ int main(int argc, char* argv[]) {
     if (argc > 6) full_analysis = (std::stoi(argv[6]) != 0);
 
     // Generate test image
-    std::random_device rd;
-    std::mt19937 gen(42);
-    std::uniform_real_distribution<> dis(0.0, 1.0);
-    
-    std::vector<uint8_t> img(H * W);
+    std::vector<uint8_t> img = generate_random_image(H, W, density, 42);
     int foreground_count = 0;
     for (int i = 0; i < H * W; ++i) {
-        img[i] = (dis(gen) < density) ? 1 : 0;
         if (img[i] == 1) foreground_count++;
     }
 
@@ -280,25 +245,28 @@ int main(int argc, char* argv[]) {
     std::cout << "Slowest Algorithm: " << slowest << " (" << max_time << " μs)\n";
     std::cout << "Speed Difference: " << (max_time / min_time) << "x\n";
     
-    // Memory comparison
-    size_t min_mem = results[0].second.memory_kb;
-    size_t max_mem = results[0].second.memory_kb;
+    // Memory comparison (peak heap per call)
+    size_t min_mem = results[0].second.memory.peak_bytes / 1024;
+    size_t max_mem = results[0].second.memory.peak_bytes / 1024;
     std::string most_mem = results[0].first;
     std::string least_mem = results[0].first;
     
     for (const auto& [name, m] : results) {
-        if (m.memory_kb < min_mem) {
-            min_mem = m.memory_kb;
+        if (m.memory.peak_bytes / 1024 < min_mem) {
+            min_mem = m.memory.peak_bytes / 1024;
             least_mem = name;
         }
-        if (m.memory_kb > max_mem) {
-            max_mem = m.memory_kb;
+        if (m.memory.peak_bytes / 1024 > max_mem) {
+            max_mem = m.memory.peak_bytes / 1024;
             most_mem = name;
         }
     }
     
     std::cout << "Most Memory Efficient: " << least_mem << " (" << min_mem << " KB)\n";
     std::cout << "Least Memory Efficient: " << most_mem << " (" << max_mem << " KB)\n";
+    if (!alloc_tracking_enabled()) {
+        std::cout << "(heap tracking not linked in; memory columns are zero)\n";
+    }
     
     std::cout << std::string(100, '=') << "\n\n";
 
@@ -0,0 +1,172 @@
+#include "morphology.hpp"
+#include <algorithm>
+
+BitMask pack_mask(const uint8_t* img, int H, int W) {
+    BitMask mask(H, W);
+    for (int y = 0; y < H; ++y) {
+        const uint8_t* src = img + (size_t)y * W;
+        uint64_t* dst = mask.row(y);
+        for (int x = 0; x < W; ++x) {
+            dst[x >> 6] |= (uint64_t)(src[x] != 0) << (x & 63);
+        }
+    }
+    return mask;
+}
+
+void pack_threshold_row(const uint8_t* gray, int W, uint8_t threshold, bool invert, uint64_t* out) {
+    std::fill(out, out + (W + 63) / 64, 0);
+    for (int x = 0; x < W; ++x) {
+        out[x >> 6] |= (uint64_t)((gray[x] <= threshold) != invert) << (x & 63);
+    }
+}
+
+BitMask pack_threshold(const uint8_t* gray, int H, int W, uint8_t threshold, bool invert) {
+    BitMask mask(H, W);
+    for (int y = 0; y < H; ++y) {
+        pack_threshold_row(gray + (size_t)y * W, W, threshold, invert, mask.row(y));
+    }
+    return mask;
+}
+
+std::vector<uint8_t> unpack_mask(const BitMask& mask) {
+    std::vector<uint8_t> img((size_t)mask.H * mask.W);
+    for (int y = 0; y < mask.H; ++y) {
+        for (int x = 0; x < mask.W; ++x) {
+            img[(size_t)y * mask.W + x] = mask.get(y, x);
+        }
+    }
+    return img;
+}
+
+std::vector<MorphStep> opening_steps(StructElem se, int iterations) {
+    std::vector<MorphStep> steps(iterations, MorphStep{false, se});
+    steps.insert(steps.end(), iterations, MorphStep{true, se});
+    return steps;
+}
+
+std::vector<MorphStep> closing_steps(StructElem se, int iterations) {
+    std::vector<MorphStep> steps(iterations, MorphStep{true, se});
+    steps.insert(steps.end(), iterations, MorphStep{false, se});
+    return steps;
+}
+
+// Pixel x-1 / x+1 moved to position x, across word boundaries; pixels
+// beyond the row are 0
+static inline uint64_t from_left(const uint64_t* r, int i) {
+    return (r[i] << 1) | (i > 0 ? r[i - 1] >> 63 : 0);
+}
+
+static inline uint64_t from_right(const uint64_t* r, int i, int words) {
+    return (r[i] >> 1) | (i + 1 < words ? r[i + 1] << 63 : 0);
+}
+
+// One 3x3 step for one row: `up` / `down` are the neighbouring input rows
+// (zero rows at the border)
+static void morph_row(const MorphStep& step, const uint64_t* up, const uint64_t* mid, const uint64_t* down,
+                      int words, uint64_t last_mask, uint64_t* vert, uint64_t* out) {
+    if (step.se == StructElem::Cross) {
+        for (int i = 0; i < words; ++i) {
+            uint64_t l = from_left(mid, i), r = from_right(mid, i, words);
+            out[i] = step.dilate ? (mid[i] | l | r | up[i] | down[i])
+                                 : (mid[i] & l & r & up[i] & down[i]);
+        }
+    } else {
+        // Square: vertical combine first, then horizontal
+        for (int i = 0; i < words; ++i) {
+            vert[i] = step.dilate ? (up[i] | mid[i] | down[i]) : (up[i] & mid[i] & down[i]);
+        }
+        for (int i = 0; i < words; ++i) {
+            uint64_t l = from_left(vert, i), r = from_right(vert, i, words);
+            out[i] = step.dilate ? (vert[i] | l | r) : (vert[i] & l & r);
+        }
+    }
+    out[words - 1] &= last_mask;
+}
+
+MorphologyStream::MorphologyStream(const BitMask& in, std::vector<MorphStep> s)
+    : input(&in), H(in.H), W(in.W), words(in.words), steps(std::move(s)), rings(steps.size() + 1),
+      computed(steps.size() + 1, 0), zero(words, 0), scratch(words, 0) {
+    for (size_t k = 1; k < rings.size(); ++k) rings[k].assign(3 * (size_t)words, 0);
+}
+
+MorphologyStream::MorphologyStream(int h, int w, RowPacker src, std::vector<MorphStep> s)
+    : input(nullptr), source(std::move(src)), H(h), W(w), words((w + 63) / 64), steps(std::move(s)),
+      rings(steps.size() + 1), computed(steps.size() + 1, 0), zero(words, 0), scratch(words, 0) {
+    for (auto& ring : rings) ring.assign(3 * (size_t)words, 0);
+}
+
+const uint64_t* MorphologyStream::stage_row(size_t stage, int y) {
+    if (y < 0 || y >= H) return nullptr;
+    if (stage == 0) {
+        if (input) return input->row(y);
+        while (computed[0] <= y) {
+            source(computed[0], rings[0].data() + (size_t)(computed[0] % 3) * words);
+            computed[0]++;
+        }
+        return rings[0].data() + (size_t)(y % 3) * words;
+    }
+
+    // Stage `stage` is the output of steps[stage - 1]
+    size_t k = stage;
+    uint64_t last_mask = (W & 63) ? ((uint64_t)1 << (W & 63)) - 1 : ~(uint64_t)0;
+    while (computed[k] <= y) {
+        int r = computed[k];
+        const uint64_t* up = stage_row(stage - 1, r - 1);
+        const uint64_t* down = stage_row(stage - 1, r + 1);  // computes r+1 before r's slot is reused
+        const uint64_t* mid = stage_row(stage - 1, r);
+        uint64_t* out = rings[k].data() + (size_t)(r % 3) * words;
+        morph_row(steps[k - 1], up ? up : zero.data(), mid, down ? down : zero.data(), words, last_mask,
+                  scratch.data(), out);
+        computed[k]++;
+    }
+    return rings[k].data() + (size_t)(y % 3) * words;
+}
+
+const uint64_t* MorphologyStream::row(int y) {
+    return stage_row(steps.size(), y);
+}
+
+BitMask morphology(const BitMask& input, const std::vector<MorphStep>& steps) {
+    BitMask out(input.H, input.W);
+    if (input.H == 0 || input.W == 0) return out;
+    MorphologyStream stream(input, steps);
+    for (int y = 0; y < input.H; ++y) {
+        const uint64_t* r = stream.row(y);
+        std::copy(r, r + input.words, out.row(y));
+    }
+    return out;
+}
+
+BitMask erode(const BitMask& input, StructElem se, int iterations) {
+    return morphology(input, std::vector<MorphStep>(iterations, MorphStep{false, se}));
+}
+
+BitMask dilate(const BitMask& input, StructElem se, int iterations) {
+    return morphology(input, std::vector<MorphStep>(iterations, MorphStep{true, se}));
+}
+
+BitMask opening(const BitMask& input, StructElem se, int iterations) {
+    return morphology(input, opening_steps(se, iterations));
+}
+
+BitMask closing(const BitMask& input, StructElem se, int iterations) {
+    return morphology(input, closing_steps(se, iterations));
+}
+
+int label_cc_2pass_morphology(const BitMask& input, const std::vector<MorphStep>& steps,
+                              bool eight_connectivity, CCLWorkspace& ws, int32_t* labels) {
+    if (input.H == 0 || input.W == 0) return 0;
+    MorphologyStream stream(input, steps);
+    return label_cc_2pass_rows([&](int y) { return stream.row(y); }, input.H, input.W,
+                               eight_connectivity, ws, labels);
+}
+
+int label_cc_2pass_morphology(const uint8_t* gray, int H, int W, uint8_t threshold, bool invert,
+                              const std::vector<MorphStep>& steps, bool eight_connectivity,
+                              CCLWorkspace& ws, int32_t* labels) {
+    if (H == 0 || W == 0) return 0;
+    MorphologyStream stream(H, W, [&](int y, uint64_t* out) {
+        pack_threshold_row(gray + (size_t)y * W, W, threshold, invert, out);
+    }, steps);
+    return label_cc_2pass_rows([&](int y) { return stream.row(y); }, H, W, eight_connectivity, ws, labels);
+}
@@ -0,0 +1,99 @@
+#ifndef MORPHOLOGY_HPP
+#define MORPHOLOGY_HPP
+
+#include "dsu_2pass.hpp"
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+// Binary morphology on bit-packed rows (64 pixels per word), as a native
+// replacement for scipy.ndimage.binary_opening in python/make_mask.py.
+//
+// Semantics follow scipy's defaults: 3x3 structuring element, pixels
+// outside the image are 0 for both erosion and dilation (border_value=0),
+// and `iterations` repeats the elementary operation (opening = erosion n
+// times, then dilation n times).
+
+enum class StructElem {
+    Cross,   // 4-neighbourhood; scipy's default generate_binary_structure(2, 1)
+    Square   // full 3x3
+};
+
+// Row-major bit mask; bit (x % 64) of word x / 64 is pixel x. Bits past W
+// in the last word of a row are always 0.
+struct BitMask {
+    int H = 0;
+    int W = 0;
+    int words = 0;               // words per row
+    std::vector<uint64_t> bits;
+
+    BitMask() = default;
+    BitMask(int h, int w) : H(h), W(w), words((w + 63) / 64), bits((size_t)h * words, 0) {}
+
+    uint64_t* row(int y) { return bits.data() + (size_t)y * words; }
+    const uint64_t* row(int y) const { return bits.data() + (size_t)y * words; }
+    bool get(int y, int x) const { return (row(y)[x >> 6] >> (x & 63)) & 1; }
+};
+
+BitMask pack_mask(const uint8_t* img, int H, int W);
+// Threshold straight to bits: gray <= threshold (> with `invert`)
+BitMask pack_threshold(const uint8_t* gray, int H, int W, uint8_t threshold, bool invert);
+// One row of it into `out` ((W + 63) / 64 words, overwritten)
+void pack_threshold_row(const uint8_t* gray, int W, uint8_t threshold, bool invert, uint64_t* out);
+std::vector<uint8_t> unpack_mask(const BitMask& mask);
+
+struct MorphStep {
+    bool dilate;     // false: erode
+    StructElem se;
+};
+
+// Opening / closing as elementary steps
+std::vector<MorphStep> opening_steps(StructElem se, int iterations);
+std::vector<MorphStep> closing_steps(StructElem se, int iterations);
+
+// Applies `steps` to an input one output row at a time. Each step keeps a
+// three-row ring, so a chain of k steps touches k*3 rows of scratch no
+// matter how tall the image is; rows must be requested in order 0..H-1.
+// The input is a BitMask or a packer that writes input row y on demand
+// (into one more three-row ring), so it need not be stored either.
+class MorphologyStream {
+public:
+    using RowPacker = std::function<void(int y, uint64_t* out)>;
+
+    MorphologyStream(const BitMask& input, std::vector<MorphStep> steps);
+    MorphologyStream(int H, int W, RowPacker source, std::vector<MorphStep> steps);
+
+    const uint64_t* row(int y);
+
+private:
+    const uint64_t* stage_row(size_t stage, int y);  // nullptr outside the image
+
+    const BitMask* input;                      // nullptr: rows come from `source`
+    RowPacker source;
+    int H, W, words;
+    std::vector<MorphStep> steps;
+    std::vector<std::vector<uint64_t>> rings;  // per stage: 3 rows (stage 0 only with `source`)
+    std::vector<int> computed;                 // per stage: rows produced so far
+    std::vector<uint64_t> zero;                // rows outside the image
+    std::vector<uint64_t> scratch;             // square element: vertical pass
+};
+
+BitMask morphology(const BitMask& input, const std::vector<MorphStep>& steps);
+BitMask erode(const BitMask& input, StructElem se, int iterations = 1);
+BitMask dilate(const BitMask& input, StructElem se, int iterations = 1);
+BitMask opening(const BitMask& input, StructElem se, int iterations = 1);
+BitMask closing(const BitMask& input, StructElem se, int iterations = 1);
+
+// Cleanup and labeling in one pass: each row leaves the morphology chain
+// just before the two-pass scan reaches it, so the cleaned mask is never
+// stored. Same labels as label_cc_2pass on unpack_mask(morphology(...)).
+int label_cc_2pass_morphology(const BitMask& input, const std::vector<MorphStep>& steps,
+                              bool eight_connectivity, CCLWorkspace& ws, int32_t* labels);
+
+// Same, thresholding gray rows (as pack_threshold) as the chain asks for
+// them: no mask of any kind is stored, only the rings
+int label_cc_2pass_morphology(const uint8_t* gray, int H, int W, uint8_t threshold, bool invert,
+                              const std::vector<MorphStep>& steps, bool eight_connectivity,
+                              CCLWorkspace& ws, int32_t* labels);
+
+#endif // MORPHOLOGY_HPP
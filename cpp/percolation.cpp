@@ -0,0 +1,54 @@
+#include "percolation.hpp"
+#include "stream_dsu.hpp"
+#include "workload.hpp"
+#include <vector>
+#include <algorithm>
+
+PercolationResult percolation_sweep(
+    const std::vector<std::pair<int, int>>& order,
+    int H, int W, bool eight_connectivity
+) {
+    PercolationResult result;
+    result.H = H;
+    result.W = W;
+    result.first_spanning_step = -1;
+    result.steps.reserve(order.size());
+
+    StreamDSU stream(H, W, eight_connectivity);
+    int largest = 0;
+    bool spans_v = false;
+    bool spans_h = false;
+
+    for (const auto& p : order) {
+        stream.add_pixel(p.first, p.second);
+
+        // Only the component that received the pixel can have changed, and
+        // clusters never shrink, so the observables update in O(1)
+        ComponentStats cs = stream.get_component_stats(
+            stream.get_component_id(p.first, p.second));
+        largest = std::max(largest, cs.size);
+        spans_v = spans_v || (cs.min_y == 0 && cs.max_y == H - 1);
+        spans_h = spans_h || (cs.min_x == 0 && cs.max_x == W - 1);
+
+        PercolationStep step;
+        step.occupied = (int)result.steps.size() + 1;
+        step.largest_cluster = largest;
+        step.components = stream.get_component_count();
+        step.spans_vertical = spans_v;
+        step.spans_horizontal = spans_h;
+        if (result.first_spanning_step < 0 && (spans_v || spans_h)) {
+            result.first_spanning_step = (int)result.steps.size();
+        }
+        result.steps.push_back(step);
+    }
+
+    return result;
+}
+
+PercolationResult percolation_sweep(
+    int H, int W, uint64_t seed,
+    bool eight_connectivity
+) {
+    std::vector<std::pair<int, int>> order = sample_pixels(H, W, H * W, seed);
+    return percolation_sweep(order, H, W, eight_connectivity);
+}
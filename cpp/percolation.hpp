@@ -0,0 +1,37 @@
+#ifndef PERCOLATION_HPP
+#define PERCOLATION_HPP
+
+#include <vector>
+#include <cstdint>
+#include <utility>
+
+// Observables recorded after each pixel of a Newman-Ziff sweep
+struct PercolationStep {
+    int occupied;          // pixels added so far
+    int largest_cluster;   // size of the largest component
+    int components;        // number of components
+    bool spans_vertical;   // some component touches the top and bottom rows
+    bool spans_horizontal; // some component touches the left and right columns
+};
+
+struct PercolationResult {
+    int H, W;
+    std::vector<PercolationStep> steps;  // steps[k] is the state with k+1 pixels
+    int first_spanning_step;             // index of first spanning step, -1 if none
+};
+
+// Occupy pixels in the given order through StreamDSU and record every step.
+// One sweep covers every density 0..1 in O(n alpha) instead of relabeling
+// the grid from scratch per density.
+PercolationResult percolation_sweep(
+    const std::vector<std::pair<int, int>>& order,
+    int H, int W, bool eight_connectivity = false
+);
+
+// Same as above with a uniformly random occupation order of all H*W pixels
+PercolationResult percolation_sweep(
+    int H, int W, uint64_t seed,
+    bool eight_connectivity = false
+);
+
+#endif // PERCOLATION_HPP
@@ -0,0 +1,115 @@
+#include "dsu_2pass.hpp"
+#include "percolation.hpp"
+#include "workload.hpp"
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+#include <set>
+#include <algorithm>
+
+// Label the first `occupied` pixels of the sweep from scratch (the
+// per-density approach of metrics_comparison's test_different_densities)
+int count_components_from_scratch(
+    const std::vector<std::pair<int, int>>& order, int occupied,
+    int H, int W, bool eight_conn) {
+    std::vector<std::pair<int, int>> prefix(order.begin(), order.begin() + occupied);
+    std::vector<uint8_t> img = pixels_to_image(prefix, H, W);
+    auto labels = label_cc_2pass(img.data(), H, W, eight_conn);
+    std::set<int32_t> comps;
+    for (int i = 0; i < H * W; ++i) {
+        if (labels[i] > 0) comps.insert(labels[i]);
+    }
+    return comps.size();
+}
+
+int main(int argc, char* argv[]) {
+    int H = 500;
+    int W = 500;
+    int num_densities = 100;
+    uint64_t seed = 42;
+    bool eight_conn = false;
+
+    if (argc > 1) H = std::stoi(argv[1]);
+    if (argc > 2) W = std::stoi(argv[2]);
+    if (argc > 3) num_densities = std::stoi(argv[3]);
+    if (argc > 4) seed = std::stoull(argv[4]);
+    if (argc > 5) eight_conn = (std::stoi(argv[5]) != 0);
+
+    std::cout << "============================================================\n";
+    std::cout << "Newman-Ziff Percolation Sweep\n";
+    std::cout << "============================================================\n";
+    std::cout << "Image size: " << H << "x" << W << "\n";
+    std::cout << "Densities compared: " << num_densities << "\n";
+    std::cout << "Connectivity: " << (eight_conn ? "8" : "4") << "\n";
+    std::cout << "Seed: " << seed << "\n\n";
+
+    // Random occupation order of every pixel
+    std::vector<std::pair<int, int>> order = sample_pixels(H, W, H * W, seed);
+
+    // One sweep: every density at once
+    auto start = std::chrono::high_resolution_clock::now();
+    PercolationResult sweep = percolation_sweep(order, H, W, eight_conn);
+    auto end = std::chrono::high_resolution_clock::now();
+    double sweep_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    // From scratch: relabel the grid at every density
+    int N = H * W;
+    bool all_match = true;
+    start = std::chrono::high_resolution_clock::now();
+    std::vector<int> scratch_counts;
+    for (int d = 1; d <= num_densities; ++d) {
+        int occupied = (int)((double)N * d / num_densities);
+        scratch_counts.push_back(count_components_from_scratch(order, occupied, H, W, eight_conn));
+    }
+    end = std::chrono::high_resolution_clock::now();
+    double scratch_time = std::chrono::duration_cast<std::chrono::microseconds>(end - start).count();
+
+    std::cout << std::left << std::setw(10) << "Density";
+    std::cout << std::right << std::setw(12) << "Occupied";
+    std::cout << std::setw(14) << "Components";
+    std::cout << std::setw(16) << "Largest";
+    std::cout << std::setw(10) << "Spans";
+    std::cout << "\n";
+    std::cout << std::string(62, '-') << "\n";
+
+    int print_every = std::max(1, num_densities / 10);
+    for (int d = 1; d <= num_densities; ++d) {
+        int occupied = (int)((double)N * d / num_densities);
+        if (occupied == 0) continue;
+        const PercolationStep& s = sweep.steps[occupied - 1];
+        if (s.components != scratch_counts[d - 1]) {
+            all_match = false;
+        }
+        if (d % print_every != 0) continue;
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << std::left << std::setw(10) << ((double)occupied / N);
+        std::cout << std::right << std::setw(12) << occupied;
+        std::cout << std::setw(14) << s.components;
+        std::cout << std::setw(16) << s.largest_cluster;
+        std::cout << std::setw(10) << ((s.spans_vertical || s.spans_horizontal) ? "yes" : "no");
+        std::cout << "\n";
+    }
+    std::cout << std::string(62, '-') << "\n";
+
+    if (sweep.first_spanning_step >= 0) {
+        std::cout << "First spanning cluster at density "
+                  << std::setprecision(4) << (double)(sweep.first_spanning_step + 1) / N << "\n\n";
+    } else {
+        std::cout << "No spanning cluster\n\n";
+    }
+
+    if (all_match) {
+        std::cout << "✓ Component counts match 2-Pass at all " << num_densities << " densities\n\n";
+    } else {
+        std::cerr << "WARNING: Component count mismatch against 2-Pass!\n\n";
+    }
+
+    std::cout << std::setprecision(2);
+    std::cout << "Sweep (all " << N << " densities): " << sweep_time << " μs\n";
+    std::cout << "2-Pass per density (" << num_densities << " densities): " << scratch_time << " μs\n";
+    std::cout << "Speedup: " << (scratch_time / sweep_time) << "x\n";
+
+    return all_match ? 0 : 1;
+}
@@ -0,0 +1,168 @@
+#include "perf_counters.hpp"
+#include <cstring>
+#include <cerrno>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* perf_event_name(PerfEvent event) {
+    switch (event) {
+        case PerfEvent::Cycles:       return "cycles";
+        case PerfEvent::Instructions: return "instructions";
+        case PerfEvent::LLCMisses:    return "llc_misses";
+        case PerfEvent::BranchMisses: return "branch_misses";
+        case PerfEvent::DTLBMisses:   return "dtlb_misses";
+        default:                      return "?";
+    }
+}
+
+PerfSample& PerfSample::operator+=(const PerfSample& other) {
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) value[i] += other.value[i];
+    return *this;
+}
+
+PerfSample PerfSample::operator-(const PerfSample& other) const {
+    PerfSample d;
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) d.value[i] = value[i] - other.value[i];
+    return d;
+}
+
+PerfSample PerfSample::scaled(double factor) const {
+    PerfSample s;
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) s.value[i] = value[i] * factor;
+    return s;
+}
+
+#ifdef __linux__
+static void event_config(PerfEvent event, perf_event_attr& attr) {
+    auto cache = [](uint64_t id, uint64_t op, uint64_t result) {
+        return id | (op << 8) | (result << 16);
+    };
+    switch (event) {
+        case PerfEvent::Cycles:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CPU_CYCLES;
+            break;
+        case PerfEvent::Instructions:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+            break;
+        case PerfEvent::LLCMisses:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ,
+                                PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+        case PerfEvent::BranchMisses:
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+            break;
+        default:
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = cache(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ,
+                                PERF_COUNT_HW_CACHE_RESULT_MISS);
+            break;
+    }
+}
+#endif
+
+PerfCounters::PerfCounters() {
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) fds[i] = -1;
+#ifdef __linux__
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        event_config((PerfEvent)i, attr);
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        // Counting this thread on any CPU
+        int fd = (int)syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+        if (fd < 0) {
+            if (err.empty()) {
+                err = std::string(perf_event_name((PerfEvent)i)) + ": " + std::strerror(errno);
+            }
+            continue;
+        }
+        fds[i] = fd;
+    }
+#else
+    err = "perf_event_open is only available on Linux";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#ifdef __linux__
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+        if (fds[i] >= 0) close(fds[i]);
+    }
+#endif
+}
+
+bool PerfCounters::available() const {
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+        if (fds[i] >= 0) return true;
+    }
+    return false;
+}
+
+bool PerfCounters::has(PerfEvent event) const {
+    return fds[(int)event] >= 0;
+}
+
+PerfSample PerfCounters::read() const {
+    PerfSample s;
+#ifdef __linux__
+    for (int i = 0; i < PERF_EVENT_COUNT; ++i) {
+        if (fds[i] < 0) continue;
+        uint64_t buf[3];  // value, time_enabled, time_running
+        if (::read(fds[i], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) continue;
+        // Extrapolate when the PMU was shared with other events
+        double scale = (buf[2] > 0 && buf[2] < buf[1]) ? (double)buf[1] / buf[2] : 1.0;
+        s.value[i] = buf[0] * scale;
+    }
+#endif
+    return s;
+}
+
+PerfPhaseRecorder::PerfPhaseRecorder(PerfCounters& c) : counters(c) {
+    reset();
+}
+
+void PerfPhaseRecorder::reset() {
+    for (int p = 0; p < (int)CCLPhase::Count; ++p) {
+        phase_start[p] = PerfSample();
+        phase_total[p] = PerfSample();
+    }
+    call_total = PerfSample();
+    calls = 0;
+}
+
+void PerfPhaseRecorder::begin_phase(CCLPhase phase) {
+    phase_start[(int)phase] = counters.read();
+}
+
+void PerfPhaseRecorder::end_phase(CCLPhase phase) {
+    phase_total[(int)phase] += counters.read() - phase_start[(int)phase];
+}
+
+void PerfPhaseRecorder::run(const std::function<void()>& fn, int n) {
+    ScopedPhaseObserver install(this);
+    for (int i = 0; i < n; ++i) {
+        PerfSample start = counters.read();
+        fn();
+        call_total += counters.read() - start;
+        calls++;
+    }
+}
+
+PerfSample PerfPhaseRecorder::total() const {
+    return calls ? call_total.scaled(1.0 / calls) : PerfSample();
+}
+
+PerfSample PerfPhaseRecorder::phase(CCLPhase phase) const {
+    return calls ? phase_total[(int)phase].scaled(1.0 / calls) : PerfSample();
+}
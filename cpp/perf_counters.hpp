@@ -0,0 +1,79 @@
+#ifndef PERF_COUNTERS_HPP
+#define PERF_COUNTERS_HPP
+
+#include "ccl_phase.hpp"
+#include <cstdint>
+#include <string>
+#include <functional>
+
+// Hardware performance counters (Linux perf_event_open) for the labeling
+// engines. Counters that the kernel, CPU or container refuses are simply
+// marked unavailable; callers print "n/a" instead of failing.
+
+enum class PerfEvent {
+    Cycles,
+    Instructions,
+    LLCMisses,     // last-level cache read misses
+    BranchMisses,
+    DTLBMisses,    // data TLB read misses
+    Count
+};
+
+constexpr int PERF_EVENT_COUNT = (int)PerfEvent::Count;
+
+const char* perf_event_name(PerfEvent event);
+
+struct PerfSample {
+    double value[PERF_EVENT_COUNT] = {};  // scaled for multiplexing
+
+    double operator[](PerfEvent e) const { return value[(int)e]; }
+    PerfSample& operator+=(const PerfSample& other);
+    PerfSample operator-(const PerfSample& other) const;
+    PerfSample scaled(double factor) const;
+};
+
+class PerfCounters {
+private:
+    int fds[PERF_EVENT_COUNT];
+    std::string err;
+
+public:
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const;              // at least one counter is running
+    bool has(PerfEvent event) const;
+    const std::string& error() const { return err; }  // reason for the first refused counter
+
+    // Cumulative counts for this thread since construction
+    PerfSample read() const;
+};
+
+// Accumulates counters per engine phase (and for whole calls) while
+// installed as the thread's PhaseObserver.
+class PerfPhaseRecorder : public PhaseObserver {
+private:
+    PerfCounters& counters;
+    PerfSample phase_start[(int)CCLPhase::Count];
+    PerfSample phase_total[(int)CCLPhase::Count];
+    PerfSample call_total;
+    int calls;
+
+public:
+    explicit PerfPhaseRecorder(PerfCounters& c);
+
+    void begin_phase(CCLPhase phase) override;
+    void end_phase(CCLPhase phase) override;
+
+    // Run fn `n` times with this recorder installed
+    void run(const std::function<void()>& fn, int n);
+    void reset();
+
+    // Per-call averages
+    PerfSample total() const;
+    PerfSample phase(CCLPhase phase) const;
+};
+
+#endif // PERF_COUNTERS_HPP
@@ -0,0 +1,218 @@
+#include "pnm.hpp"
+#include <vector>
+#include <cctype>
+#include <fstream>
+#include <iterator>
+
+namespace {
+
+// Cursor over the header/ASCII part of a Netpbm file
+struct PnmCursor {
+    const uint8_t* p;
+    const uint8_t* end;
+
+    void skip_space_and_comments() {
+        while (p < end) {
+            if (*p == '#') {
+                while (p < end && *p != '\n') ++p;
+            } else if (std::isspace(*p)) {
+                ++p;
+            } else {
+                break;
+            }
+        }
+    }
+
+    bool read_uint(int& v) {
+        skip_space_and_comments();
+        if (p >= end || !std::isdigit(*p)) return false;
+        int64_t acc = 0;
+        while (p < end && std::isdigit(*p)) {
+            acc = acc * 10 + (*p++ - '0');
+            if (acc > (1 << 30)) return false;
+        }
+        v = (int)acc;
+        return true;
+    }
+};
+
+// 8-bit luma, ITU-R 601-2 in 16-bit fixed point (what PIL's convert("L") computes)
+inline uint8_t rgb_to_gray(int r, int g, int b) {
+    return (uint8_t)((r * 19595 + g * 38470 + b * 7471 + 0x8000) >> 16);
+}
+
+}  // namespace
+
+bool parse_pnm_header(const uint8_t* data, size_t size, PnmHeader& header, std::string& error) {
+    header = PnmHeader();
+    if (size < 2 || data[0] != 'P' || data[1] < '1' || data[1] > '6') {
+        error = "not a PBM/PGM/PPM file";
+        return false;
+    }
+    header.kind = (char)data[1];
+    bool bitmap = (header.kind == '1' || header.kind == '4');
+    bool binary = (header.kind == '4' || header.kind == '5' || header.kind == '6');
+
+    PnmCursor c{data + 2, data + size};
+    if (!c.read_uint(header.W) || !c.read_uint(header.H)) {
+        error = "bad header";
+        return false;
+    }
+    header.maxval = 1;
+    if (!bitmap && (!c.read_uint(header.maxval) || header.maxval < 1 || header.maxval > 65535)) {
+        error = "bad maxval";
+        return false;
+    }
+    if (header.W <= 0 || header.H <= 0) {
+        error = "bad dimensions";
+        return false;
+    }
+    if (binary) {
+        // Exactly one whitespace byte separates the header from binary data
+        if (c.p >= c.end || !std::isspace(*c.p)) {
+            error = "bad header";
+            return false;
+        }
+        ++c.p;
+    }
+    header.data_offset = (size_t)(c.p - data);
+    return true;
+}
+
+bool parse_pnm(const uint8_t* data, size_t size, PnmImage& out, std::string& error) {
+    out = PnmImage();
+    PnmHeader header;
+    if (!parse_pnm_header(data, size, header, error)) {
+        return false;
+    }
+    char kind = header.kind;
+    bool bitmap = (kind == '1' || kind == '4');
+    bool binary = (kind == '4' || kind == '5' || kind == '6');
+    int channels = (kind == '3' || kind == '6') ? 3 : 1;
+    out.H = header.H;
+    out.W = header.W;
+    out.maxval = header.maxval;
+
+    PnmCursor c{data + header.data_offset, data + size};
+    size_t n = (size_t)out.H * out.W;
+    out.pixels.assign(n, 0);
+
+    if (!binary) {
+        for (size_t i = 0; i < n; ++i) {
+            int v;
+            if (bitmap) {
+                // P1 digits need not be separated
+                c.skip_space_and_comments();
+                if (c.p >= c.end || (*c.p != '0' && *c.p != '1')) {
+                    error = "truncated pixel data";
+                    return false;
+                }
+                v = *c.p++ - '0';
+            } else {
+                int rgb[3];
+                for (int ch = 0; ch < channels; ++ch) {
+                    if (!c.read_uint(rgb[ch])) {
+                        error = "truncated pixel data";
+                        return false;
+                    }
+                    if (out.maxval > 255) rgb[ch] >>= 8;
+                }
+                out.pixels[i] = channels == 3 ? rgb_to_gray(rgb[0], rgb[1], rgb[2]) : (uint8_t)rgb[0];
+                continue;
+            }
+            out.pixels[i] = (uint8_t)v;
+        }
+        if (out.maxval > 255) out.maxval >>= 8;
+        return true;
+    }
+
+    size_t avail = (size_t)(c.end - c.p);
+
+    if (bitmap) {
+        size_t row_bytes = ((size_t)out.W + 7) / 8;
+        if (avail < row_bytes * out.H) {
+            error = "truncated pixel data";
+            return false;
+        }
+        for (int y = 0; y < out.H; ++y) {
+            const uint8_t* row = c.p + y * row_bytes;
+            for (int x = 0; x < out.W; ++x) {
+                out.pixels[(size_t)y * out.W + x] = (row[x >> 3] >> (7 - (x & 7))) & 1;
+            }
+        }
+        return true;
+    }
+
+    size_t sample_bytes = out.maxval > 255 ? 2 : 1;
+    if (avail < n * channels * sample_bytes) {
+        error = "truncated pixel data";
+        return false;
+    }
+    if (channels == 3) {
+        size_t stride = 3 * sample_bytes;
+        for (size_t i = 0; i < n; ++i) {
+            const uint8_t* px = c.p + i * stride;
+            out.pixels[i] = rgb_to_gray(px[0], px[sample_bytes], px[2 * sample_bytes]);
+        }
+    } else {
+        for (size_t i = 0; i < n; ++i) {
+            out.pixels[i] = c.p[i * sample_bytes];  // high byte first for 16-bit
+        }
+    }
+    if (out.maxval > 255) out.maxval >>= 8;
+    return true;
+}
+
+bool read_pnm(const std::string& path, PnmImage& out, std::string& error) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (!parse_pnm(data.data(), data.size(), out, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+bool read_raw_gray(const std::string& path, int H, int W, PnmImage& out, std::string& error) {
+    out = PnmImage();
+    if (H <= 0 || W <= 0) {
+        error = "bad dimensions";
+        return false;
+    }
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    out.H = H;
+    out.W = W;
+    out.maxval = 255;
+    out.pixels.resize((size_t)H * W);
+    in.read(reinterpret_cast<char*>(out.pixels.data()), (std::streamsize)out.pixels.size());
+    if ((size_t)in.gcount() != out.pixels.size()) {
+        error = path + ": expected " + std::to_string(out.pixels.size()) + " bytes for " +
+                std::to_string(H) + "x" + std::to_string(W);
+        return false;
+    }
+    return true;
+}
+
+bool write_pgm(const std::string& path, const uint8_t* pixels, int H, int W) {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) return false;
+    out << "P5\n" << W << " " << H << "\n255\n";
+    out.write(reinterpret_cast<const char*>(pixels), (std::streamsize)H * W);
+    return (bool)out;
+}
+
+std::vector<uint8_t> pnm_to_mask(const PnmImage& image) {
+    std::vector<uint8_t> mask(image.pixels.size());
+    for (size_t i = 0; i < mask.size(); ++i) {
+        mask[i] = image.pixels[i] != 0 ? 1 : 0;
+    }
+    return mask;
+}
@@ -0,0 +1,43 @@
+#ifndef PNM_HPP
+#define PNM_HPP
+
+#include <vector>
+#include <cstdint>
+#include <string>
+
+// Minimal Netpbm I/O for mask corpora and the mask pipeline: PBM (P1/P4),
+// PGM (P2/P5) and PPM (P3/P6). 16-bit samples are reduced to their high
+// byte; PPM is converted to 8-bit luma on decode, as PIL's convert("L").
+
+struct PnmImage {
+    int H = 0;
+    int W = 0;
+    int maxval = 0;               // 1 for PBM
+    std::vector<uint8_t> pixels;  // row-major, one byte per pixel
+};
+
+struct PnmHeader {
+    char kind = 0;           // '1'..'6' of the magic number
+    int H = 0;
+    int W = 0;
+    int maxval = 0;          // 1 for PBM
+    size_t data_offset = 0;  // first byte of the raster
+};
+
+// Header only, so binary rasters can be used in place (e.g. memory-mapped)
+bool parse_pnm_header(const uint8_t* data, size_t size, PnmHeader& header, std::string& error);
+
+// Returns false and sets `error` on unsupported or truncated files
+bool read_pnm(const std::string& path, PnmImage& out, std::string& error);
+bool parse_pnm(const uint8_t* data, size_t size, PnmImage& out, std::string& error);
+
+// Headerless 8-bit grayscale, H*W bytes row-major
+bool read_raw_gray(const std::string& path, int H, int W, PnmImage& out, std::string& error);
+
+// Binary PGM (P5), maxval 255
+bool write_pgm(const std::string& path, const uint8_t* pixels, int H, int W);
+
+// 0/1 mask: nonzero samples are foreground
+std::vector<uint8_t> pnm_to_mask(const PnmImage& image);
+
+#endif // PNM_HPP
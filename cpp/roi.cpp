@@ -0,0 +1,104 @@
+#include "roi.hpp"
+#include <algorithm>
+#include <cstring>
+
+static inline uint64_t load_word(const uint8_t* p) {
+    uint64_t w;
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+static bool row_any(const uint8_t* row, int W) {
+    uint64_t acc = 0;
+    int x = 0;
+    for (; x + 8 <= W; x += 8) acc |= load_word(row + x);
+    for (; x < W; ++x) acc |= row[x];
+    return acc != 0;
+}
+
+// First nonzero in [begin, end), or `end`
+static int first_set(const uint8_t* row, int begin, int end) {
+    int x = begin;
+    while (x + 8 <= end && load_word(row + x) == 0) x += 8;
+    while (x < end && row[x] == 0) ++x;
+    return x;
+}
+
+// Last nonzero in [begin, end), or begin - 1
+static int last_set(const uint8_t* row, int begin, int end) {
+    int x = end;
+    while (x - 8 >= begin && load_word(row + x - 8) == 0) x -= 8;
+    while (x > begin && row[x - 1] == 0) --x;
+    return x - 1;
+}
+
+BBox foreground_bbox(const uint8_t* img, int H, int W) {
+    return foreground_bbox(ImageView(img, H, W));
+}
+
+BBox foreground_bbox(const ImageView& img) {
+    const int H = img.H, W = img.W;
+    BBox box;
+    int top = 0;
+    while (top < H && !row_any(img.row(top), W)) ++top;
+    if (top == H) return box;
+    int bottom = H;
+    while (!row_any(img.row(bottom - 1), W)) --bottom;
+
+    int left = W, right = 0;
+    for (int y = top; y < bottom; ++y) {
+        const uint8_t* row = img.row(y);
+        left = std::min(left, first_set(row, 0, left));
+        right = std::max(right, last_set(row, right, W) + 1);
+    }
+
+    box.y0 = top;
+    box.y1 = bottom;
+    box.x0 = left;
+    box.x1 = right;
+    return box;
+}
+
+int label_cc_2pass_roi(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels, BBox* bbox
+) {
+    return label_cc_2pass_roi(ImageView(img, H, W), LabelView(labels, H, W), eight_connectivity, ws, bbox);
+}
+
+int label_cc_2pass_roi(
+    const ImageView& img, const LabelView& labels,
+    bool eight_connectivity, CCLWorkspace& ws, BBox* bbox
+) {
+    const int H = img.H, W = img.W;
+    BBox box = foreground_bbox(img);
+    if (bbox) *bbox = box;
+
+    // Zero only what the bbox labeling does not write
+    for (int y = 0; y < H; ++y) {
+        int32_t* row = labels.row(y);
+        if (box.empty() || y < box.y0 || y >= box.y1) {
+            std::fill(row, row + W, 0);
+        } else {
+            std::fill(row, row + box.x0, 0);
+            std::fill(row + box.x1, row + W, 0);
+        }
+    }
+    if (box.empty()) return 0;
+
+    // Foreground pixels keep their raster order inside the box, so the
+    // provisional labels, unions and final numbering match the full scan
+    return label_cc_2pass(img.sub(box.y0, box.x0, box.height(), box.width()),
+                          labels.sub(box.y0, box.x0, box.height(), box.width()),
+                          eight_connectivity, ws);
+}
+
+std::vector<int32_t> label_cc_roi(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity
+) {
+    std::vector<int32_t> labels((size_t)H * W);
+    CCLWorkspace ws;
+    label_cc_2pass_roi(img, H, W, eight_connectivity, ws, labels.data());
+    return labels;
+}
@@ -0,0 +1,45 @@
+#ifndef ROI_HPP
+#define ROI_HPP
+
+#include "dsu_2pass.hpp"
+#include <vector>
+#include <cstdint>
+
+// Foreground bounding-box labeling: the C++ counterpart of
+// python/crop_paste_back.py without the crop and paste copies. Only the
+// bbox is scanned; labels are written straight into the full-size output
+// through its row stride, and everything outside the bbox is zeroed.
+
+// Half-open box [y0, y1) x [x0, x1); empty when there is no foreground
+struct BBox {
+    int y0 = 0, x0 = 0, y1 = 0, x1 = 0;
+
+    bool empty() const { return y1 <= y0 || x1 <= x0; }
+    int height() const { return y1 - y0; }
+    int width() const { return x1 - x0; }
+};
+
+// Tightest box around the nonzero pixels. Rows are tested eight bytes at a
+// time; the column bounds only re-scan the part of each row outside the
+// box found so far.
+BBox foreground_bbox(const uint8_t* img, int H, int W);
+BBox foreground_bbox(const ImageView& img);
+
+// Same labels as label_cc_2pass on the full image; `bbox` receives the box
+int label_cc_2pass_roi(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity, CCLWorkspace& ws, int32_t* labels, BBox* bbox = nullptr
+);
+
+// Strided form, box relative to the view
+int label_cc_2pass_roi(
+    const ImageView& img, const LabelView& labels,
+    bool eight_connectivity, CCLWorkspace& ws, BBox* bbox = nullptr
+);
+
+std::vector<int32_t> label_cc_roi(
+    const uint8_t* img, int H, int W,
+    bool eight_connectivity = false
+);
+
+#endif // ROI_HPP
@@ -0,0 +1,330 @@
+#include "run_labels.hpp"
+#include <algorithm>
+#include <cstring>
+
+static inline uint64_t load_word(const uint8_t* p) {
+    uint64_t w;
+    std::memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+// True if any of the eight bytes of w is zero
+static inline bool has_zero_byte(uint64_t w) {
+    return ((w - 0x0101010101010101ULL) & ~w & 0x8080808080808080ULL) != 0;
+}
+
+int32_t RunLabels::at(int y, int x) const {
+    auto begin = runs.begin() + row_begin[y];
+    auto end = runs.begin() + row_begin[y + 1];
+    // First run starting after x; the one before it is the only candidate
+    auto it = std::upper_bound(begin, end, x, [](int v, const LabelRun& r) { return v < r.x; });
+    if (it == begin) return 0;
+    --it;
+    return x < it->x + it->length ? it->label : 0;
+}
+
+size_t RunLabels::memory_usage() const {
+    return row_begin.capacity() * sizeof(int64_t) + runs.capacity() * sizeof(LabelRun);
+}
+
+// ------------------------------------------------------------------ engine
+
+// Run forest with the smaller index as root, so each component's root is
+// its first run in raster order
+static inline int32_t find_run(std::vector<int32_t>& parent, int32_t x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+static inline void union_runs(std::vector<int32_t>& parent, int32_t a, int32_t b) {
+    a = find_run(parent, a);
+    b = find_run(parent, b);
+    if (a < b) {
+        parent[b] = a;
+    } else if (b < a) {
+        parent[a] = b;
+    }
+}
+
+// Union every run of [begin, end) with the runs of the row above,
+// [prev_begin, begin), that it touches. Both rows are sorted, so one sweep
+// finds every overlap: a run above that ends before this run's reach
+// cannot touch later runs either.
+static void join_rows(const std::vector<LabelRun>& runs, int64_t prev_begin, int64_t begin, int64_t end,
+                      int reach, std::vector<int32_t>& parent) {
+    int64_t p = prev_begin;
+    for (int64_t c = begin; c < end && p < begin; ++c) {
+        const int64_t lo = (int64_t)runs[c].x - reach;
+        const int64_t hi = (int64_t)runs[c].x + runs[c].length + reach;  // exclusive
+        while (p < begin && (int64_t)runs[p].x + runs[p].length <= lo) ++p;
+        for (int64_t q = p; q < begin && runs[q].x < hi; ++q) {
+            union_runs(parent, (int32_t)c, (int32_t)q);
+        }
+    }
+}
+
+// Final labels in run order; roots precede their members, so a member's
+// root already holds its final label
+static int resolve_runs(std::vector<LabelRun>& runs, std::vector<int32_t>& parent) {
+    int components = 0;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        int32_t root = find_run(parent, (int32_t)i);
+        runs[i].label = root == (int32_t)i ? ++components : runs[root].label;
+    }
+    return components;
+}
+
+int label_cc_runs(const ImageView& img, bool eight_connectivity, CCLWorkspace& ws, RunLabels& out) {
+    const int H = img.H, W = img.W;
+    const int reach = eight_connectivity ? 1 : 0;
+    std::vector<int32_t>& parent = ws.remap;
+    parent.clear();
+    out.H = H;
+    out.W = W;
+    out.runs.clear();
+    out.row_begin.assign(H > 0 ? H + 1 : 0, 0);
+
+    // Pass 1: extract runs and join each to the overlapping runs above
+    int64_t prev_begin = 0;
+    for (int y = 0; y < H; ++y) {
+        const uint8_t* row = img.row(y);
+        const int64_t begin = (int64_t)out.runs.size();
+        out.row_begin[y] = begin;
+        int x = 0;
+        while (x < W) {
+            while (x + 8 <= W && load_word(row + x) == 0) x += 8;
+            while (x < W && row[x] == 0) ++x;
+            if (x == W) break;
+            int start = x;
+            while (x + 8 <= W && !has_zero_byte(load_word(row + x))) x += 8;
+            while (x < W && row[x] != 0) ++x;
+            int32_t id = (int32_t)out.runs.size();
+            out.runs.push_back({start, x - start, id});
+            parent.push_back(id);
+        }
+
+        join_rows(out.runs, prev_begin, begin, (int64_t)out.runs.size(), reach, parent);
+        prev_begin = begin;
+    }
+    if (H > 0) out.row_begin[H] = (int64_t)out.runs.size();
+
+    // Pass 2 over runs only
+    out.components = resolve_runs(out.runs, parent);
+    return out.components;
+}
+
+RunLabels label_cc_runs(const ImageView& img, bool eight_connectivity) {
+    CCLWorkspace ws;
+    RunLabels out;
+    label_cc_runs(img, eight_connectivity, ws, out);
+    return out;
+}
+
+RunLabels label_cc_runs(const uint8_t* img, int H, int W, bool eight_connectivity) {
+    return label_cc_runs(ImageView(img, H, W), eight_connectivity);
+}
+
+// ------------------------------------------------------------------ sparse input
+
+int label_cc_coords(const std::vector<std::pair<int, int>>& pixels, bool eight_connectivity,
+                    std::vector<int32_t>& labels) {
+    // (row, column) keys with the sign bits flipped so that unsigned order
+    // is (y, x) order for any int coordinates
+    std::vector<std::pair<uint64_t, int32_t>> order(pixels.size());
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        uint64_t y = (uint32_t)pixels[i].first ^ 0x80000000u, x = (uint32_t)pixels[i].second ^ 0x80000000u;
+        order[i] = {y << 32 | x, (int32_t)i};
+    }
+    std::sort(order.begin(), order.end());
+
+    // One run per maximal horizontal segment; labels[i] holds the run of
+    // pixel i until the runs are resolved. Duplicates join the same run.
+    const int reach = eight_connectivity ? 1 : 0;
+    std::vector<LabelRun> runs;
+    std::vector<int32_t> parent;
+    labels.resize(pixels.size());
+    int64_t above = -1;  // first run of the row above the current one, -1 if that row is empty
+    int64_t begin = 0;   // first run of the current row
+    uint64_t row_y = 0;
+    auto close_row = [&] {
+        if (above >= 0) join_rows(runs, above, begin, (int64_t)runs.size(), reach, parent);
+    };
+    for (size_t k = 0; k < order.size(); ++k) {
+        uint64_t y = order[k].first >> 32;
+        int x = pixels[order[k].second].second;
+        if (k == 0 || y != row_y) {
+            if (k > 0) {
+                close_row();
+                above = y == row_y + 1 ? begin : -1;
+            }
+            begin = (int64_t)runs.size();
+            row_y = y;
+        }
+        const LabelRun* last = (int64_t)runs.size() > begin ? &runs.back() : nullptr;
+        if (last && (int64_t)x == (int64_t)last->x + last->length) {
+            runs.back().length++;
+        } else if (!last || (int64_t)x > (int64_t)last->x + last->length) {
+            int32_t id = (int32_t)runs.size();
+            runs.push_back({x, 1, id});
+            parent.push_back(id);
+        }
+        labels[order[k].second] = (int32_t)runs.size() - 1;
+    }
+    if (!order.empty()) close_row();
+
+    int components = resolve_runs(runs, parent);
+    for (int32_t& label : labels) label = runs[label].label;
+    return components;
+}
+
+std::vector<int32_t> label_cc_coords(const std::vector<std::pair<int, int>>& pixels, bool eight_connectivity) {
+    std::vector<int32_t> labels;
+    label_cc_coords(pixels, eight_connectivity, labels);
+    return labels;
+}
+
+// ------------------------------------------------------------------ converters
+
+void runs_to_dense(const RunLabels& runs, int y, int32_t* row) {
+    int x = 0;
+    for (int64_t i = runs.row_begin[y]; i < runs.row_begin[y + 1]; ++i) {
+        const LabelRun& r = runs.runs[i];
+        std::fill(row + x, row + r.x, 0);
+        std::fill(row + r.x, row + r.x + r.length, r.label);
+        x = r.x + r.length;
+    }
+    std::fill(row + x, row + runs.W, 0);
+}
+
+void runs_to_dense(const RunLabels& runs, const LabelView& out) {
+    for (int y = 0; y < runs.H; ++y) runs_to_dense(runs, y, out.row(y));
+}
+
+std::vector<int32_t> runs_to_dense(const RunLabels& runs) {
+    std::vector<int32_t> labels((size_t)runs.H * runs.W);
+    runs_to_dense(runs, LabelView(labels, runs.H, runs.W));
+    return labels;
+}
+
+void runs_from_dense(const LabelView& labels, RunLabels& out) {
+    out.H = labels.H;
+    out.W = labels.W;
+    out.components = 0;
+    out.runs.clear();
+    out.row_begin.assign(labels.H > 0 ? labels.H + 1 : 0, 0);
+    for (int y = 0; y < labels.H; ++y) {
+        const int32_t* row = labels.row(y);
+        out.row_begin[y] = (int64_t)out.runs.size();
+        int x = 0;
+        while (x < labels.W) {
+            int32_t label = row[x];
+            int start = x;
+            while (x < labels.W && row[x] == label) ++x;
+            if (label != 0) {
+                out.runs.push_back({start, x - start, label});
+                out.components = std::max(out.components, (int)label);
+            }
+        }
+    }
+    if (labels.H > 0) out.row_begin[labels.H] = (int64_t)out.runs.size();
+}
+
+RunLabels runs_from_dense(const LabelView& labels) {
+    RunLabels out;
+    runs_from_dense(labels, out);
+    return out;
+}
+
+// ------------------------------------------------------------------ bytes
+
+static const char RUNS_MAGIC[4] = {'C', 'C', 'L', 'R'};
+static const uint32_t RUNS_VERSION = 1;
+
+struct RunsHeader {
+    char magic[4];
+    uint32_t version;
+    int32_t H, W;
+    int32_t components;
+    int32_t padding;
+    int64_t run_count;
+};
+static_assert(sizeof(RunsHeader) == 32, "RunsHeader is part of the byte format");
+static_assert(sizeof(LabelRun) == 12, "LabelRun is part of the byte format");
+
+std::vector<uint8_t> encode_runs(const RunLabels& runs) {
+    RunsHeader h;
+    std::memcpy(h.magic, RUNS_MAGIC, 4);
+    h.version = RUNS_VERSION;
+    h.H = runs.H;
+    h.W = runs.W;
+    h.components = runs.components;
+    h.padding = 0;
+    h.run_count = (int64_t)runs.runs.size();
+
+    std::vector<uint8_t> bytes(sizeof(h) + (size_t)runs.H * sizeof(uint32_t) + runs.runs.size() * sizeof(LabelRun));
+    uint8_t* p = bytes.data();
+    std::memcpy(p, &h, sizeof(h));
+    p += sizeof(h);
+    for (int y = 0; y < runs.H; ++y) {
+        uint32_t n = (uint32_t)(runs.row_begin[y + 1] - runs.row_begin[y]);
+        std::memcpy(p, &n, sizeof(n));
+        p += sizeof(n);
+    }
+    if (!runs.runs.empty()) std::memcpy(p, runs.runs.data(), runs.runs.size() * sizeof(LabelRun));
+    return bytes;
+}
+
+bool decode_runs(const uint8_t* data, size_t size, RunLabels& runs, std::string& error) {
+    RunsHeader h;
+    if (size < sizeof(h)) {
+        error = "run labels: truncated header";
+        return false;
+    }
+    std::memcpy(&h, data, sizeof(h));
+    if (std::memcmp(h.magic, RUNS_MAGIC, 4) != 0 || h.version != RUNS_VERSION) {
+        error = "run labels: bad magic or version";
+        return false;
+    }
+    if (h.H < 0 || h.W < 0 || h.run_count < 0 ||
+        size != sizeof(h) + (size_t)h.H * sizeof(uint32_t) + (size_t)h.run_count * sizeof(LabelRun)) {
+        error = "run labels: size does not match header";
+        return false;
+    }
+    const uint8_t* p = data + sizeof(h);
+    runs.H = h.H;
+    runs.W = h.W;
+    runs.components = h.components;
+    runs.row_begin.assign(h.H > 0 ? h.H + 1 : 0, 0);
+    int64_t total = 0;
+    for (int y = 0; y < h.H; ++y) {
+        uint32_t n;
+        std::memcpy(&n, p, sizeof(n));
+        p += sizeof(n);
+        runs.row_begin[y] = total;
+        total += n;
+    }
+    if (total != h.run_count) {
+        error = "run labels: row counts do not add up";
+        return false;
+    }
+    if (h.H > 0) runs.row_begin[h.H] = total;
+    runs.runs.resize((size_t)total);
+    if (total > 0) std::memcpy(runs.runs.data(), p, (size_t)total * sizeof(LabelRun));
+    // Runs must stay inside their row and in order, or to_dense would write
+    // out of bounds
+    for (int y = 0; y < h.H; ++y) {
+        int x = 0;
+        for (int64_t i = runs.row_begin[y]; i < runs.row_begin[y + 1]; ++i) {
+            const LabelRun& r = runs.runs[i];
+            if (r.x < x || r.length < 1 || r.x > h.W - r.length) {
+                error = "run labels: run out of order or out of bounds in row " + std::to_string(y);
+                return false;
+            }
+            x = r.x + r.length;
+        }
+    }
+    return true;
+}
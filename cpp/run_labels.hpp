@@ -0,0 +1,79 @@
+#ifndef RUN_LABELS_HPP
+#define RUN_LABELS_HPP
+
+#include "dsu_2pass.hpp"
+#include "image_view.hpp"
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <utility>
+
+// Run-length label images: each row is a list of (start, length, label)
+// runs of foreground, so storage grows with the number of runs rather than
+// H * W. This is the format of the run engine below and of the stream
+// engines' snapshots (StreamDSU / IncrementalDSU::get_label_runs).
+
+struct LabelRun {
+    int32_t x;       // first column
+    int32_t length;  // >= 1
+    int32_t label;   // >= 1; background is never stored
+};
+
+struct RunLabels {
+    int H = 0, W = 0;
+    int components = 0;
+    // Row y is runs[row_begin[y], row_begin[y + 1]), ascending x and
+    // non-overlapping; H + 1 entries (empty when H == 0)
+    std::vector<int64_t> row_begin;
+    std::vector<LabelRun> runs;
+
+    // Label of (y, x), 0 for background; binary search within the row
+    int32_t at(int y, int x) const;
+
+    // Heap bytes held by the two arrays
+    size_t memory_usage() const;
+};
+
+// Two-pass labeling on runs: foreground runs are extracted row by row, a
+// run is joined to the runs of the previous row that it overlaps (one
+// column wider with 8-connectivity), and the run forest is flattened in
+// one pass at the end. Nothing of size H * W is allocated. Labels are
+// numbered in raster order of each component's first pixel, like
+// label_cc_bfs; the partition matches label_cc_2pass. Returns the
+// component count. `ws.remap` holds the run forest, `out` keeps its
+// capacity between calls.
+int label_cc_runs(const ImageView& img, bool eight_connectivity, CCLWorkspace& ws, RunLabels& out);
+
+RunLabels label_cc_runs(const ImageView& img, bool eight_connectivity = false);
+RunLabels label_cc_runs(const uint8_t* img, int H, int W, bool eight_connectivity = false);
+
+// Sparse input: foreground given as (y, x) coordinates, in any order and
+// with any int values (duplicates allowed). The coordinates are sorted by
+// row, gathered into runs and joined as above, so time is O(n log n) and
+// memory O(n) in the number of pixels; no canvas size is involved.
+// labels[i] is the label of pixels[i], numbered as label_cc_runs would on
+// the dense image; returns the component count.
+int label_cc_coords(const std::vector<std::pair<int, int>>& pixels, bool eight_connectivity,
+                    std::vector<int32_t>& labels);
+std::vector<int32_t> label_cc_coords(const std::vector<std::pair<int, int>>& pixels,
+                                     bool eight_connectivity = false);
+
+// Converters. to_dense writes every pixel of `out` (which must be H x W);
+// from_dense builds runs of equal nonzero labels and counts components as
+// the largest label.
+void runs_to_dense(const RunLabels& runs, const LabelView& out);
+void runs_to_dense(const RunLabels& runs, int y, int32_t* row);  // one row, W entries
+std::vector<int32_t> runs_to_dense(const RunLabels& runs);
+void runs_from_dense(const LabelView& labels, RunLabels& out);
+RunLabels runs_from_dense(const LabelView& labels);
+
+// Flat byte form for IPC and caches: a 32-byte header ("CCLR", version,
+// H, W, components, padding, int64 run count), H uint32 run counts per
+// row, then the runs as three int32 each, all in host byte order.
+std::vector<uint8_t> encode_runs(const RunLabels& runs);
+bool decode_runs(const uint8_t* data, size_t size, RunLabels& runs, std::string& error);
+
+// NPY output straight from runs: write_npy(path, RunLabels, error) in mask_io.hpp
+
+#endif // RUN_LABELS_HPP
@@ -0,0 +1,297 @@
+#include "stream_dsu.hpp"
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+StreamDSU::StreamDSU(int h, int w, bool eight_connectivity)
+    : next_label(1), H(h), W(w), eight_conn(eight_connectivity),
+      num_components(0), size_threshold(0) {
+    // DSU entries are appended as labels are created, so memory follows
+    // the number of components, not the canvas. Label 0 is background.
+    parent.push_back(0);
+    rank.push_back(0);
+    // Label 0 is background; keep the stats arrays indexable by label
+    new_component_stats(0, 0);
+    stat_count[0] = 0;
+}
+
+void StreamDSU::set_event_callback(ComponentEventCallback callback) {
+    on_events = std::move(callback);
+    pending_events.clear();
+}
+
+void StreamDSU::set_size_threshold(int threshold) {
+    size_threshold = threshold;
+}
+
+void StreamDSU::union_set(int32_t a, int32_t b) {
+    if (a == b) return;
+    int32_t ra = find(a);
+    int32_t rb = find(b);
+    if (ra == rb) return;
+
+    // Keep ra as the surviving root
+    if (rank[ra] < rank[rb]) {
+        std::swap(ra, rb);
+    } else if (rank[ra] == rank[rb]) {
+        rank[ra]++;
+    }
+    parent[rb] = ra;
+
+    int size_a = stat_count[ra];
+    int size_b = stat_count[rb];
+    merge_stats(ra, rb);
+    int merged = stat_count[ra];
+    num_components--;
+
+    if (on_events) {
+        pending_events.push_back({ComponentEventType::Merged, ra, rb, merged});
+        if (size_threshold > 0 && size_a < size_threshold &&
+            size_b < size_threshold && merged >= size_threshold) {
+            pending_events.push_back({ComponentEventType::SizeThreshold, ra, 0, merged});
+        }
+    }
+}
+
+void StreamDSU::new_component_stats(int y, int x) {
+    // Labels are handed out sequentially, so the arrays grow by one slot
+    stat_count.push_back(1);
+    stat_min_y.push_back(y);
+    stat_min_x.push_back(x);
+    stat_max_y.push_back(y);
+    stat_max_x.push_back(x);
+    stat_sum_y.push_back(y);
+    stat_sum_x.push_back(x);
+    stat_perimeter.push_back(4);
+}
+
+void StreamDSU::grow_stats(int32_t root, int y, int x, int touching) {
+    stat_count[root]++;
+    stat_min_y[root] = std::min(stat_min_y[root], y);
+    stat_min_x[root] = std::min(stat_min_x[root], x);
+    stat_max_y[root] = std::max(stat_max_y[root], y);
+    stat_max_x[root] = std::max(stat_max_x[root], x);
+    stat_sum_y[root] += y;
+    stat_sum_x[root] += x;
+    // Each 4-neighbour already present hides one edge on both pixels
+    stat_perimeter[root] += 4 - 2 * touching;
+}
+
+void StreamDSU::merge_stats(int32_t into, int32_t from) {
+    stat_count[into] += stat_count[from];
+    stat_min_y[into] = std::min(stat_min_y[into], stat_min_y[from]);
+    stat_min_x[into] = std::min(stat_min_x[into], stat_min_x[from]);
+    stat_max_y[into] = std::max(stat_max_y[into], stat_max_y[from]);
+    stat_max_x[into] = std::max(stat_max_x[into], stat_max_x[from]);
+    stat_sum_y[into] += stat_sum_y[from];
+    stat_sum_x[into] += stat_sum_x[from];
+    stat_perimeter[into] += stat_perimeter[from];
+    stat_count[from] = 0;
+}
+
+std::vector<int32_t> StreamDSU::get_neighbors(int y, int x, int& touching) {
+    // Pixels arrive in arbitrary order, so every direction may already be
+    // labeled (unlike a raster scan, which only needs left/top).
+    static const int OFFSETS[8][2] = {{0,-1}, {-1,0}, {0,1}, {1,0},
+                                      {-1,-1}, {-1,1}, {1,-1}, {1,1}};
+    const int num_offsets = eight_conn ? 8 : 4;
+
+    std::vector<int32_t> neighbors;
+    touching = 0;
+    for (int i = 0; i < num_offsets; ++i) {
+        int ny = y + OFFSETS[i][0];
+        int nx = x + OFFSETS[i][1];
+        if (ny < 0 || ny >= H || nx < 0 || nx >= W) {
+            continue;
+        }
+        auto it = coord_to_label.find(coord_to_idx(ny, nx));
+        if (it != coord_to_label.end()) {
+            neighbors.push_back(find(it->second));
+            if (i < 4) touching++;
+        }
+    }
+
+    // Remove duplicates
+    std::sort(neighbors.begin(), neighbors.end());
+    neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
+
+    return neighbors;
+}
+
+void StreamDSU::insert_pixel(int y, int x) {
+    int64_t idx = coord_to_idx(y, x);
+    if (coord_to_label.count(idx)) {
+        return;  // Already added
+    }
+
+    int touching = 0;
+    auto neighbors = get_neighbors(y, x, touching);
+
+    if (neighbors.empty()) {
+        // New component
+        coord_to_label[idx] = next_label;
+        parent.push_back(next_label);
+        rank.push_back(0);
+        new_component_stats(y, x);
+        num_components++;
+        if (on_events) {
+            pending_events.push_back({ComponentEventType::Created, next_label, 0, 1});
+            if (size_threshold == 1) {
+                pending_events.push_back({ComponentEventType::SizeThreshold, next_label, 0, 1});
+            }
+        }
+        next_label++;
+    } else {
+        // Merge with existing neighbors - use minimum root label
+        int32_t min_label = neighbors.front();
+        coord_to_label[idx] = min_label;
+        grow_stats(min_label, y, x, touching);
+        int grown = stat_count[min_label];
+        if (on_events && grown == size_threshold) {
+            pending_events.push_back({ComponentEventType::SizeThreshold, min_label, 0, grown});
+        }
+
+        // Union with other neighbors
+        for (int32_t nb : neighbors) {
+            if (nb != min_label) {
+                union_set(min_label, nb);
+            }
+        }
+    }
+}
+
+void StreamDSU::flush_events() {
+    if (!on_events || pending_events.empty()) {
+        return;
+    }
+    on_events(pending_events);
+    pending_events.clear();
+}
+
+void StreamDSU::add_pixel(int y, int x) {
+    insert_pixel(y, x);
+    flush_events();
+}
+
+void StreamDSU::add_pixels(const std::vector<std::pair<int, int>>& pixels) {
+    for (const auto& p : pixels) {
+        insert_pixel(p.first, p.second);
+    }
+    flush_events();
+}
+
+int32_t StreamDSU::get_component_id(int y, int x) {
+    auto it = coord_to_label.find(coord_to_idx(y, x));
+    if (it == coord_to_label.end()) {
+        return 0;
+    }
+    return find(it->second);
+}
+
+ComponentStats StreamDSU::get_component_stats(int32_t id) {
+    int32_t r = find(id);
+    int n = stat_count[r];
+    ComponentStats cs;
+    cs.id = r;
+    cs.size = n;
+    cs.min_y = stat_min_y[r];
+    cs.min_x = stat_min_x[r];
+    cs.max_y = stat_max_y[r];
+    cs.max_x = stat_max_x[r];
+    cs.centroid_y = n > 0 ? (double)stat_sum_y[r] / n : 0.0;
+    cs.centroid_x = n > 0 ? (double)stat_sum_x[r] / n : 0.0;
+    cs.perimeter = stat_perimeter[r];
+    return cs;
+}
+
+std::vector<ComponentStats> StreamDSU::get_all_component_stats() {
+    std::vector<ComponentStats> all;
+    all.reserve(num_components);
+    // Walk the label range (one slot per created component), not the pixels
+    for (int32_t lab = 1; lab < next_label; ++lab) {
+        if (parent[lab] == lab && stat_count[lab] > 0) {
+            all.push_back(get_component_stats(lab));
+        }
+    }
+    return all;
+}
+
+std::vector<int32_t> StreamDSU::get_labels() {
+    std::vector<int32_t> labels((size_t)H * W, 0);
+    std::unordered_map<int32_t, int32_t> root_to_final;
+    int final_label = 1;
+
+    // Map roots to final labels
+    std::unordered_set<int32_t> roots;
+    for (const auto& pair : coord_to_label) {
+        roots.insert(find(pair.second));
+    }
+    std::vector<int32_t> roots_sorted(roots.begin(), roots.end());
+    std::sort(roots_sorted.begin(), roots_sorted.end());
+    for (int32_t r : roots_sorted) {
+        root_to_final[r] = final_label++;
+    }
+
+    // Apply final labels
+    for (const auto& pair : coord_to_label) {
+        int64_t idx = pair.first;
+        int32_t root = find(pair.second);
+        labels[idx] = root_to_final[root];
+    }
+
+    return labels;
+}
+
+RunLabels StreamDSU::get_label_runs() {
+    // (pixel index, root) in raster order; roots numbered as in get_labels
+    std::vector<std::pair<int64_t, int32_t>> pixels;
+    pixels.reserve(coord_to_label.size());
+    std::vector<int32_t> roots;
+    for (const auto& pair : coord_to_label) {
+        int32_t root = find(pair.second);
+        pixels.emplace_back(pair.first, root);
+        roots.push_back(root);
+    }
+    std::sort(pixels.begin(), pixels.end());
+    std::sort(roots.begin(), roots.end());
+    roots.erase(std::unique(roots.begin(), roots.end()), roots.end());
+
+    RunLabels out;
+    out.H = H;
+    out.W = W;
+    out.components = (int)roots.size();
+    out.row_begin.assign(H > 0 ? H + 1 : 0, 0);
+    int row = 0;
+    for (size_t i = 0; i < pixels.size();) {
+        int y = (int)(pixels[i].first / W), x = (int)(pixels[i].first % W);
+        while (row <= y) out.row_begin[row++] = (int64_t)out.runs.size();
+        // Horizontal neighbours are always in the same component
+        size_t j = i + 1;
+        while (j < pixels.size() && pixels[j].first == pixels[j - 1].first + 1 && pixels[j].first % W != 0) ++j;
+        int32_t label = (int32_t)(std::lower_bound(roots.begin(), roots.end(), pixels[i].second) - roots.begin()) + 1;
+        out.runs.push_back({x, (int32_t)(j - i), label});
+        i = j;
+    }
+    while (row <= H && H > 0) out.row_begin[row++] = (int64_t)out.runs.size();
+    return out;
+}
+
+size_t StreamDSU::get_memory_usage() const {
+    // Heap bytes owned by the containers: vector capacity (not size), plus
+    // the hash map's bucket array and one node per entry (next pointer and
+    // key/value pair, as laid out by libstdc++ for integer keys).
+    size_t bytes = parent.capacity() * sizeof(int32_t) + rank.capacity() * sizeof(int8_t);
+    for (const auto* v : {&stat_count, &stat_min_y, &stat_min_x, &stat_max_y, &stat_max_x, &stat_perimeter}) {
+        bytes += v->capacity() * sizeof(int32_t);
+    }
+    bytes += (stat_sum_y.capacity() + stat_sum_x.capacity()) * sizeof(int64_t);
+    bytes += pending_events.capacity() * sizeof(ComponentEvent);
+
+    using MapNode = std::pair<void*, std::pair<const int64_t, int32_t>>;
+    if (coord_to_label.bucket_count() > 1) {
+        bytes += coord_to_label.bucket_count() * sizeof(void*);
+    }
+    bytes += coord_to_label.size() * sizeof(MapNode);
+    return bytes;
+}
@@ -0,0 +1,132 @@
+#ifndef STREAM_DSU_HPP
+#define STREAM_DSU_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+#include "run_labels.hpp"
+
+// Component lifecycle events reported by StreamDSU
+enum class ComponentEventType : uint8_t {
+    Created,        // a pixel started a new component
+    Merged,         // two components were joined by a pixel
+    SizeThreshold   // a component grew past the configured size threshold
+};
+
+struct ComponentEvent {
+    ComponentEventType type;
+    int32_t id;        // new / surviving / growing component id
+    int32_t absorbed;  // Merged only: id that no longer exists, otherwise 0
+    int32_t size;      // component size right after the event
+};
+
+// Per-component statistics, maintained incrementally by StreamDSU
+struct ComponentStats {
+    int32_t id;
+    int size;
+    int min_y, min_x, max_y, max_x;  // inclusive bounding box
+    double centroid_y, centroid_x;
+    int perimeter;  // exposed 4-neighbour pixel edges
+};
+
+// Receives all events produced by one add_pixels() call, in order
+using ComponentEventCallback = std::function<void(const std::vector<ComponentEvent>&)>;
+
+// Stream-based DSU implementation for incremental updates
+class StreamDSU {
+private:
+    std::vector<int32_t> parent;
+    std::vector<int8_t> rank;
+    std::unordered_map<int64_t, int32_t> coord_to_label;  // (y*W+x) -> label
+
+    // Root-indexed component statistics (struct of arrays, index = label).
+    // Only entries whose label is still a root are meaningful.
+    std::vector<int32_t> stat_count;
+    std::vector<int32_t> stat_min_y, stat_min_x, stat_max_y, stat_max_x;
+    std::vector<int64_t> stat_sum_y, stat_sum_x;
+    std::vector<int32_t> stat_perimeter;
+
+    int32_t next_label;
+    int H, W;
+    bool eight_conn;
+    int num_components;
+
+    // Event state: events are buffered and delivered once per add_pixels()
+    ComponentEventCallback on_events;
+    int size_threshold;
+    std::vector<ComponentEvent> pending_events;
+
+    int64_t coord_to_idx(int y, int x) const {
+        return (int64_t)y * W + x;
+    }
+
+    int32_t find(int32_t x) {
+        while (parent[x] != x) {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    void union_set(int32_t a, int32_t b);
+    void new_component_stats(int y, int x);  // appends the slot of label stat_count.size()
+    void grow_stats(int32_t root, int y, int x, int touching);
+    void merge_stats(int32_t into, int32_t from);
+    std::vector<int32_t> get_neighbors(int y, int x, int& touching);
+    void insert_pixel(int y, int x);
+    void flush_events();
+
+public:
+    StreamDSU(int h, int w, bool eight_connectivity = false);
+
+    // Register a callback for component lifecycle events. Passing an empty
+    // function disables event collection entirely.
+    void set_event_callback(ComponentEventCallback callback);
+
+    // Emit SizeThreshold once when a component reaches `threshold` pixels
+    // (0 disables the check).
+    void set_size_threshold(int threshold);
+
+    // Add a new pixel at (y, x) and update labels incrementally
+    void add_pixel(int y, int x);
+
+    // Add a batch of pixels; the event callback fires at most once
+    void add_pixels(const std::vector<std::pair<int, int>>& pixels);
+
+    // Get current number of components (maintained incrementally)
+    int get_component_count() const {
+        return num_components;
+    }
+
+    // Component id (current root label) of (y, x), or 0 for background
+    int32_t get_component_id(int y, int x);
+
+    // Statistics of the component with the given id (from get_component_id
+    // or an event). O(1), no pass over the stored pixels. `id` must satisfy
+    // is_component_id; an id merged away reports the component it joined.
+    ComponentStats get_component_stats(int32_t id);
+
+    // Whether `id` was ever handed out as a component id. These are internal
+    // root labels, not the consecutive numbers of get_labels().
+    bool is_component_id(int32_t id) const {
+        return id >= 1 && id < next_label;
+    }
+
+    // Statistics for every live component, ordered by id
+    std::vector<ComponentStats> get_all_component_stats();
+
+    // Get full label map (for verification)
+    std::vector<int32_t> get_labels();
+
+    // Same labels as run-length rows, built from the stored pixels alone
+    // (O(n log n) in the pixel count, no H * W buffer)
+    RunLabels get_label_runs();
+
+    // Heap bytes currently held by this engine's containers
+    size_t get_memory_usage() const;
+};
+
+#endif // STREAM_DSU_HPP
@@ -1,142 +1,21 @@
 #include "dsu_2pass.hpp"
 #include "algorithms.hpp"
+#include "stream_dsu.hpp"
+#include "workload.hpp"
+#include "alloc_tracker.hpp"
 #include <iostream>
 #include <vector>
 #include <chrono>
-#include <random>
 #include <iomanip>
 #include <set>
 #include <algorithm>
 #include <cstring>
-#include <sys/resource.h>
 #include <unordered_map>
 #include <unordered_set>
 
-// Stream DSU implementation
-class StreamDSU {
-private:
-    std::vector<int32_t> parent;
-    std::vector<int8_t> rank;
-    std::unordered_map<int, int32_t> coord_to_label;
-    int32_t next_label;
-    int H, W;
-    bool eight_conn;
-
-    int coord_to_idx(int y, int x) const {
-        return y * W + x;
-    }
-
-    int32_t find(int32_t x) {
-        while (parent[x] != x) {
-            parent[x] = parent[parent[x]];
-            x = parent[x];
-        }
-        return x;
-    }
-
-    void union_set(int32_t a, int32_t b) {
-        if (a == b) return;
-        int32_t ra = find(a);
-        int32_t rb = find(b);
-        if (ra == rb) return;
-        
-        if (rank[ra] < rank[rb]) {
-            parent[ra] = rb;
-        } else if (rank[ra] > rank[rb]) {
-            parent[rb] = ra;
-        } else {
-            parent[rb] = ra;
-            rank[ra]++;
-        }
-    }
-
-    std::vector<int32_t> get_neighbors(int y, int x) {
-        std::vector<int32_t> neighbors;
-        int idx = coord_to_idx(y, x);
-        
-        if (x - 1 >= 0) {
-            int left_idx = coord_to_idx(y, x - 1);
-            if (coord_to_label.count(left_idx)) {
-                neighbors.push_back(find(coord_to_label[left_idx]));
-            }
-        }
-        if (y - 1 >= 0) {
-            int top_idx = coord_to_idx(y - 1, x);
-            if (coord_to_label.count(top_idx)) {
-                neighbors.push_back(find(coord_to_label[top_idx]));
-            }
-        }
-        
-        if (eight_conn) {
-            if (x - 1 >= 0 && y - 1 >= 0) {
-                int tl_idx = coord_to_idx(y - 1, x - 1);
-                if (coord_to_label.count(tl_idx)) {
-                    neighbors.push_back(find(coord_to_label[tl_idx]));
-                }
-            }
-            if (x + 1 < W && y - 1 >= 0) {
-                int tr_idx = coord_to_idx(y - 1, x + 1);
-                if (coord_to_label.count(tr_idx)) {
-                    neighbors.push_back(find(coord_to_label[tr_idx]));
-                }
-            }
-        }
-        
-        std::sort(neighbors.begin(), neighbors.end());
-        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
-        return neighbors;
-    }
-
-public:
-    StreamDSU(int h, int w, bool eight_connectivity = false) 
-        : H(h), W(w), eight_conn(eight_connectivity), next_label(1) {
-        parent.resize(H * W + 1);
-        rank.resize(H * W + 1, 0);
-        for (size_t i = 0; i < parent.size(); ++i) {
-            parent[i] = i;
-        }
-    }
-
-    void add_pixel(int y, int x) {
-        int idx = coord_to_idx(y, x);
-        if (coord_to_label.count(idx)) {
-            return;
-        }
-
-        auto neighbors = get_neighbors(y, x);
-        
-        if (neighbors.empty()) {
-            coord_to_label[idx] = next_label;
-            next_label++;
-        } else {
-            int32_t min_label = *std::min_element(neighbors.begin(), neighbors.end());
-            coord_to_label[idx] = min_label;
-            
-            for (int32_t nb : neighbors) {
-                if (nb != min_label) {
-                    union_set(min_label, nb);
-                }
-            }
-        }
-    }
-
-    int get_component_count() {
-        std::unordered_set<int32_t> roots;
-        for (const auto& pair : coord_to_label) {
-            roots.insert(find(pair.second));
-        }
-        return roots.size();
-    }
-
-    size_t get_memory_usage() {
-        return coord_to_label.size() * (sizeof(int) + sizeof(int32_t)) + 
-               parent.size() * (sizeof(int32_t) + sizeof(int8_t));
-    }
-};
-
 struct StreamMetrics {
     double time_us;
-    size_t memory_bytes;
+    size_t memory_bytes;  // peak heap bytes of one run (measured)
     int components;
     double throughput_pixels_per_sec;
     int num_pixels;
@@ -164,10 +43,18 @@ StreamMetrics benchmark_stream_dsu(
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
     m.time_us = duration.count() / (double)iterations;
     m.components = stream_dsu->get_component_count();
-    m.memory_bytes = stream_dsu->get_memory_usage();
     m.throughput_pixels_per_sec = (m.num_pixels / (m.time_us / 1e6)) / 1e6; // MPixels/sec
-    
     delete stream_dsu;
+
+    // Heap accounting from one more untimed run
+    AllocScope scope;
+    {
+        StreamDSU measured(H, W, eight_conn);
+        for (const auto& p : pixels) {
+            measured.add_pixel(p.first, p.second);
+        }
+    }
+    m.memory_bytes = scope.stop().peak_bytes;
     return m;
 }
 
@@ -177,10 +64,7 @@ StreamMetrics benchmark_full_recompute(
     std::vector<int32_t> (*func)(const uint8_t*, int, int, bool),
     const char* name) {
     
-    std::vector<uint8_t> img(H * W, 0);
-    for (const auto& p : pixels) {
-        img[p.first * W + p.second] = 1;
-    }
+    std::vector<uint8_t> img = pixels_to_image(pixels, H, W);
     
     StreamMetrics m;
     m.num_pixels = pixels.size();
@@ -194,13 +78,14 @@ StreamMetrics benchmark_full_recompute(
     auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
     m.time_us = duration.count() / (double)iterations;
     
+    AllocScope scope;
     auto result = func(img.data(), H, W, eight_conn);
+    m.memory_bytes = scope.stop().peak_bytes + img.size();  // engine heap + input image
     std::set<int32_t> comps;
     for (int i = 0; i < H * W; ++i) {
         if (result[i] > 0) comps.insert(result[i]);
     }
     m.components = comps.size();
-    m.memory_bytes = H * W * sizeof(uint8_t) + H * W * sizeof(int32_t); // Approximate
     m.throughput_pixels_per_sec = (m.num_pixels / (m.time_us / 1e6)) / 1e6;
     
     return m;
@@ -224,7 +109,7 @@ void print_stream_metrics_table(
     std::cout << std::left << std::setw(20) << "Method";
     std::cout << std::right << std::setw(15) << "Time (μs)";
     std::cout << std::setw(15) << "Speedup";
-    std::cout << std::setw(15) << "Memory (MB)";
+    std::cout << std::setw(15) << "Peak Mem (MB)";
     std::cout << std::setw(15) << "Throughput";
     std::cout << std::setw(12) << "Components";
     std::cout << "\n";
@@ -263,27 +148,13 @@ void test_stream_vs_batch(int H, int W, bool eight_conn, int iterations) {
     std::cout << "\n";
     std::cout << std::string(72, '-') << "\n";
     
-    std::random_device rd;
-    std::mt19937 gen(42);
-    std::uniform_int_distribution<> y_dist(0, H - 1);
-    std::uniform_int_distribution<> x_dist(0, W - 1);
+    uint64_t seed = 42;
     
     for (int stream_size : stream_sizes) {
         if (stream_size > H * W) continue;
         
         // Generate stream pixels
-        std::vector<std::pair<int, int>> pixels;
-        std::set<std::pair<int, int>> used;
-        
-        for (int i = 0; i < stream_size; ++i) {
-            int y, x;
-            do {
-                y = y_dist(gen);
-                x = x_dist(gen);
-            } while (used.count({y, x}));
-            used.insert({y, x});
-            pixels.push_back({y, x});
-        }
+        std::vector<std::pair<int, int>> pixels = sample_pixels(H, W, stream_size, seed++);
         
         auto stream_metrics = benchmark_stream_dsu(pixels, H, W, eight_conn, iterations);
         auto batch_metrics = benchmark_full_recompute(pixels, H, W, eight_conn, iterations, label_cc_bfs, "BFS");
@@ -324,23 +195,7 @@ int main(int argc, char* argv[]) {
     std::cout << "  Iterations: " << iterations << "\n";
 
     // Generate stream pixels (random order)
-    std::random_device rd;
-    std::mt19937 gen(42);
-    std::uniform_int_distribution<> y_dist(0, H - 1);
-    std::uniform_int_distribution<> x_dist(0, W - 1);
-    
-    std::vector<std::pair<int, int>> pixels;
-    std::set<std::pair<int, int>> used;
-    
-    for (int i = 0; i < num_pixels; ++i) {
-        int y, x;
-        do {
-            y = y_dist(gen);
-            x = x_dist(gen);
-        } while (used.count({y, x}));
-        used.insert({y, x});
-        pixels.push_back({y, x});
-    }
+    std::vector<std::pair<int, int>> pixels = sample_pixels(H, W, num_pixels, 42);
 
     std::cout << "\nGenerated " << pixels.size() << " unique pixels in random order\n";
     std::cout << "Running benchmarks...\n";
@@ -1,185 +1,17 @@
 #include "dsu_2pass.hpp"
 #include "algorithms.hpp"
+#include "stream_dsu.hpp"
+#include "workload.hpp"
+#include "run_labels.hpp"
 #include <iostream>
 #include <vector>
 #include <chrono>
-#include <random>
 #include <unordered_map>
 #include <unordered_set>
 #include <set>
 #include <algorithm>
 #include <numeric>
 
-// Stream-based DSU implementation for incremental updates
-class StreamDSU {
-private:
-    std::vector<int32_t> parent;
-    std::vector<int8_t> rank;
-    std::unordered_map<int, int32_t> coord_to_label;  // (y*W+x) -> label
-    std::unordered_map<int32_t, int> label_count;      // label -> count
-    int32_t next_label;
-    int H, W;
-    bool eight_conn;
-
-    int coord_to_idx(int y, int x) const {
-        return y * W + x;
-    }
-
-    int32_t find(int32_t x) {
-        while (parent[x] != x) {
-            parent[x] = parent[parent[x]];
-            x = parent[x];
-        }
-        return x;
-    }
-
-    void union_set(int32_t a, int32_t b) {
-        if (a == b) return;
-        int32_t ra = find(a);
-        int32_t rb = find(b);
-        if (ra == rb) return;
-        
-        if (rank[ra] < rank[rb]) {
-            parent[ra] = rb;
-            label_count[rb] += label_count[ra];
-            label_count.erase(ra);
-        } else if (rank[ra] > rank[rb]) {
-            parent[rb] = ra;
-            label_count[ra] += label_count[rb];
-            label_count.erase(rb);
-        } else {
-            parent[rb] = ra;
-            rank[ra]++;
-            label_count[ra] += label_count[rb];
-            label_count.erase(rb);
-        }
-    }
-
-    std::vector<int32_t> get_neighbors(int y, int x) {
-        std::vector<int32_t> neighbors;
-        int idx = coord_to_idx(y, x);
-        
-        // left
-        if (x - 1 >= 0) {
-            int left_idx = coord_to_idx(y, x - 1);
-            if (coord_to_label.count(left_idx)) {
-                int32_t root = find(coord_to_label[left_idx]);
-                neighbors.push_back(root);
-            }
-        }
-        // top
-        if (y - 1 >= 0) {
-            int top_idx = coord_to_idx(y - 1, x);
-            if (coord_to_label.count(top_idx)) {
-                int32_t root = find(coord_to_label[top_idx]);
-                neighbors.push_back(root);
-            }
-        }
-        
-        if (eight_conn) {
-            // top-left
-            if (x - 1 >= 0 && y - 1 >= 0) {
-                int tl_idx = coord_to_idx(y - 1, x - 1);
-                if (coord_to_label.count(tl_idx)) {
-                    int32_t root = find(coord_to_label[tl_idx]);
-                    neighbors.push_back(root);
-                }
-            }
-            // top-right
-            if (x + 1 < W && y - 1 >= 0) {
-                int tr_idx = coord_to_idx(y - 1, x + 1);
-                if (coord_to_label.count(tr_idx)) {
-                    int32_t root = find(coord_to_label[tr_idx]);
-                    neighbors.push_back(root);
-                }
-            }
-        }
-        
-        // Remove duplicates
-        std::sort(neighbors.begin(), neighbors.end());
-        neighbors.erase(std::unique(neighbors.begin(), neighbors.end()), neighbors.end());
-        
-        return neighbors;
-    }
-
-public:
-    StreamDSU(int h, int w, bool eight_connectivity = false) 
-        : H(h), W(w), eight_conn(eight_connectivity), next_label(1) {
-        // Reserve space for labels (upper bound: H*W)
-        parent.resize(H * W + 1);
-        rank.resize(H * W + 1, 0);
-        for (size_t i = 0; i < parent.size(); ++i) {
-            parent[i] = i;
-        }
-    }
-
-    // Add a new pixel at (y, x) and update labels incrementally
-    void add_pixel(int y, int x) {
-        int idx = coord_to_idx(y, x);
-        if (coord_to_label.count(idx)) {
-            return;  // Already added
-        }
-
-        auto neighbors = get_neighbors(y, x);
-        
-        if (neighbors.empty()) {
-            // New component
-            coord_to_label[idx] = next_label;
-            label_count[next_label] = 1;
-            next_label++;
-        } else {
-            // Merge with existing neighbors - use minimum root label
-            int32_t min_label = *std::min_element(neighbors.begin(), neighbors.end());
-            coord_to_label[idx] = min_label;
-            label_count[min_label]++;
-            
-            // Union with other neighbors
-            for (int32_t nb : neighbors) {
-                if (nb != min_label) {
-                    union_set(min_label, nb);
-                }
-            }
-        }
-    }
-
-    // Get current number of components
-    int get_component_count() {
-        // Count unique root labels
-        std::unordered_set<int32_t> roots;
-        for (const auto& pair : coord_to_label) {
-            roots.insert(find(pair.second));
-        }
-        return roots.size();
-    }
-
-    // Get full label map (for verification)
-    std::vector<int32_t> get_labels() {
-        std::vector<int32_t> labels(H * W, 0);
-        std::unordered_map<int32_t, int32_t> root_to_final;
-        int final_label = 1;
-        
-        // Map roots to final labels
-        std::unordered_set<int32_t> roots;
-        for (const auto& pair : coord_to_label) {
-            roots.insert(find(pair.second));
-        }
-        std::vector<int32_t> roots_sorted(roots.begin(), roots.end());
-        std::sort(roots_sorted.begin(), roots_sorted.end());
-        for (int32_t r : roots_sorted) {
-            root_to_final[r] = final_label++;
-        }
-        
-        // Apply final labels
-        for (const auto& pair : coord_to_label) {
-            int idx = pair.first;
-            int32_t root = find(pair.second);
-            labels[idx] = root_to_final[root];
-        }
-        
-        return labels;
-    }
-};
-
 // Simulate stream input: pixels arrive one by one
 double benchmark_stream_dsu(const std::vector<std::pair<int, int>>& pixels, 
                             int H, int W, bool eight_conn, int iterations) {
@@ -202,10 +34,7 @@ double benchmark_full_recompute(const std::vector<std::pair<int, int>>& pixels,
                                 int H, int W, bool eight_conn, int iterations,
                                 std::vector<int32_t> (*func)(const uint8_t*, int, int, bool)) {
     // Build full image from pixels
-    std::vector<uint8_t> img(H * W, 0);
-    for (const auto& p : pixels) {
-        img[p.first * W + p.second] = 1;
-    }
+    std::vector<uint8_t> img = pixels_to_image(pixels, H, W);
     
     auto start = std::chrono::high_resolution_clock::now();
     for (int iter = 0; iter < iterations; ++iter) {
@@ -216,18 +45,37 @@ double benchmark_full_recompute(const std::vector<std::pair<int, int>>& pixels,
     return duration.count() / (double)iterations;
 }
 
+// Batch labeling straight from the pixel list (no H*W image)
+double benchmark_coords(const std::vector<std::pair<int, int>>& pixels, bool eight_conn, int iterations) {
+    std::vector<int32_t> labels;
+    auto start = std::chrono::high_resolution_clock::now();
+    for (int iter = 0; iter < iterations; ++iter) {
+        label_cc_coords(pixels, eight_conn, labels);
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
+    return duration.count() / (double)iterations;
+}
+
 int main(int argc, char* argv[]) {
     int H = 500;
     int W = 500;
     int num_pixels = 50000;  // Number of pixels in stream
     int iterations = 10;
     bool eight_conn = false;
+    uint64_t seed = 42;
+    StreamOrder order = StreamOrder::Random;
 
     if (argc > 1) H = std::stoi(argv[1]);
     if (argc > 2) W = std::stoi(argv[2]);
     if (argc > 3) num_pixels = std::stoi(argv[3]);
     if (argc > 4) iterations = std::stoi(argv[4]);
     if (argc > 5) eight_conn = (std::stoi(argv[5]) != 0);
+    if (argc > 6) seed = std::stoull(argv[6]);
+    if (argc > 7 && !parse_stream_order(argv[7], order)) {
+        std::cerr << "Unknown stream order: " << argv[7] << "\n";
+        return 1;
+    }
 
     std::cout << "============================================================\n";
     std::cout << "Stream Processing Performance Comparison\n";
@@ -235,26 +83,11 @@ int main(int argc, char* argv[]) {
     std::cout << "Image size: " << H << "x" << W << "\n";
     std::cout << "Stream size: " << num_pixels << " pixels\n";
     std::cout << "Connectivity: " << (eight_conn ? "8" : "4") << "\n";
-    std::cout << "Iterations: " << iterations << "\n\n";
+    std::cout << "Iterations: " << iterations << "\n";
+    std::cout << "Order: " << stream_order_name(order) << " (seed " << seed << ")\n\n";
 
-    // Generate random stream of pixels
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> y_dist(0, H - 1);
-    std::uniform_int_distribution<> x_dist(0, W - 1);
-    
-    std::vector<std::pair<int, int>> pixels;
-    std::set<std::pair<int, int>> seen;  // Avoid duplicates
-    
-    for (int i = 0; i < num_pixels; ++i) {
-        int y, x;
-        do {
-            y = y_dist(gen);
-            x = x_dist(gen);
-        } while (seen.count({y, x}));
-        seen.insert({y, x});
-        pixels.push_back({y, x});
-    }
+    // Generate stream of pixels
+    std::vector<std::pair<int, int>> pixels = generate_stream(H, W, num_pixels, order, seed);
 
     std::cout << "Generated " << pixels.size() << " unique pixels\n\n";
 
@@ -278,12 +111,12 @@ int main(int argc, char* argv[]) {
     double time_bfs = benchmark_full_recompute(pixels, H, W, eight_conn, iterations, label_cc_bfs);
     double time_dfs = benchmark_full_recompute(pixels, H, W, eight_conn, iterations, label_cc_dfs);
     double time_dsu = benchmark_full_recompute(pixels, H, W, eight_conn, iterations, label_cc_dsu);
+    double time_coords = benchmark_coords(pixels, eight_conn, iterations);
+    std::vector<int32_t> coord_labels;
+    int coord_components = label_cc_coords(pixels, eight_conn, coord_labels);
 
     // Verify correctness
-    std::vector<uint8_t> img(H * W, 0);
-    for (const auto& p : pixels) {
-        img[p.first * W + p.second] = 1;
-    }
+    std::vector<uint8_t> img = pixels_to_image(pixels, H, W);
     auto result_2pass = label_cc_2pass(img.data(), H, W, eight_conn);
     std::set<int32_t> components_2pass;
     for (int i = 0; i < H * W; ++i) {
@@ -295,13 +128,15 @@ int main(int argc, char* argv[]) {
     std::cout << "  BFS:          " << time_bfs << " μs\n";
     std::cout << "  DFS:          " << time_dfs << " μs\n";
     std::cout << "  DSU (1-pass): " << time_dsu << " μs\n";
+    std::cout << "  Coords (sparse): " << time_coords << " μs\n";
     std::cout << "  Components:  " << full_components << "\n\n";
 
     // Verify results match
-    if (stream_components != full_components) {
+    if (stream_components != full_components || coord_components != full_components) {
         std::cerr << "WARNING: Component count mismatch!\n";
         std::cerr << "  Stream DSU: " << stream_components << "\n";
         std::cerr << "  Full recompute: " << full_components << "\n";
+        std::cerr << "  Coords: " << coord_components << "\n";
     } else {
         std::cout << "✓ Results verified: " << stream_components << " components\n\n";
     }
@@ -318,7 +153,9 @@ int main(int argc, char* argv[]) {
     std::cout << "Full DFS:                 " << time_dfs << " μs (";
     std::cout << (time_dfs / stream_time) << "x slower)\n";
     std::cout << "Full DSU (1-pass):        " << time_dsu << " μs (";
-    std::cout << (time_dsu / stream_time) << "x slower)\n\n";
+    std::cout << (time_dsu / stream_time) << "x slower)\n";
+    std::cout << "Sparse coords (batch):    " << time_coords << " μs (";
+    std::cout << (time_coords / stream_time) << "x slower)\n\n";
 
     if (stream_time < time_2pass && stream_time < time_bfs && 
         stream_time < time_dfs && stream_time < time_dsu) {
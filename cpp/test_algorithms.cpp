@@ -1,9 +1,37 @@
 #include "dsu_2pass.hpp"
 #include "algorithms.hpp"
+#include "stream_dsu.hpp"
+#include "percolation.hpp"
+#include "workload.hpp"
+#include "incremental_dsu.hpp"
+#include "event_log.hpp"
+#include "bench_harness.hpp"
+#include "perf_counters.hpp"
+#include "alloc_tracker.hpp"
+#include "pnm.hpp"
+#include "bandwidth.hpp"
+#include "auto_engine.hpp"
+#include "ccl_batch.hpp"
+#include "mask_pipeline.hpp"
+#include "morphology.hpp"
+#include "roi.hpp"
+#include "label_service.hpp"
+#include "mask_io.hpp"
+#include "component_stats.hpp"
+#include "run_labels.hpp"
+#include "connectivity.hpp"
 #include <iostream>
 #include <vector>
 #include <cassert>
 #include <set>
+#include <algorithm>
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+#include <sys/stat.h>
 
 bool test_simple_4_connected() {
     // Test image: 2 components
@@ -141,6 +169,1235 @@ bool test_consistency() {
     return true;
 }
 
+bool test_stream_events() {
+    // Two single pixels, then a bridge pixel joining them:
+    // [1, 0, 1]  ->  [1, 1, 1]
+    StreamDSU stream(1, 3);
+    stream.set_size_threshold(3);
+
+    std::vector<std::vector<ComponentEvent>> batches;
+    stream.set_event_callback([&](const std::vector<ComponentEvent>& events) {
+        batches.push_back(events);
+    });
+
+    stream.add_pixels({{0, 0}, {0, 2}});
+    assert(batches.size() == 1);
+    assert(batches[0].size() == 2);
+    assert(batches[0][0].type == ComponentEventType::Created);
+    assert(batches[0][1].type == ComponentEventType::Created);
+    assert(stream.get_component_count() == 2);
+
+    stream.add_pixels({{0, 1}});
+    assert(batches.size() == 2);
+    const auto& merge_batch = batches[1];
+    assert(merge_batch.size() == 2);
+    assert(merge_batch[0].type == ComponentEventType::Merged);
+    assert(merge_batch[0].size == 3);
+    assert(merge_batch[0].id != merge_batch[0].absorbed);
+    assert(merge_batch[1].type == ComponentEventType::SizeThreshold);
+    assert(merge_batch[1].id == merge_batch[0].id);
+    assert(stream.get_component_count() == 1);
+
+    // Re-adding an existing pixel produces no callback
+    stream.add_pixels({{0, 1}});
+    assert(batches.size() == 2);
+
+    return true;
+}
+
+bool test_stream_matches_batch() {
+    // Pixels of the consistency pattern, added in reverse raster order so
+    // right/bottom neighbours always arrive first
+    int H = 50, W = 50;
+    std::vector<uint8_t> img(H * W);
+    for (int i = 0; i < H * W; ++i) {
+        img[i] = (i % 7 < 2) ? 1 : 0;
+    }
+
+    for (bool eight_conn : {false, true}) {
+        StreamDSU stream(H, W, eight_conn);
+        for (int i = H * W - 1; i >= 0; --i) {
+            if (img[i]) stream.add_pixel(i / W, i % W);
+        }
+
+        auto result_2pass = label_cc_2pass(img.data(), H, W, eight_conn);
+        std::set<int32_t> labels_2pass;
+        for (int i = 0; i < H * W; ++i) {
+            if (result_2pass[i] > 0) labels_2pass.insert(result_2pass[i]);
+        }
+        assert(stream.get_component_count() == (int)labels_2pass.size());
+    }
+
+    return true;
+}
+
+bool test_stream_component_stats() {
+    // Ring with a hole, built out of order:
+    // [1, 1, 1]
+    // [1, 0, 1]
+    // [1, 1, 1]
+    StreamDSU stream(3, 3);
+    stream.add_pixels({{0, 0}, {2, 2}, {0, 2}, {2, 0}, {1, 0}, {1, 2}, {0, 1}, {2, 1}});
+    assert(stream.get_component_count() == 1);
+
+    int32_t id = stream.get_component_id(2, 1);
+    assert(id != 0);
+    assert(stream.get_component_id(1, 1) == 0);
+
+    ComponentStats cs = stream.get_component_stats(id);
+    assert(cs.size == 8);
+    assert(cs.min_y == 0 && cs.min_x == 0 && cs.max_y == 2 && cs.max_x == 2);
+    assert(cs.centroid_y == 1.0 && cs.centroid_x == 1.0);
+    assert(cs.perimeter == 16);  // 12 outer + 4 inner edges
+
+    auto all = stream.get_all_component_stats();
+    assert(all.size() == 1);
+    assert(all[0].id == id && all[0].size == 8);
+
+    return true;
+}
+
+bool test_percolation_sweep() {
+    // Column order on a 3x2 grid: left column spans vertically at step 3
+    std::vector<std::pair<int, int>> order = {
+        {0, 0}, {2, 0}, {1, 0}, {0, 1}, {1, 1}, {2, 1}
+    };
+    PercolationResult r = percolation_sweep(order, 3, 2);
+    assert(r.steps.size() == 6);
+    assert(r.steps[1].components == 2 && r.steps[1].largest_cluster == 1);
+    assert(r.steps[2].components == 1 && r.steps[2].largest_cluster == 3);
+    assert(r.steps[2].spans_vertical && !r.steps[2].spans_horizontal);
+    assert(r.first_spanning_step == 2);
+    assert(r.steps[3].spans_horizontal);
+    assert(r.steps[5].largest_cluster == 6);
+
+    // Random sweep over the full grid ends in one cluster
+    PercolationResult full = percolation_sweep(20, 30, 7);
+    assert(full.steps.size() == 600);
+    assert(full.steps.back().components == 1);
+    assert(full.steps.back().largest_cluster == 600);
+
+    return true;
+}
+
+bool test_workload_generator() {
+    int H = 40, W = 30;
+    const StreamOrder orders[] = {StreamOrder::Random, StreamOrder::Raster, StreamOrder::Spiral,
+                                  StreamOrder::BlobGrowth, StreamOrder::EdgeInward};
+    // Sparse (bitmap) and dense (Fisher-Yates) sampling paths
+    for (int count : {100, 1000}) {
+        for (StreamOrder order : orders) {
+            auto a = generate_stream(H, W, count, order, 123);
+            auto b = generate_stream(H, W, count, order, 123);
+            assert(a == b);  // deterministic for a given seed
+            assert((int)a.size() == count);
+
+            std::set<std::pair<int, int>> distinct(a.begin(), a.end());
+            assert((int)distinct.size() == count);
+            for (const auto& p : a) {
+                assert(p.first >= 0 && p.first < H && p.second >= 0 && p.second < W);
+            }
+        }
+    }
+
+    // Blob growth yields a single 4-connected component
+    auto blob = generate_stream(H, W, 300, StreamOrder::BlobGrowth, 5);
+    StreamDSU stream(H, W);
+    stream.add_pixels(blob);
+    assert(stream.get_component_count() == 1);
+
+    // Edge-inward never moves back out towards the border
+    auto edge = generate_stream(H, W, 500, StreamOrder::EdgeInward, 5);
+    int prev_ring = 0;
+    for (const auto& p : edge) {
+        int ring = std::min({p.first, p.second, H - 1 - p.first, W - 1 - p.second});
+        assert(ring >= prev_ring);
+        prev_ring = ring;
+    }
+
+    auto img = generate_random_image(H, W, 0.3, 9);
+    assert(img == generate_random_image(H, W, 0.3, 9));
+
+    return true;
+}
+
+bool test_incremental_matches_batch() {
+    int H = 40, W = 40;
+    auto pixels = sample_pixels(H, W, 700, 11);
+    std::vector<std::pair<int, int>> base(pixels.begin(), pixels.begin() + 400);
+    std::vector<uint8_t> base_img = pixels_to_image(base, H, W);
+    std::vector<uint8_t> full_img = pixels_to_image(pixels, H, W);
+
+    for (bool eight_conn : {false, true}) {
+        IncrementalDSU inc(H, W, eight_conn);
+        inc.initialize(base_img.data());
+        for (size_t i = 400; i < pixels.size(); ++i) {
+            inc.add_pixel(pixels[i].first, pixels[i].second);
+        }
+        auto result_2pass = label_cc_2pass(full_img.data(), H, W, eight_conn);
+        std::set<int32_t> labels_2pass;
+        for (int i = 0; i < H * W; ++i) {
+            if (result_2pass[i] > 0) labels_2pass.insert(result_2pass[i]);
+        }
+        assert(inc.get_component_count() == (int)labels_2pass.size());
+    }
+
+    return true;
+}
+
+bool test_event_log_roundtrip() {
+    int H = 300, W = 200;
+    auto pixels = generate_stream(H, W, 5000, StreamOrder::Random, 3);
+    std::vector<PixelEvent> events;
+    for (size_t i = 0; i < pixels.size(); ++i) {
+        events.push_back({pixels[i].first, pixels[i].second, i * 37});
+    }
+
+    for (bool with_timestamps : {false, true}) {
+        std::vector<uint8_t> buf;
+        encode_event_log(events, H, W, with_timestamps, buf);
+
+        EventLogReader reader;
+        assert(reader.open_buffer(buf.data(), buf.size()));
+        assert(reader.height() == H && reader.width() == W);
+        assert(reader.size() == events.size());
+        assert(reader.has_timestamps() == with_timestamps);
+
+        PixelEvent e;
+        size_t n = 0;
+        while (reader.next(e)) {
+            assert(e.y == events[n].y && e.x == events[n].x);
+            assert(e.t_us == (with_timestamps ? events[n].t_us : 0));
+            n++;
+        }
+        assert(n == events.size());
+
+        // Truncated logs are reported, not read past
+        EventLogReader truncated;
+        assert(truncated.open_buffer(buf.data(), buf.size() / 2));
+        while (truncated.next(e)) {}
+        assert(!truncated.error().empty());
+    }
+
+    // Raster order packs into about one byte per event
+    auto raster = generate_stream(H, W, 5000, StreamOrder::Raster, 3);
+    std::vector<PixelEvent> raster_events;
+    for (const auto& p : raster) raster_events.push_back({p.first, p.second, 0});
+    std::vector<uint8_t> buf;
+    encode_event_log(raster_events, H, W, false, buf);
+    assert(buf.size() < 28 + 2 * raster_events.size());
+
+    return true;
+}
+
+bool test_bench_statistics() {
+    // 9 samples around 10 with one large outlier
+    std::vector<double> samples = {10, 11, 9, 10, 12, 8, 10, 11, 100};
+    BenchStats s = summarize_samples(samples);
+    assert(s.samples == 9);
+    assert(s.median_us == 10);
+    assert(s.mad_us == 1);
+    assert(s.min_us == 8 && s.max_us == 100);
+    assert(s.ci_low_us <= s.median_us && s.median_us <= s.ci_high_us);
+    assert(s.outliers == 1);
+
+    BenchOptions opts;
+    opts.repetitions = 5;
+    opts.warmup = 1;
+    opts.min_sample_us = 0;
+    int calls = 0;
+    BenchStats run = run_benchmark([&] { calls++; }, opts);
+    assert(run.samples == 5 && run.calls_per_sample == 1);
+    assert(calls == 1 + 1 + 5);  // warm-up, calibration, samples
+
+    assert(find_engine("BFS") == static_cast<LabelFunc>(label_cc_bfs));
+    assert(find_engine("nope") == nullptr);
+
+    return true;
+}
+
+bool test_phase_observer() {
+    // Records the sequence of phases an engine reports
+    struct PhaseLog : PhaseObserver {
+        std::vector<CCLPhase> begun;
+        int open = 0;
+        void begin_phase(CCLPhase phase) override { begun.push_back(phase); open++; }
+        void end_phase(CCLPhase) override { open--; }
+    };
+
+    std::vector<uint8_t> img = {
+        1, 0, 1,
+        1, 0, 1,
+        1, 1, 1
+    };
+
+    PhaseLog log;
+    {
+        ScopedPhaseObserver install(&log);
+        label_cc_2pass(img.data(), 3, 3);
+    }
+    assert(current_phase_observer() == nullptr);
+    assert(log.open == 0);
+    assert((log.begun == std::vector<CCLPhase>{CCLPhase::Scan, CCLPhase::Resolve, CCLPhase::Relabel}));
+
+    // Counters may be refused (containers, VMs); recording must still work
+    PerfCounters counters;
+    PerfPhaseRecorder recorder(counters);
+    recorder.run([&] { label_cc_dsu(img.data(), 3, 3, false); }, 2);
+    if (!counters.available()) {
+        assert(!counters.error().empty());
+        assert(recorder.total()[PerfEvent::Cycles] == 0.0);
+    }
+
+    return true;
+}
+
+bool test_alloc_tracking() {
+    // alloc_hook.cpp is linked into this test
+    assert(alloc_tracking_enabled());
+
+    AllocScope scope;
+    std::vector<int32_t> a(1000);
+    {
+        std::vector<int32_t> b(4000);
+    }
+    AllocStats s = scope.stop();
+    assert(s.allocations == 2);
+    assert(s.total_bytes == 5000 * sizeof(int32_t));
+    assert(s.peak_bytes == 5000 * sizeof(int32_t));
+    assert(s.live_bytes == (int64_t)(1000 * sizeof(int32_t)));
+
+    // The engine's own accounting matches what it actually allocated
+    int H = 40;
+    int W = 40;
+    auto pixels = sample_pixels(H, W, 600, 7);
+    AllocScope stream_scope;
+    StreamDSU stream(H, W);
+    stream.add_pixels(pixels);
+    AllocStats held = stream_scope.stop();
+    assert((int64_t)stream.get_memory_usage() == held.live_bytes);
+
+    return true;
+}
+
+bool test_engine_trace() {
+    // A "U": the two arms get separate provisional labels and merge at the bottom
+    std::vector<uint8_t> img = {
+        1, 0, 1,
+        1, 0, 1,
+        1, 1, 1
+    };
+
+    CCLTrace t;
+    auto traced = label_cc_2pass(img.data(), 3, 3, false, t);
+    assert(traced == label_cc_2pass(img.data(), 3, 3));
+    assert(t.provisional_labels == 2);
+    assert(t.label_capacity == t.provisional_labels + 1);
+    assert(t.components == 1);
+    assert(t.merges == 1);
+    assert(t.union_calls >= t.merges);
+    assert(t.find_calls > 0);
+
+    label_cc_dsu(img.data(), 3, 3, false, t);
+    assert(t.provisional_labels == 7);
+    assert(t.components == 1);
+    assert(t.merges == 6);  // 7 pixels joined into one tree
+
+    label_cc_bfs(img.data(), 3, 3, false, t);
+    assert(t.components == 1);
+    assert(t.max_frontier >= 1);
+    assert(t.pushes == 7 && t.neighbour_checks == 7 * 4);  // every foreground pixel, seed included
+    assert(t.union_calls == 0);
+
+    label_cc_dfs(img.data(), 3, 3, true, t);
+    assert(t.components == 1);
+    assert(t.max_frontier >= 1);
+    assert(t.pushes == 7 && t.neighbour_checks == 7 * 8);
+
+    return true;
+}
+
+static int component_count(const std::vector<int32_t>& labels) {
+    return labels.empty() ? 0 : *std::max_element(labels.begin(), labels.end());
+}
+
+bool test_shape_corpus() {
+    int H = 20;
+    int W = 30;
+
+    auto checker = generate_shape_image(ShapeClass::Checkerboard, H, W, 1);
+    assert(component_count(label_cc_2pass(checker.data(), H, W, false)) == H * W / 2);
+    assert(component_count(label_cc_2pass(checker.data(), H, W, true)) == 1);
+
+    auto snake = generate_shape_image(ShapeClass::Snake, H, W, 1);
+    assert(component_count(label_cc_dfs(snake.data(), H, W, false)) == 1);
+
+    for (ShapeClass cls : all_shape_classes()) {
+        ShapeClass parsed;
+        assert(parse_shape_class(shape_class_name(cls), parsed) && parsed == cls);
+        auto a = generate_shape_image(cls, H, W, 9);
+        assert(a == generate_shape_image(cls, H, W, 9));
+        assert(label_cc_bfs(a.data(), H, W) == label_cc_2pass(a.data(), H, W));
+    }
+
+    // PGM round trip through the corpus reader
+    std::vector<uint8_t> mask(H * W);
+    for (int i = 0; i < H * W; ++i) mask[i] = snake[i] * 255;
+    std::string path = "test_corpus_mask.pgm";
+    assert(write_pgm(path, mask.data(), H, W));
+    PnmImage pnm;
+    std::string error;
+    assert(read_pnm(path, pnm, error));
+    std::remove(path.c_str());
+    assert(pnm.H == H && pnm.W == W && pnm.maxval == 255);
+    assert(pnm_to_mask(pnm) == snake);
+
+    // ASCII PBM (1 = foreground) and packed P4
+    std::string p1 = "P1\n# comment\n3 2\n1 0 1\n011\n";
+    assert(parse_pnm((const uint8_t*)p1.data(), p1.size(), pnm, error));
+    assert((pnm.pixels == std::vector<uint8_t>{1, 0, 1, 0, 1, 1}));
+    const uint8_t p4[] = {'P', '4', '\n', '3', ' ', '2', '\n', 0xA0, 0x60};
+    assert(parse_pnm(p4, sizeof(p4), pnm, error));
+    assert((pnm.pixels == std::vector<uint8_t>{1, 0, 1, 0, 1, 1}));
+    assert(!parse_pnm(p4, sizeof(p4) - 1, pnm, error));
+
+    return true;
+}
+
+bool test_regression_gate() {
+    BenchRecord base = {};
+    base.engine = "BFS";
+    base.input = "Full Image";
+    base.H = base.W = 100;
+    base.work_pixels = 10000;
+    base.components = 12;
+    base.seed = 7;
+    base.stats = summarize_samples({100, 101, 99, 100, 102, 98, 100});
+
+    std::string path = "test_regression_baseline.csv";
+    assert(write_results_csv(path, {base}));
+    std::vector<BenchRecord> loaded;
+    std::string error;
+    assert(read_results_csv(path, loaded, error));
+    std::remove(path.c_str());
+    assert(loaded.size() == 1);
+    assert(loaded[0].engine == "BFS" && loaded[0].input == "Full Image");
+    assert(loaded[0].H == 100 && loaded[0].components == 12 && loaded[0].seed == 7);
+    assert(loaded[0].stats.median_us == base.stats.median_us);
+
+    // Within noise + tolerance: fine; clearly slower: flagged
+    BenchRecord same = base;
+    same.stats = summarize_samples({103, 104, 102, 103, 105, 101, 103});
+    BenchRecord slow = base;
+    slow.stats = summarize_samples({130, 131, 129, 130, 132, 128, 130});
+    assert(!compare_to_baseline(loaded, {same}, 0.05)[0].regressed);
+    auto flagged = compare_to_baseline(loaded, {slow}, 0.05);
+    assert(flagged.size() == 1 && flagged[0].regressed && !flagged[0].mismatch);
+
+    // Noisy runs widen the threshold
+    BenchStats noisy = summarize_samples({100, 80, 120, 100, 90, 110, 100});
+    assert(regression_threshold_us(base.stats, noisy, 0.05) > regression_threshold_us(base.stats, base.stats, 0.05));
+
+    // Unmatched rows are reported, not compared
+    BenchRecord other = base;
+    other.H = other.W = 200;
+    std::vector<BenchRecord> missing;
+    assert(compare_to_baseline(loaded, {other}, 0.05, &missing).empty());
+    assert(missing.size() == 1);
+
+    // Auto rows (ccl_bench --auto) are matched and checked like any engine
+    BenchRecord auto_base = base;
+    auto_base.engine = "Auto";
+    assert(write_results_csv(path, {base, auto_base}));
+    loaded.clear();
+    assert(read_results_csv(path, loaded, error));
+    std::remove(path.c_str());
+    assert(loaded.size() == 2 && loaded[1].engine == "Auto");
+    BenchRecord auto_slow = slow;
+    auto_slow.engine = "Auto";
+    missing.clear();
+    auto checked = compare_to_baseline(loaded, {same, auto_slow}, 0.05, &missing);
+    assert(checked.size() == 2 && missing.empty());
+    assert(!checked[0].regressed && checked[1].regressed);
+
+    return true;
+}
+
+bool test_bandwidth_model() {
+    // Traffic covers at least input + labels and grows with the image
+    auto img = generate_shape_image(ShapeClass::Checkerboard, 32, 32, 1);
+    auto big = generate_shape_image(ShapeClass::Checkerboard, 64, 64, 1);
+    for (const auto& e : batch_engines()) {
+        CCLTrace small_trace, big_trace;
+        e.traced(img.data(), 32, 32, false, small_trace);
+        e.traced(big.data(), 64, 64, false, big_trace);
+        int64_t small_bytes = e.traffic(32, 32, small_trace);
+        int64_t big_bytes = e.traffic(64, 64, big_trace);
+        assert(small_bytes >= 5 * 32 * 32);
+        assert(big_bytes > 3 * small_bytes);
+    }
+
+    BenchOptions opts;
+    opts.repetitions = 3;
+    opts.warmup = 1;
+    BandwidthBaseline bw = measure_bandwidth(1 << 16, opts);
+    assert(bw.bytes == (1 << 16));
+    assert(bw.copy_gbs > 0 && bw.scan_gbs > 0 && bw.fill_gbs > 0);
+
+    return true;
+}
+
+bool test_auto_engine() {
+    // Row sampling: stripes of 3-pixel runs on every other row
+    int H = 40, W = 40;
+    std::vector<uint8_t> img(H * W, 0);
+    for (int i = 0; i < H; i += 2) {
+        for (int j = 0; j < W; ++j) img[i * W + j] = (j % 4) < 3;
+    }
+    InputFeatures f = sample_features(img.data(), H, W, H);
+    assert(f.pixels == H * W);
+    assert(std::abs(f.density - 0.375) < 1e-9);
+    assert(std::abs(f.mean_run - 3.0) < 1e-9);
+    assert(std::abs(f.row_occupancy - 0.5) < 1e-9);
+
+    // Nearest point with matching connectivity wins
+    CalibrationTable table = {
+        {{10000, 0.1, 2.0, 1.0}, false, "BFS", 1.0},
+        {{10000, 0.7, 12.0, 1.0}, false, "DSU 1-pass", 1.0},
+        {{10000, 0.7, 12.0, 1.0}, true, "DFS", 1.0},
+    };
+    assert(select_engine({10000, 0.12, 2.2, 1.0}, false, table) == "BFS");
+    assert(select_engine({12000, 0.65, 10.0, 1.0}, false, table) == "DSU 1-pass");
+    assert(select_engine({10000, 0.12, 2.2, 1.0}, true, table) == "DFS");
+
+    // Round trip through the CSV form
+    std::string path = "test_calibration.csv";
+    assert(write_calibration(path, table));
+    CalibrationTable loaded;
+    std::string error;
+    assert(read_calibration(path, loaded, error));
+    std::remove(path.c_str());
+    assert(loaded.size() == table.size());
+    assert(loaded[1].engine == "DSU 1-pass" && loaded[2].eight_conn);
+    for (const char* row : {"10000,0.1,2,1,0,BFS", "10000,0.1,2,1,0,BFS,1.0,extra"}) {
+        std::ofstream(path) << "Pixels,Density,MeanRun,RowOccupancy,EightConn,Engine,Median_us\n" << row << "\n";
+        CalibrationTable bad;
+        assert(!read_calibration(path, bad, error) && error.find("expected 7 fields") != std::string::npos);
+    }
+    std::remove(path.c_str());
+
+    // Whatever it dispatches to, the labeling matches the reference
+    auto noise = generate_random_image(60, 60, 0.4, 3);
+    for (bool eight : {false, true}) {
+        assert(component_count(label_cc_auto(noise.data(), 60, 60, eight)) ==
+               component_count(label_cc_2pass(noise.data(), 60, 60, eight)));
+    }
+    set_calibration(table);
+    CCLTrace trace;
+    auto labels = label_cc_auto(noise.data(), 60, 60, false, trace);
+    assert(trace.components == component_count(labels));
+    set_calibration(builtin_calibration());
+
+    // The built-in table sends dense noise to the two-pass engine, the
+    // fastest one there since its rewrite
+    auto dense = generate_random_image(1000, 1000, 0.6, 5);
+    for (bool eight : {false, true}) {
+        assert(select_engine(sample_features(dense.data(), 1000, 1000), eight, builtin_calibration()) ==
+               "2-Pass DSU");
+    }
+
+    return true;
+}
+
+bool test_batch_labeling() {
+    // Mixed sizes so that stealing has something to even out
+    std::vector<std::vector<uint8_t>> masks;
+    std::vector<ImageView> views;
+    for (int i = 0; i < 40; ++i) {
+        int size = (i % 5 == 0) ? 120 : 30;
+        masks.push_back(generate_random_image(size, size, 0.2 + 0.1 * (i % 5), 100 + i));
+    }
+    for (const auto& m : masks) {
+        int size = (int)std::lround(std::sqrt((double)m.size()));
+        views.emplace_back(m, size, size);
+    }
+
+    for (bool eight : {false, true}) {
+        BatchOptions opts;
+        opts.threads = 4;
+        opts.eight_connectivity = eight;
+        BatchStats stats;
+        auto results = label_batch(views, opts, &stats);
+        assert(results.size() == views.size());
+        assert(stats.threads == 4);
+        int total = 0;
+        for (int n : stats.images_per_worker) total += n;
+        assert(total == (int)views.size());
+
+        // Identical to the single-image engine, in input order
+        for (size_t i = 0; i < views.size(); ++i) {
+            auto expected = label_cc_2pass(views[i].data, views[i].H, views[i].W, eight);
+            assert(results[i].labels == expected);
+            assert(results[i].components == component_count(expected));
+        }
+    }
+
+    // A pool is reusable across runs and calls each task exactly once
+    WorkStealingPool pool(3);
+    for (int run = 0; run < 5; ++run) {
+        std::vector<int> hits(1000, 0);
+        pool.run(1000, [&](int64_t task, int) { hits[task]++; });
+        assert(std::all_of(hits.begin(), hits.end(), [](int h) { return h == 1; }));
+    }
+
+    // A workspace reused across calls allocates nothing once grown
+    CCLWorkspace ws;
+    std::vector<int32_t> labels(views[0].H * views[0].W);
+    label_cc_2pass(views[0].data, views[0].H, views[0].W, false, ws, labels.data());
+    AllocScope scope;
+    label_cc_2pass(views[0].data, views[0].H, views[0].W, false, ws, labels.data());
+    if (alloc_tracking_enabled()) {
+        assert(scope.stop().allocations == 0);
+    }
+
+    return true;
+}
+
+bool test_mask_pipeline() {
+    // PPM decodes to PIL's luma; raw P6 and ASCII P3 agree
+    const char p3[] = "P3\n2 1\n255\n255 0 0  10 200 30\n";
+    PnmImage ascii;
+    std::string error;
+    assert(parse_pnm(reinterpret_cast<const uint8_t*>(p3), sizeof(p3) - 1, ascii, error));
+    assert(ascii.H == 1 && ascii.W == 2);
+    assert(ascii.pixels[0] == 76 && ascii.pixels[1] == 124);
+    std::vector<uint8_t> p6 = {'P', '6', '\n', '2', ' ', '1', '\n', '2', '5', '5', '\n', 255, 0, 0, 10, 200, 30};
+    PnmImage binary;
+    assert(parse_pnm(p6.data(), p6.size(), binary, error));
+    assert(binary.pixels == ascii.pixels);
+
+    // Banked histogram matches a plain count, including the tail
+    std::vector<uint8_t> gray(103 * 57);
+    uint64_t state = 12345;
+    for (auto& v : gray) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        v = (uint8_t)(state >> 56);
+    }
+    uint32_t hist[256], expected[256] = {0};
+    gray_histogram(gray.data(), gray.size(), hist);
+    for (uint8_t v : gray) expected[v]++;
+    assert(std::equal(hist, hist + 256, expected));
+
+    // Otsu splits a bimodal histogram between the modes
+    uint32_t bimodal[256] = {0};
+    bimodal[40] = 500;
+    bimodal[50] = 300;
+    bimodal[200] = 400;
+    int t = otsu_threshold(bimodal);
+    assert(t >= 50 && t < 200);
+
+    // Fused threshold + labeling == labeling the explicit mask
+    CCLWorkspace ws;
+    for (bool invert : {false, true}) {
+        for (bool eight : {false, true}) {
+            MaskPipelineOptions opts;
+            opts.smooth = 1.5;
+            opts.invert = invert;
+            opts.eight_connectivity = eight;
+            MaskPipelineResult r = run_mask_pipeline(gray.data(), 103, 57, opts, ws);
+
+            std::vector<uint8_t> blurred(gray.size()), mask(gray.size());
+            gaussian_blur(gray.data(), 103, 57, 1.5, blurred.data());
+            int64_t fg = 0;
+            for (size_t i = 0; i < mask.size(); ++i) {
+                mask[i] = (blurred[i] <= r.threshold) != invert;
+                fg += mask[i];
+            }
+            assert(r.foreground == fg);
+            auto labels = label_cc_2pass(mask.data(), 103, 57, eight);
+            assert(r.labels == labels);
+            assert(r.components == component_count(labels));
+
+            // With an opening, rows are thresholded on demand inside the chain
+            opts.open_iterations = 1;
+            opts.open_se = eight ? StructElem::Square : StructElem::Cross;
+            r = run_mask_pipeline(gray.data(), 103, 57, opts, ws);
+            auto opened = unpack_mask(opening(pack_mask(mask.data(), 103, 57), opts.open_se, 1));
+            labels = label_cc_2pass(opened.data(), 103, 57, eight);
+            assert(r.labels == labels);
+            assert(r.components == component_count(labels));
+        }
+    }
+
+    // A flat image blurs to itself
+    std::vector<uint8_t> flat(20 * 20, 77), out(20 * 20);
+    gaussian_blur(flat.data(), 20, 20, 2.0, out.data());
+    assert(out == flat);
+
+    return true;
+}
+
+// Byte-image 3x3 erosion/dilation with 0 outside the image (scipy's border_value=0)
+static std::vector<uint8_t> reference_morph(const std::vector<uint8_t>& img, int H, int W,
+                                            bool dilate, StructElem se) {
+    std::vector<uint8_t> out(img.size());
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            bool any = false, all = true;
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    if (se == StructElem::Cross && dy != 0 && dx != 0) continue;
+                    int yy = y + dy, xx = x + dx;
+                    bool v = yy >= 0 && yy < H && xx >= 0 && xx < W && img[yy * W + xx];
+                    any |= v;
+                    all &= v;
+                }
+            }
+            out[y * W + x] = dilate ? any : all;
+        }
+    }
+    return out;
+}
+
+bool test_morphology() {
+    // Widths around word boundaries
+    for (int W : {5, 63, 64, 65, 130}) {
+        int H = 23;
+        auto img = generate_random_image(H, W, 0.6, W);
+        BitMask packed = pack_mask(img.data(), H, W);
+        assert(unpack_mask(packed) == img);
+
+        for (StructElem se : {StructElem::Cross, StructElem::Square}) {
+            auto eroded = reference_morph(img, H, W, false, se);
+            auto dilated = reference_morph(img, H, W, true, se);
+            assert(unpack_mask(erode(packed, se)) == eroded);
+            assert(unpack_mask(dilate(packed, se)) == dilated);
+
+            // Two iterations of opening and closing
+            auto opened = img;
+            for (int i = 0; i < 2; ++i) opened = reference_morph(opened, H, W, false, se);
+            for (int i = 0; i < 2; ++i) opened = reference_morph(opened, H, W, true, se);
+            auto closed = img;
+            for (int i = 0; i < 2; ++i) closed = reference_morph(closed, H, W, true, se);
+            for (int i = 0; i < 2; ++i) closed = reference_morph(closed, H, W, false, se);
+            assert(unpack_mask(opening(packed, se, 2)) == opened);
+            assert(unpack_mask(closing(packed, se, 2)) == closed);
+
+            // Fused cleanup + labeling == labeling the cleaned mask
+            for (bool eight : {false, true}) {
+                CCLWorkspace ws;
+                std::vector<int32_t> labels(H * W);
+                int comps = label_cc_2pass_morphology(packed, opening_steps(se, 2), eight, ws, labels.data());
+                auto expected = label_cc_2pass(opened.data(), H, W, eight);
+                assert(labels == expected);
+                assert(comps == component_count(expected));
+            }
+        }
+    }
+
+    // Thresholding straight to bits
+    std::vector<uint8_t> gray = {10, 200, 128, 129};
+    BitMask dark = pack_threshold(gray.data(), 1, 4, 128, false);
+    assert(dark.get(0, 0) && !dark.get(0, 1) && dark.get(0, 2) && !dark.get(0, 3));
+    BitMask bright = pack_threshold(gray.data(), 1, 4, 128, true);
+    assert(!bright.get(0, 0) && bright.get(0, 1) && !bright.get(0, 2) && bright.get(0, 3));
+
+    return true;
+}
+
+bool test_roi_labeling() {
+    // Empty image: empty box, all-zero labels
+    std::vector<uint8_t> empty(30 * 40, 0);
+    assert(foreground_bbox(empty.data(), 30, 40).empty());
+    auto none = label_cc_roi(empty.data(), 30, 40);
+    assert(std::all_of(none.begin(), none.end(), [](int32_t l) { return l == 0; }));
+
+    // Small blob cluster away from the borders, widths that straddle words
+    for (int W : {7, 33, 100}) {
+        int H = 50;
+        std::vector<uint8_t> img(H * W, 0);
+        auto patch = generate_random_image(12, std::min(W - 2, 20), 0.5, W);
+        int pw = std::min(W - 2, 20);
+        for (int y = 0; y < 12; ++y) {
+            for (int x = 0; x < pw; ++x) img[(y + 20) * W + x + 1] = patch[y * pw + x];
+        }
+        BBox expected;
+        expected.y0 = H;
+        expected.x0 = W;
+        for (int y = 0; y < H; ++y) {
+            for (int x = 0; x < W; ++x) {
+                if (!img[y * W + x]) continue;
+                expected.y0 = std::min(expected.y0, y);
+                expected.x0 = std::min(expected.x0, x);
+                expected.y1 = std::max(expected.y1, y + 1);
+                expected.x1 = std::max(expected.x1, x + 1);
+            }
+        }
+        BBox box = foreground_bbox(img.data(), H, W);
+        assert(box.y0 == expected.y0 && box.y1 == expected.y1);
+        assert(box.x0 == expected.x0 && box.x1 == expected.x1);
+
+        // Identical to the full scan, and stale output is overwritten
+        for (bool eight : {false, true}) {
+            CCLWorkspace ws;
+            std::vector<int32_t> labels(H * W, -1);
+            int comps = label_cc_2pass_roi(img.data(), H, W, eight, ws, labels.data());
+            auto full = label_cc_2pass(img.data(), H, W, eight);
+            assert(labels == full);
+            assert(comps == component_count(full));
+        }
+    }
+
+    // Batch crop mode agrees with the uncropped batch
+    std::vector<uint8_t> img(64 * 64, 0);
+    for (int y = 10; y < 30; ++y) img[y * 64 + 40] = img[y * 64 + 45] = 1;
+    BatchOptions opts;
+    opts.threads = 2;
+    opts.crop = true;
+    auto cropped = label_batch({ImageView(img, 64, 64)}, opts);
+    assert(cropped[0].labels == label_cc_2pass(img.data(), 64, 64));
+    assert(cropped[0].components == 2);
+
+    return true;
+}
+
+bool test_strided_views() {
+    // A tile of a larger frame and a padded copy of it, labeled in place
+    const int FH = 40, FW = 57, y0 = 7, x0 = 13, H = 21, W = 30;
+    auto frame = generate_random_image(FH, FW, 0.5, 17);
+    ImageView tile = ImageView(frame, FH, FW).sub(y0, x0, H, W);
+    assert(tile.stride == FW && !tile.dense());
+
+    std::vector<uint8_t> dense(H * W);
+    const int64_t pad = 64;
+    std::vector<uint8_t> padded(H * pad, 9);  // row padding is junk and must never be read
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            dense[y * W + x] = tile.at(y, x);
+            padded[y * pad + x] = tile.at(y, x);
+        }
+    }
+
+    for (bool eight : {false, true}) {
+        for (const auto& e : batch_engines()) {
+            auto expected = e.fn(dense.data(), H, W, eight);
+            int comps = component_count(expected);
+
+            // Output into the matching tile of a full-size label frame; the
+            // rest of the frame is not touched
+            std::vector<int32_t> out(FH * FW, -1);
+            LabelView out_tile = LabelView(out, FH, FW).sub(y0, x0, H, W);
+            assert(e.view(tile, out_tile, eight) == comps);
+            for (int y = 0; y < FH; ++y) {
+                for (int x = 0; x < FW; ++x) {
+                    bool inside = y >= y0 && y < y0 + H && x >= x0 && x < x0 + W;
+                    int32_t v = out[y * FW + x];
+                    assert(inside ? v == expected[(y - y0) * W + x - x0] : v == -1);
+                }
+            }
+        }
+        auto expected = label_cc_2pass(dense.data(), H, W, eight);
+        std::vector<int32_t> out(H * W, -1);
+        assert(label_cc_2pass(ImageView(padded.data(), H, W, pad), LabelView(out, H, W), eight) ==
+               component_count(expected));
+        assert(out == expected);
+
+        std::fill(out.begin(), out.end(), -1);
+        label_cc_auto(tile, LabelView(out, H, W), eight);
+        assert(component_count(out) == component_count(expected));
+
+        CCLWorkspace ws;
+        std::fill(out.begin(), out.end(), -1);
+        label_cc_2pass_roi(tile, LabelView(out, H, W), eight, ws);
+        assert(out == expected);
+
+        // Stream initializer
+        IncrementalDSU from_view(H, W, eight), from_dense(H, W, eight);
+        assert(from_view.initialize(tile));
+        from_dense.initialize(dense.data());
+        assert(from_view.get_labels() == from_dense.get_labels());
+        assert(!from_view.initialize(ImageView(frame, FH, FW)));
+    }
+
+    // Tiles of one frame through the batch API
+    std::vector<ImageView> tiles;
+    for (int ty = 0; ty < FH; ty += 20) {
+        for (int tx = 0; tx < FW; tx += 19) {
+            tiles.push_back(ImageView(frame, FH, FW).sub(ty, tx, std::min(20, FH - ty), std::min(19, FW - tx)));
+        }
+    }
+    auto results = label_batch(tiles);
+    for (size_t i = 0; i < tiles.size(); ++i) {
+        const ImageView& t = tiles[i];
+        std::vector<uint8_t> copy;
+        for (int y = 0; y < t.H; ++y) copy.insert(copy.end(), t.row(y), t.row(y) + t.W);
+        assert(results[i].labels == label_cc_2pass(copy.data(), t.H, t.W));
+    }
+
+    return true;
+}
+
+bool test_label_service() {
+    std::string socket_path = "/tmp/ccl_test_" + std::to_string(getpid()) + ".sock";
+    std::string prefix = "/ccl_test_" + std::to_string(getpid());
+    LabelServer server(2);
+    std::string error;
+    assert(server.listen(socket_path, error));
+    std::thread serving([&] { server.serve(); });
+
+    // A tile of a larger mask, labeled into the middle of a padded output
+    const int FH = 30, FW = 50, H = 20, W = 32;
+    auto frame = generate_random_image(FH, FW, 0.5, 23);
+    SharedMemory in, out;
+    assert(in.create(prefix + "_in", frame.size(), error));
+    assert(out.create(prefix + "_out", (size_t)FH * FW * sizeof(int32_t), error));
+    std::copy(frame.begin(), frame.end(), in.data());
+
+    LabelRequest req;
+    std::strncpy(req.input, in.name().c_str(), sizeof(req.input) - 1);
+    std::strncpy(req.output, out.name().c_str(), sizeof(req.output) - 1);
+    req.H = H;
+    req.W = W;
+    req.input_stride = FW;
+    req.input_offset = 4 * FW + 9;
+    req.output_stride = FW;
+    req.output_offset = (4 * FW + 9) * sizeof(int32_t);
+
+    LabelClient client;
+    assert(client.connect(socket_path, error));
+    for (bool eight : {false, true}) {
+        req.eight_connectivity = eight;
+        LabelReply reply;
+        assert(client.call(req, reply, error) && reply.status == 0);
+
+        std::vector<int32_t> expected(H * W);
+        int comps = label_cc_2pass(ImageView(frame, FH, FW).sub(4, 9, H, W), LabelView(expected, H, W), eight);
+        assert(reply.components == comps);
+        LabelView result(reinterpret_cast<int32_t*>(out.data()), FH, FW);
+        for (int y = 0; y < H; ++y) {
+            assert(std::equal(expected.begin() + y * W, expected.begin() + (y + 1) * W, result.row(y + 4) + 9));
+        }
+    }
+
+    // Errors are reported per request and keep the connection usable
+    LabelRequest bad = req;
+    bad.H = FH;  // runs past the end of the input segment
+    LabelReply reply;
+    assert(client.call(bad, reply, error) && reply.status != 0);
+    bad = req;
+    bad.input_offset = ~uint64_t(0) - 16;  // offset + extent wraps around
+    assert(client.call(bad, reply, error) && reply.status != 0);
+    bad = req;
+    bad.output_offset = ~uint64_t(0) - 3;
+    assert(client.call(bad, reply, error) && reply.status != 0);
+    bad = req;
+    bad.H = 1 << 30;
+    bad.input_stride = int64_t(1) << 40;  // (H - 1) * stride overflows once scaled
+    bad.output_stride = int64_t(1) << 40;
+    assert(client.call(bad, reply, error) && reply.status != 0);
+    std::strncpy(bad.input, "/ccl_test_missing", sizeof(bad.input) - 1);
+    assert(client.call(bad, reply, error) && reply.status != 0);
+    struct stat st;
+    assert(::stat(socket_path.c_str(), &st) == 0 && (st.st_mode & 0777) == 0600);
+
+    // A segment shrunk after the server mapped it is re-checked, not
+    // written past its end
+    assert(::ftruncate(out.fd(), 0) == 0);
+    assert(client.call(req, reply, error) && reply.status != 0);
+    assert(::ftruncate(out.fd(), (off_t)FH * FW * sizeof(int32_t)) == 0);
+    assert(client.call(req, reply, error) && reply.status == 0 && reply.requests == 3);
+
+    // Sealed memfds passed with the request; they cannot be shrunk, and
+    // unsealed segments are refused on this path
+    SharedMemory sealed_in, sealed_out;
+    assert(sealed_in.create_sealed(frame.size(), error));
+    assert(sealed_out.create_sealed((size_t)FH * FW * sizeof(int32_t), error));
+    std::copy(frame.begin(), frame.end(), sealed_in.data());
+    assert(::ftruncate(sealed_out.fd(), 0) != 0);
+    for (int i = 0; i < 2; ++i) {
+        assert(client.call_sealed(req, sealed_in, sealed_out, reply, error) && reply.status == 0);
+    }
+    assert(std::equal(out.data(), out.data() + out.size(), sealed_out.data()));
+    assert(client.call_sealed(req, in, out, reply, error) && reply.status != 0);
+    assert(client.call(req, reply, error) && reply.status == 0 && reply.requests == 6);
+
+    // Clients that connect per call do not pile up threads in the server
+    for (int i = 0; i < 20; ++i) {
+        LabelClient once;
+        assert(once.connect(socket_path, error) && once.call(req, reply, error) && reply.status == 0);
+    }
+    assert(server.connection_threads_held() <= 4);
+
+    LabelRequest stop;
+    stop.op = ServiceOp::Shutdown;
+    assert(client.call(stop, reply, error) && reply.status == 0 && reply.threads == 2);
+    serving.join();
+    assert(!client.call(req, reply, error));
+
+    return true;
+}
+
+bool test_mask_io() {
+    const int H = 37, W = 45;
+    auto img = generate_random_image(H, W, 0.45, 31);
+    std::string dir = "/tmp/ccl_test_io_" + std::to_string(getpid());
+    std::string error;
+
+    // Batch stats agree with StreamDSU's incremental ones
+    std::vector<int32_t> labels(H * W);
+    int comps = label_cc_2pass(ImageView(img, H, W), LabelView(labels, H, W));
+    auto stats = component_stats(LabelView(labels, H, W), comps);
+    StreamDSU stream(H, W);
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            if (img[y * W + x]) stream.add_pixel(y, x);
+        }
+    }
+    for (int y = 0; y < H; ++y) {
+        for (int x = 0; x < W; ++x) {
+            if (!img[y * W + x]) continue;
+            ComponentStats a = stats[labels[y * W + x] - 1];
+            ComponentStats b = stream.get_component_stats(stream.get_component_id(y, x));
+            assert(a.size == b.size && a.perimeter == b.perimeter);
+            assert(a.min_y == b.min_y && a.min_x == b.min_x && a.max_y == b.max_y && a.max_x == b.max_x);
+            assert(std::fabs(a.centroid_y - b.centroid_y) < 1e-9 && std::fabs(a.centroid_x - b.centroid_x) < 1e-9);
+        }
+    }
+
+    // Labels -> NPY -> header
+    std::string npy = dir + ".npy";
+    assert(write_npy(npy, LabelView(labels, H, W), error));
+    MappedFile mapped;
+    assert(mapped.open(npy, false, error));
+    NpyHeader header;
+    assert(parse_npy_header(mapped.data(), mapped.size(), header, error));
+    assert(header.descr == "<i4" && !header.fortran_order && header.data_offset % 64 == 0);
+    assert(header.shape.size() == 2 && header.shape[0] == H && header.shape[1] == W);
+    assert(mapped.size() == header.data_offset + labels.size() * sizeof(int32_t));
+    assert(std::memcmp(mapped.data() + header.data_offset, labels.data(), labels.size() * sizeof(int32_t)) == 0);
+
+    // PGM (0/255, used in place) and raw masks label like the source
+    std::vector<uint8_t> gray(img.size());
+    for (size_t i = 0; i < img.size(); ++i) gray[i] = img[i] ? 255 : 0;
+    std::string pgm = dir + ".pgm", raw = dir + ".raw";
+    assert(write_pgm(pgm, gray.data(), H, W));
+    {
+        std::ofstream out(raw, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(img.data()), (std::streamsize)img.size());
+    }
+    for (const std::string& path : {pgm, raw}) {
+        MaskFile mask;
+        assert(open_mask(path, H, W, mask, error));
+        assert(mask.decoded.empty() && mask.view.H == H && mask.view.W == W);
+        std::vector<int32_t> got(H * W);
+        assert(label_cc_2pass(mask.view, LabelView(got, H, W)) == comps && got == labels);
+    }
+    MaskFile missing;
+    assert(!open_mask(dir + ".none", 0, 0, missing, error) && !error.empty());
+    assert(!open_mask(raw, 0, 0, missing, error));  // raw needs a size
+
+    if (npz_supported()) {
+        std::string npz = dir + ".npz";
+        assert(write_npz(npz, LabelView(labels, H, W), error));
+        MappedFile z;
+        assert(z.open(npz, false, error) && z.size() > 30 && std::memcmp(z.data(), "PK\x03\x04", 4) == 0);
+        std::remove(npz.c_str());
+    }
+    std::remove(npy.c_str());
+    std::remove(pgm.c_str());
+    std::remove(raw.c_str());
+    return true;
+}
+
+bool test_run_labels() {
+    const int H = 41, W = 53;
+    std::string error;
+    CCLWorkspace ws;
+    RunLabels runs;
+    for (double density : {0.05, 0.45, 0.9}) {
+        auto img = generate_random_image(H, W, density, 17);
+        for (bool eight : {false, true}) {
+            // Same numbering as BFS (raster order of first pixel)
+            auto bfs = label_cc_bfs(img.data(), H, W, eight);
+            int comps = label_cc_runs(ImageView(img, H, W), eight, ws, runs);
+            assert(comps == runs.components && runs_to_dense(runs) == bfs);
+            assert(comps == component_count(label_cc_2pass(img.data(), H, W, eight)));
+            for (int y = 0; y < H; ++y) {
+                for (int x = 0; x < W; ++x) assert(runs.at(y, x) == bfs[y * W + x]);
+            }
+
+            // Dense -> runs -> bytes -> runs round trip
+            RunLabels back;
+            auto bytes = encode_runs(runs_from_dense(LabelView(bfs, H, W)));
+            assert(decode_runs(bytes.data(), bytes.size(), back, error));
+            assert(back.components == comps && back.runs.size() == runs.runs.size() && runs_to_dense(back) == bfs);
+            assert(!decode_runs(bytes.data(), bytes.size() - 1, back, error));
+        }
+
+        // Stream snapshots share the format, with the same numbering as
+        // their get_labels()
+        StreamDSU stream(H, W);
+        IncrementalDSU inc(H, W);
+        inc.initialize(std::vector<uint8_t>(H * W, 0).data());
+        for (int i = H * W - 1; i >= 0; --i) {
+            if (!img[i]) continue;
+            stream.add_pixel(i / W, i % W);
+            inc.add_pixel(i / W, i % W);
+        }
+        RunLabels s = stream.get_label_runs(), n = inc.get_label_runs();
+        assert(runs_to_dense(s) == stream.get_labels() && s.components == stream.get_component_count());
+        assert(runs_to_dense(n) == inc.get_labels() && n.components == inc.get_component_count());
+    }
+
+    // NPY written from runs equals the dense writer's file
+    auto img = generate_random_image(H, W, 0.3, 5);
+    runs = label_cc_runs(img.data(), H, W);
+    auto dense = runs_to_dense(runs);
+    std::string a = "/tmp/ccl_test_runs_" + std::to_string(getpid()) + "_a.npy";
+    std::string b = "/tmp/ccl_test_runs_" + std::to_string(getpid()) + "_b.npy";
+    assert(write_npy(a, runs, error) && write_npy(b, LabelView(dense, H, W), error));
+    MappedFile fa, fb;
+    assert(fa.open(a, false, error) && fb.open(b, false, error));
+    assert(fa.size() == fb.size() && std::memcmp(fa.data(), fb.data(), fa.size()) == 0);
+    std::remove(a.c_str());
+    std::remove(b.c_str());
+
+    // Empty image: no runs, every row empty
+    std::vector<uint8_t> empty(H * W, 0);
+    runs = label_cc_runs(empty.data(), H, W);
+    assert(runs.components == 0 && runs.runs.empty() && runs.row_begin.size() == (size_t)H + 1);
+    return true;
+}
+
+bool test_sparse_coords() {
+    // Same partition and numbering as the run engine on the dense image,
+    // whatever the input order; duplicates share a label
+    const int H = 60, W = 70;
+    for (uint64_t seed : {3, 4}) {
+        auto pixels = generate_stream(H, W, 1500, StreamOrder::Random, seed);
+        auto img = pixels_to_image(pixels, H, W);
+        pixels.push_back(pixels[5]);
+        for (bool eight : {false, true}) {
+            RunLabels runs = label_cc_runs(img.data(), H, W, eight);
+            std::vector<int32_t> labels;
+            assert(label_cc_coords(pixels, eight, labels) == runs.components);
+            assert(labels.size() == pixels.size());
+            for (size_t i = 0; i < pixels.size(); ++i) {
+                assert(labels[i] == runs.at(pixels[i].first, pixels[i].second));
+            }
+        }
+    }
+
+    // No canvas: far-apart and negative coordinates, a diagonal that only
+    // 8-connectivity joins, and rows with gaps between them
+    std::vector<std::pair<int, int>> far = {{-5, -5}, {-4, -4}, {2000000000, 7}, {2000000000, 8},
+                                            {2000000001, 9}, {-1, 0}, {1, 0}};
+    auto four = label_cc_coords(far, false), eight = label_cc_coords(far, true);
+    assert(*std::max_element(four.begin(), four.end()) == 6);
+    assert(*std::max_element(eight.begin(), eight.end()) == 4);
+    assert(eight[0] == eight[1] && eight[0] == 1 && eight[2] == eight[4] && eight[5] != eight[6]);
+    assert(label_cc_coords({}, false).empty());
+
+    // StreamDSU memory now follows the pixels, not the canvas
+    StreamDSU big(100000, 100000);
+    big.add_pixels({{1, 0}, {99999, 99999}, {50000, 3}, {50000, 4}});
+    assert(big.get_component_count() == 3 && big.get_memory_usage() < (1 << 20));
+    assert(big.get_component_id(50000, 3) == big.get_component_id(50000, 4));
+    return true;
+}
+
+bool test_lazy_labels() {
+    const int H = 47, W = 61;
+    LazyLabels lazy;
+    for (double density : {0.0, 0.3, 0.6}) {
+        auto img = generate_random_image(H, W, density, 23);
+        for (bool eight : {false, true}) {
+            auto expected = label_cc_2pass(img.data(), H, W, eight);
+            label_cc_2pass_lazy(ImageView(img, H, W), eight, lazy);  // reused across calls
+            assert(lazy.components() == component_count(expected));
+
+            // Per-pixel reads before and after some rows are resolved
+            for (int y = 0; y < H; ++y) {
+                for (int x = 0; x < W; ++x) assert(lazy.at(y, x) == expected[y * W + x]);
+            }
+            for (int y = 1; y < H; y += 3) {
+                assert(std::equal(expected.begin() + y * W, expected.begin() + (y + 1) * W, lazy.row(y)));
+            }
+            for (int y = 0; y < H; ++y) {
+                for (int x = 0; x < W; ++x) assert(lazy.at(y, x) == expected[y * W + x]);
+            }
+            std::vector<int32_t> copy(H * W, -1);
+            lazy.materialize(LabelView(copy, H, W));
+            assert(copy == expected && lazy.materialize() == expected);
+        }
+    }
+
+    // Seeds on a U shape: joined only through the bottom row
+    std::vector<uint8_t> u = {
+        1, 0, 1,
+        1, 0, 1,
+        1, 1, 1,
+        0, 0, 0,
+        1, 0, 0,
+    };
+    LazyLabels shape = label_cc_2pass_lazy(ImageView(u, 5, 3));
+    assert(shape.components() == 2 && shape.equivalence().size() == 4);
+    assert(shape.connected(0, 0, 0, 2) && !shape.connected(0, 0, 4, 0) && !shape.connected(0, 1, 0, 1));
+    return true;
+}
+
+bool test_connectivity_queries() {
+    // Random seed pairs (background and out-of-range ones included) agree
+    // with a full labeling
+    const int H = 53, W = 67;
+    FloodWorkspace ws;
+    for (double density : {0.45, 0.6}) {
+        auto img = generate_random_image(H, W, density, 41);
+        for (bool eight : {false, true}) {
+            auto labels = label_cc_bfs(img.data(), H, W, eight);
+            std::vector<SeedPair> queries;
+            uint64_t state = 7;
+            auto next = [&](int n) {
+                state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+                return (int)((state >> 33) % (uint64_t)n) - 1;  // -1 .. n - 2
+            };
+            for (int i = 0; i < 2000; ++i) queries.push_back({next(H + 2), next(W + 2), next(H + 2), next(W + 2)});
+            queries.push_back({3, 3, 3, 3});
+            auto answers = connected(ImageView(img, H, W), queries, eight, ws);
+            for (size_t i = 0; i < queries.size(); ++i) {
+                const SeedPair& s = queries[i];
+                bool inside = s.y0 >= 0 && s.y0 < H && s.x0 >= 0 && s.x0 < W && s.y1 >= 0 && s.y1 < H &&
+                              s.x1 >= 0 && s.x1 < W;
+                int32_t a = inside ? labels[s.y0 * W + s.x0] : 0;
+                bool expected = inside && a != 0 && a == labels[s.y1 * W + s.x1];
+                assert(answers[i] == expected);
+            }
+        }
+    }
+
+    // Early exit: nearby seeds on a large solid mask explore a few rows,
+    // and a seed in a small blob settles the query by exhausting the blob
+    const int N = 2000;
+    std::vector<uint8_t> solid(N * N, 1);
+    for (int x = 0; x < N; ++x) solid[1000 * N + x] = 0;  // wall between the halves
+    solid[10 * N + 10] = 0;
+    solid[10 * N + 12] = 0;
+    solid[9 * N + 11] = 0;
+    solid[11 * N + 11] = 0;  // (10, 11) is now a single-pixel island
+    ImageView big(solid, N, N);
+    assert(connected(big, 500, 100, 500, 1900, false, ws) && ws.explored <= 3 * N);
+    assert(!connected(big, 10, 11, 1500, 1500, false, ws) && ws.explored <= 2 * N);
+    assert(connected(big, 10, 11, 9, 12, true, ws));
+    assert(!connected(big, 999, 5, 1001, 5, true, ws));
+
+    // The pointer overload keeps its own workspace across calls
+    for (int i = 0; i < 3; ++i) {
+        assert(connected(solid.data(), N, N, 500, 100 + i, 500, 1900, false));
+        assert(!connected(solid.data(), N, N, 10, 11, 1500, 1500, false));
+    }
+    return true;
+}
+
 int main() {
     std::cout << "Running C++ tests...\n\n";
     
@@ -160,6 +1417,84 @@ int main() {
         if (test_consistency()) {
             std::cout << "✓ Consistency test passed\n";
         }
+        if (test_stream_matches_batch()) {
+            std::cout << "✓ Stream vs batch test passed\n";
+        }
+        if (test_stream_component_stats()) {
+            std::cout << "✓ Stream component stats test passed\n";
+        }
+        if (test_percolation_sweep()) {
+            std::cout << "✓ Percolation sweep test passed\n";
+        }
+        if (test_workload_generator()) {
+            std::cout << "✓ Workload generator test passed\n";
+        }
+        if (test_incremental_matches_batch()) {
+            std::cout << "✓ Incremental vs batch test passed\n";
+        }
+        if (test_event_log_roundtrip()) {
+            std::cout << "✓ Event log round-trip test passed\n";
+        }
+        if (test_bench_statistics()) {
+            std::cout << "✓ Benchmark statistics test passed\n";
+        }
+        if (test_stream_events()) {
+            std::cout << "✓ Stream event test passed\n";
+        }
+        if (test_phase_observer()) {
+            std::cout << "✓ Phase observer test passed\n";
+        }
+        if (test_alloc_tracking()) {
+            std::cout << "✓ Allocation tracking test passed\n";
+        }
+        if (test_engine_trace()) {
+            std::cout << "✓ Engine trace test passed\n";
+        }
+        if (test_shape_corpus()) {
+            std::cout << "✓ Shape corpus test passed\n";
+        }
+        if (test_regression_gate()) {
+            std::cout << "✓ Regression gate test passed\n";
+        }
+        if (test_bandwidth_model()) {
+            std::cout << "✓ Bandwidth model test passed\n";
+        }
+        if (test_auto_engine()) {
+            std::cout << "✓ Adaptive engine test passed\n";
+        }
+        if (test_batch_labeling()) {
+            std::cout << "✓ Batch labeling test passed\n";
+        }
+        if (test_mask_pipeline()) {
+            std::cout << "✓ Mask pipeline test passed\n";
+        }
+        if (test_morphology()) {
+            std::cout << "✓ Morphology test passed\n";
+        }
+        if (test_roi_labeling()) {
+            std::cout << "✓ ROI labeling test passed\n";
+        }
+        if (test_strided_views()) {
+            std::cout << "✓ Strided view test passed\n";
+        }
+        if (test_label_service()) {
+            std::cout << "✓ Label service test passed\n";
+        }
+        if (test_mask_io()) {
+            std::cout << "✓ Mask I/O test passed\n";
+        }
+        if (test_run_labels()) {
+            std::cout << "✓ Run-length labels test passed\n";
+        }
+        if (test_sparse_coords()) {
+            std::cout << "✓ Sparse coordinate labeling test passed\n";
+        }
+        if (test_lazy_labels()) {
+            std::cout << "✓ Lazy labels test passed\n";
+        }
+        if (test_connectivity_queries()) {
+            std::cout << "✓ Connectivity query test passed\n";
+        }
         
         std::cout << "\n✅ All tests passed!\n";
         return 0;
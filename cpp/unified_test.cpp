@@ -1,9 +1,9 @@
 #include "dsu_2pass.hpp"
 #include "algorithms.hpp"
+#include "workload.hpp"
+#include "bench_harness.hpp"
 #include <iostream>
 #include <vector>
-#include <chrono>
-#include <random>
 #include <iomanip>
 #include <set>
 #include <algorithm>
@@ -35,42 +35,16 @@ double benchmark_strategy_full(
     const uint8_t* img, int H, int W, bool eight_conn, int iterations,
     const std::string& strategy) {
     
-    std::vector<int32_t> (*func)(const uint8_t*, int, int, bool) = nullptr;
-    
-    if (strategy == "2-Pass DSU") {
-        func = label_cc_2pass;
-    } else if (strategy == "BFS") {
-        func = label_cc_bfs;
-    } else if (strategy == "DFS") {
-        func = label_cc_dfs;
-    } else if (strategy == "DSU 1-pass") {
-        func = label_cc_dsu;
-    }
-    
+    LabelFunc func = find_engine(strategy);
     if (!func) return 0.0;
     
-    auto start = std::chrono::high_resolution_clock::now();
-    for (int iter = 0; iter < iterations; ++iter) {
-        func(img, H, W, eight_conn);
-    }
-    auto end = std::chrono::high_resolution_clock::now();
-    auto duration = std::chrono::duration_cast<std::chrono::microseconds>(end - start);
-    return duration.count() / (double)iterations;
+    BenchOptions opts;
+    opts.repetitions = iterations;
+    return run_benchmark([&] { func(img, H, W, eight_conn); }, opts).median_us;
 }
 
 int get_component_count(const uint8_t* img, int H, int W, bool eight_conn, const std::string& strategy) {
-    std::vector<int32_t> (*func)(const uint8_t*, int, int, bool) = nullptr;
-    
-    if (strategy == "2-Pass DSU") {
-        func = label_cc_2pass;
-    } else if (strategy == "BFS") {
-        func = label_cc_bfs;
-    } else if (strategy == "DFS") {
-        func = label_cc_dfs;
-    } else if (strategy == "DSU 1-pass") {
-        func = label_cc_dsu;
-    }
-    
+    LabelFunc func = find_engine(strategy);
     if (!func) return 0;
     
     auto result = func(img, H, W, eight_conn);
@@ -122,9 +96,7 @@ void run_comprehensive_test(bool eight_conn, int iterations) {
     std::cout << "Total combinations: " << (strategies.size() * image_configs.size()) << "\n";
     std::cout << "Note: Stream input tests build full image and use standard algorithms\n\n";
     
-    std::random_device rd;
-    std::mt19937 gen(42);
-    std::uniform_real_distribution<> dis(0.0, 1.0);
+    uint64_t seed = 42;
     
     int test_count = 0;
     int total_tests = strategies.size() * image_configs.size();
@@ -147,25 +119,11 @@ void run_comprehensive_test(bool eight_conn, int iterations) {
             int stream_size = (int)(image_size * config.stream_ratio);
             if (stream_size > image_size) stream_size = image_size;
             
-            std::set<std::pair<int, int>> used;
-            std::uniform_int_distribution<> y_dist(0, H - 1);
-            std::uniform_int_distribution<> x_dist(0, W - 1);
-            
-            for (int i = 0; i < stream_size; ++i) {
-                int y, x;
-                do {
-                    y = y_dist(gen);
-                    x = x_dist(gen);
-                } while (used.count({y, x}));
-                used.insert({y, x});
-                stream_pixels.push_back({y, x});
-                full_img[y * W + x] = 1;
-            }
+            stream_pixels = sample_pixels(H, W, stream_size, seed++);
+            full_img = pixels_to_image(stream_pixels, H, W);
         } else {
             // Generate full image with 30% density
-            for (int i = 0; i < H * W; ++i) {
-                full_img[i] = (dis(gen) < 0.3) ? 1 : 0;
-            }
+            full_img = generate_random_image(H, W, 0.3, seed++);
         }
         
         // Test each strategy
@@ -0,0 +1,104 @@
+#include "work_pool.hpp"
+#include <algorithm>
+
+WorkStealingPool::WorkStealingPool(int n) {
+    if (n <= 0) n = (int)std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 0; i < n; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (int i = 0; i < n; ++i) {
+        threads.emplace_back(&WorkStealingPool::worker_loop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> guard(state_lock);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& t : threads) t.join();
+}
+
+void WorkStealingPool::run(int64_t tasks, const std::function<void(int64_t, int)>& fn) {
+    if (tasks <= 0) return;
+
+    // Contiguous blocks keep neighbouring tasks on one worker
+    int n = size();
+    for (int w = 0; w < n; ++w) {
+        int64_t begin = tasks * w / n, end = tasks * (w + 1) / n;
+        std::lock_guard<std::mutex> guard(queues[w]->lock);
+        for (int64_t t = begin; t < end; ++t) queues[w]->tasks.push_back(t);
+    }
+
+    std::unique_lock<std::mutex> state(state_lock);
+    job = &fn;
+    remaining = tasks;
+    failure = nullptr;
+    generation++;
+    wake.notify_all();
+    // Also wait for workers still looking for tasks, so none of them can
+    // pick up the next run's tasks with this run's `fn`
+    finished.wait(state, [&] { return remaining == 0 && active == 0; });
+    job = nullptr;
+    if (failure) std::rethrow_exception(failure);
+}
+
+bool WorkStealingPool::next_task(int id, int64_t& task) {
+    {
+        Queue& own = *queues[id];
+        std::lock_guard<std::mutex> guard(own.lock);
+        if (!own.tasks.empty()) {
+            task = own.tasks.front();
+            own.tasks.pop_front();
+            return true;
+        }
+    }
+
+    // Steal from the back of the next non-empty deque
+    int n = size();
+    for (int k = 1; k < n; ++k) {
+        Queue& victim = *queues[(id + k) % n];
+        std::lock_guard<std::mutex> guard(victim.lock);
+        if (!victim.tasks.empty()) {
+            task = victim.tasks.back();
+            victim.tasks.pop_back();
+            steal_count++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkStealingPool::worker_loop(int id) {
+    uint64_t seen = 0;
+    while (true) {
+        const std::function<void(int64_t, int)>* fn;
+        {
+            std::unique_lock<std::mutex> state(state_lock);
+            wake.wait(state, [&] { return stopping || generation != seen; });
+            if (stopping) return;
+            seen = generation;
+            fn = job;
+            if (!fn) continue;  // woke after that run had already finished
+            active++;
+        }
+
+        int64_t task;
+        int64_t done = 0;
+        while (next_task(id, task)) {
+            try {
+                (*fn)(task, id);
+            } catch (...) {
+                std::lock_guard<std::mutex> guard(state_lock);
+                if (!failure) failure = std::current_exception();
+            }
+            done++;
+        }
+
+        std::lock_guard<std::mutex> guard(state_lock);
+        remaining -= done;
+        active--;
+        if (remaining == 0 && active == 0) finished.notify_one();
+    }
+}
@@ -0,0 +1,65 @@
+#ifndef WORK_POOL_HPP
+#define WORK_POOL_HPP
+
+#include <vector>
+#include <deque>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <memory>
+#include <exception>
+
+// Fixed set of worker threads running index ranges with work stealing.
+//
+// run(n, fn) deals tasks 0..n-1 to the workers in contiguous blocks; each
+// worker takes tasks from the front of its own deque and, once it runs
+// dry, steals from the back of another worker's deque. Uneven task costs
+// (a few large images among many small ones) therefore even out without a
+// shared queue on the hot path. fn(task, worker) is called exactly once
+// per task; `worker` identifies per-worker state such as a workspace.
+class WorkStealingPool {
+public:
+    // threads <= 0: std::thread::hardware_concurrency()
+    explicit WorkStealingPool(int threads = 0);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    int size() const { return (int)queues.size(); }
+
+    // Blocks until every task has run. Not reentrant; the first exception
+    // thrown by fn is rethrown here after the remaining tasks finish.
+    void run(int64_t tasks, const std::function<void(int64_t task, int worker)>& fn);
+
+    // Tasks taken from another worker's deque, over the pool's lifetime
+    int64_t steals() const { return steal_count.load(); }
+
+private:
+    struct Queue {
+        std::mutex lock;
+        std::deque<int64_t> tasks;
+    };
+
+    void worker_loop(int id);
+    bool next_task(int id, int64_t& task);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::mutex state_lock;
+    std::condition_variable wake;      // workers: a new run started or shutdown
+    std::condition_variable finished;  // run(): all tasks done
+    const std::function<void(int64_t, int)>* job = nullptr;
+    uint64_t generation = 0;
+    int64_t remaining = 0;
+    int active = 0;                    // workers inside the current run
+    bool stopping = false;
+    std::exception_ptr failure;
+    std::atomic<int64_t> steal_count{0};
+};
+
+#endif // WORK_POOL_HPP
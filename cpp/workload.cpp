@@ -0,0 +1,351 @@
+#include "workload.hpp"
+#include <vector>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+uint64_t derive_seed(uint64_t seed, const std::string& key) {
+    uint64_t h = 0xCBF29CE484222325ULL;  // FNV-1a
+    for (unsigned char c : key) {
+        h = (h ^ c) * 0x100000001B3ULL;
+    }
+    WorkloadRng rng(seed ^ h);
+    return rng.next();
+}
+
+const char* stream_order_name(StreamOrder order) {
+    switch (order) {
+        case StreamOrder::Random:     return "random";
+        case StreamOrder::Raster:     return "raster";
+        case StreamOrder::Spiral:     return "spiral";
+        case StreamOrder::BlobGrowth: return "blob";
+        case StreamOrder::EdgeInward: return "edge";
+    }
+    return "unknown";
+}
+
+bool parse_stream_order(const std::string& name, StreamOrder& order) {
+    const StreamOrder all[] = {StreamOrder::Random, StreamOrder::Raster, StreamOrder::Spiral,
+                               StreamOrder::BlobGrowth, StreamOrder::EdgeInward};
+    for (StreamOrder o : all) {
+        if (name == stream_order_name(o)) {
+            order = o;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<std::pair<int, int>> sample_pixels(
+    int H, int W, int count, uint64_t seed
+) {
+    const int N = H * W;
+    count = std::max(0, std::min(count, N));
+
+    WorkloadRng rng(seed);
+    std::vector<std::pair<int, int>> pixels;
+    pixels.reserve(count);
+
+    if ((int64_t)count * 2 <= N) {
+        // Sparse: rejection against a bitmap, fewer than 2 draws per pixel
+        std::vector<uint8_t> taken(N, 0);
+        while ((int)pixels.size() < count) {
+            uint32_t idx = rng.below(N);
+            if (!taken[idx]) {
+                taken[idx] = 1;
+                pixels.push_back({(int)(idx / W), (int)(idx % W)});
+            }
+        }
+    } else {
+        // Dense: partial Fisher-Yates, stop after `count` swaps
+        std::vector<int32_t> idx(N);
+        std::iota(idx.begin(), idx.end(), 0);
+        for (int i = 0; i < count; ++i) {
+            int j = i + (int)rng.below(N - i);
+            std::swap(idx[i], idx[j]);
+            pixels.push_back({idx[i] / W, idx[i] % W});
+        }
+    }
+
+    return pixels;
+}
+
+// Eden growth: repeatedly occupy a random frontier pixel of one blob
+static std::vector<std::pair<int, int>> grow_blob(int H, int W, int count, uint64_t seed) {
+    const int N = H * W;
+    count = std::max(0, std::min(count, N));
+
+    WorkloadRng rng(seed);
+    std::vector<std::pair<int, int>> pixels;
+    pixels.reserve(count);
+    if (count == 0) return pixels;
+
+    std::vector<uint8_t> seen(N, 0);  // occupied or already on the frontier
+    std::vector<int32_t> frontier;
+    int start = (H / 2) * W + (W / 2);
+    frontier.push_back(start);
+    seen[start] = 1;
+
+    while ((int)pixels.size() < count && !frontier.empty()) {
+        size_t pick = rng.below((uint32_t)frontier.size());
+        int idx = frontier[pick];
+        frontier[pick] = frontier.back();
+        frontier.pop_back();
+
+        int y = idx / W;
+        int x = idx % W;
+        pixels.push_back({y, x});
+
+        if (x > 0 && !seen[idx - 1])     { seen[idx - 1] = 1; frontier.push_back(idx - 1); }
+        if (x + 1 < W && !seen[idx + 1]) { seen[idx + 1] = 1; frontier.push_back(idx + 1); }
+        if (y > 0 && !seen[idx - W])     { seen[idx - W] = 1; frontier.push_back(idx - W); }
+        if (y + 1 < H && !seen[idx + W]) { seen[idx + W] = 1; frontier.push_back(idx + W); }
+    }
+
+    return pixels;
+}
+
+std::vector<std::pair<int, int>> generate_stream(
+    int H, int W, int count, StreamOrder order, uint64_t seed
+) {
+    if (order == StreamOrder::BlobGrowth) {
+        return grow_blob(H, W, count, seed);
+    }
+
+    auto pixels = sample_pixels(H, W, count, seed);
+
+    switch (order) {
+        case StreamOrder::Raster:
+            std::sort(pixels.begin(), pixels.end());
+            break;
+
+        case StreamOrder::Spiral: {
+            // Chebyshev ring around the center, then angle within the ring
+            double cy = (H - 1) / 2.0;
+            double cx = (W - 1) / 2.0;
+            auto key = [&](const std::pair<int, int>& p) {
+                double dy = p.first - cy;
+                double dx = p.second - cx;
+                return std::make_pair(std::max(std::fabs(dy), std::fabs(dx)), std::atan2(dy, dx));
+            };
+            std::sort(pixels.begin(), pixels.end(),
+                      [&](const std::pair<int, int>& a, const std::pair<int, int>& b) {
+                          return key(a) < key(b);
+                      });
+            break;
+        }
+
+        case StreamOrder::EdgeInward: {
+            // Counting sort by distance to the border; keeps random order within a ring
+            int rings = (std::min(H, W) + 1) / 2;
+            std::vector<int> offset(rings + 1, 0);
+            auto ring = [&](const std::pair<int, int>& p) {
+                return std::min({p.first, p.second, H - 1 - p.first, W - 1 - p.second});
+            };
+            for (const auto& p : pixels) offset[ring(p) + 1]++;
+            for (int r = 0; r < rings; ++r) offset[r + 1] += offset[r];
+            std::vector<std::pair<int, int>> sorted(pixels.size());
+            for (const auto& p : pixels) sorted[offset[ring(p)]++] = p;
+            pixels.swap(sorted);
+            break;
+        }
+
+        default:
+            break;
+    }
+
+    return pixels;
+}
+
+std::vector<uint8_t> generate_random_image(
+    int H, int W, double density, uint64_t seed
+) {
+    WorkloadRng rng(seed);
+    std::vector<uint8_t> img((size_t)H * W);
+    for (size_t i = 0; i < img.size(); ++i) {
+        img[i] = (rng.uniform() < density) ? 1 : 0;
+    }
+    return img;
+}
+
+std::vector<uint8_t> pixels_to_image(
+    const std::vector<std::pair<int, int>>& pixels, int H, int W
+) {
+    std::vector<uint8_t> img((size_t)H * W, 0);
+    for (const auto& p : pixels) {
+        img[p.first * W + p.second] = 1;
+    }
+    return img;
+}
+
+const char* shape_class_name(ShapeClass cls) {
+    switch (cls) {
+        case ShapeClass::Noise:        return "noise";
+        case ShapeClass::Blobs:        return "blobs";
+        case ShapeClass::Spiral:       return "spiral";
+        case ShapeClass::Snake:        return "snake";
+        case ShapeClass::Checkerboard: return "checker";
+        case ShapeClass::Text:         return "text";
+    }
+    return "unknown";
+}
+
+const std::vector<ShapeClass>& all_shape_classes() {
+    static const std::vector<ShapeClass> classes = {
+        ShapeClass::Noise, ShapeClass::Blobs, ShapeClass::Spiral,
+        ShapeClass::Snake, ShapeClass::Checkerboard, ShapeClass::Text,
+    };
+    return classes;
+}
+
+bool parse_shape_class(const std::string& name, ShapeClass& cls) {
+    for (ShapeClass c : all_shape_classes()) {
+        if (name == shape_class_name(c)) {
+            cls = c;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void fill_disc(std::vector<uint8_t>& img, int H, int W, double cy, double cx, double r) {
+    int y0 = std::max(0, (int)std::floor(cy - r));
+    int y1 = std::min(H - 1, (int)std::ceil(cy + r));
+    int x0 = std::max(0, (int)std::floor(cx - r));
+    int x1 = std::min(W - 1, (int)std::ceil(cx + r));
+    for (int y = y0; y <= y1; ++y) {
+        for (int x = x0; x <= x1; ++x) {
+            if ((y - cy) * (y - cy) + (x - cx) * (x - cx) <= r * r) {
+                img[(size_t)y * W + x] = 1;
+            }
+        }
+    }
+}
+
+// Line that stays 4-connected: one axis step at a time
+static void draw_line4(std::vector<uint8_t>& img, int H, int W, int y0, int x0, int y1, int x1) {
+    int dx = std::abs(x1 - x0);
+    int dy = std::abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = 0;
+    int y = y0;
+    int x = x0;
+    while (true) {
+        if (y >= 0 && y < H && x >= 0 && x < W) img[(size_t)y * W + x] = 1;
+        if (y == y1 && x == x1) break;
+        // Step along the axis whose move keeps the point closest to the ideal line
+        if (std::abs(err + dy) < std::abs(err - dx) && x != x1) {
+            x += sx;
+            err += dy;
+        } else if (y != y1) {
+            y += sy;
+            err -= dx;
+        } else {
+            x += sx;
+            err += dy;
+        }
+    }
+}
+
+// Filled ellipses; radii span 1%..8% of the shorter side
+static void draw_blobs(std::vector<uint8_t>& img, int H, int W, WorkloadRng& rng) {
+    int side = std::min(H, W);
+    int count = std::max(1, (int)((int64_t)H * W / 6000));
+    for (int b = 0; b < count; ++b) {
+        double ry = side * (0.01 + 0.07 * rng.uniform()) + 1;
+        double rx = ry * (0.5 + rng.uniform());
+        double cy = rng.uniform() * H;
+        double cx = rng.uniform() * W;
+        for (int y = std::max(0, (int)(cy - ry)); y <= std::min(H - 1, (int)(cy + ry)); ++y) {
+            for (int x = std::max(0, (int)(cx - rx)); x <= std::min(W - 1, (int)(cx + rx)); ++x) {
+                double ny = (y - cy) / ry;
+                double nx = (x - cx) / rx;
+                if (ny * ny + nx * nx <= 1.0) img[(size_t)y * W + x] = 1;
+            }
+        }
+    }
+}
+
+// Archimedean spiral from the center with 8-pixel arm spacing, 3 pixels thick
+static void draw_spiral(std::vector<uint8_t>& img, int H, int W, WorkloadRng& rng) {
+    const double spacing = 8.0;
+    const double two_pi = 6.283185307179586;
+    double cy = (H - 1) / 2.0;
+    double cx = (W - 1) / 2.0;
+    double max_r = std::sqrt(cy * cy + cx * cx);
+    double phase = rng.uniform() * two_pi;
+    double theta = 0.0;
+    while (true) {
+        double r = spacing * theta / two_pi;
+        if (r > max_r) break;
+        fill_disc(img, H, W, cy + r * std::sin(theta + phase), cx + r * std::cos(theta + phase), 1.5);
+        // Advance about half a pixel of arc length
+        theta += 0.5 / std::max(1.0, r);
+    }
+}
+
+// Rows 0, 2, 4, ... joined alternately at the right and left edge
+static void draw_snake(std::vector<uint8_t>& img, int H, int W) {
+    for (int y = 0; y < H; y += 2) {
+        std::fill(img.begin() + (size_t)y * W, img.begin() + (size_t)(y + 1) * W, 1);
+        if (y + 1 < H) {
+            int x = (y / 2) % 2 == 0 ? W - 1 : 0;
+            img[(size_t)(y + 1) * W + x] = 1;
+        }
+    }
+}
+
+// Glyph grid: each 8x12 cell holds 2-4 strokes between points of a 3x4 lattice
+static void draw_text(std::vector<uint8_t>& img, int H, int W, WorkloadRng& rng) {
+    const int cell_w = 8;
+    const int cell_h = 12;
+    for (int gy = 0; gy + cell_h <= H; gy += cell_h) {
+        for (int gx = 0; gx + cell_w <= W; gx += cell_w) {
+            if (rng.below(8) == 0) continue;  // word gap
+            int strokes = 2 + (int)rng.below(3);
+            for (int s = 0; s < strokes; ++s) {
+                int p0 = (int)rng.below(12);
+                int p1 = (int)rng.below(12);
+                draw_line4(img, H, W,
+                           gy + 1 + (p0 / 3) * 3, gx + 1 + (p0 % 3) * 2,
+                           gy + 1 + (p1 / 3) * 3, gx + 1 + (p1 % 3) * 2);
+            }
+        }
+    }
+}
+
+std::vector<uint8_t> generate_shape_image(
+    ShapeClass cls, int H, int W, uint64_t seed
+) {
+    if (cls == ShapeClass::Noise) {
+        return generate_random_image(H, W, 0.3, seed);
+    }
+
+    WorkloadRng rng(seed);
+    std::vector<uint8_t> img((size_t)H * W, 0);
+    switch (cls) {
+        case ShapeClass::Blobs:
+            draw_blobs(img, H, W, rng);
+            break;
+        case ShapeClass::Spiral:
+            draw_spiral(img, H, W, rng);
+            break;
+        case ShapeClass::Snake:
+            draw_snake(img, H, W);
+            break;
+        case ShapeClass::Checkerboard:
+            for (int y = 0; y < H; ++y) {
+                for (int x = 0; x < W; ++x) {
+                    img[(size_t)y * W + x] = (uint8_t)((x + y) & 1);
+                }
+            }
+            break;
+        case ShapeClass::Text:
+            draw_text(img, H, W, rng);
+            break;
+        default:
+            break;
+    }
+    return img;
+}
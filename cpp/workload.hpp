@@ -0,0 +1,108 @@
+#ifndef WORKLOAD_HPP
+#define WORKLOAD_HPP
+
+#include <vector>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+// Deterministic workload generation shared by all benchmarks.
+// Every generator takes an explicit seed; the same seed gives the same
+// workload on every platform (no std::random_device, no
+// implementation-defined std distributions).
+
+// Small, fast PRNG (splitmix64) with an unbiased bounded draw
+class WorkloadRng {
+private:
+    uint64_t state;
+
+public:
+    explicit WorkloadRng(uint64_t seed) : state(seed) {}
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    // Uniform integer in [0, bound) (Lemire's multiply-shift with rejection)
+    uint32_t below(uint32_t bound) {
+        uint64_t m = (uint64_t)(uint32_t)next() * bound;
+        uint32_t low = (uint32_t)m;
+        if (low < bound) {
+            uint32_t threshold = (uint32_t)(-bound) % bound;
+            while (low < threshold) {
+                m = (uint64_t)(uint32_t)next() * bound;
+                low = (uint32_t)m;
+            }
+        }
+        return (uint32_t)(m >> 32);
+    }
+
+    // Uniform double in [0, 1)
+    double uniform() {
+        return (next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+};
+
+// Independent seed for a named case (e.g. "Stream 10%@500"), so a case's
+// workload does not depend on which other cases run before it
+uint64_t derive_seed(uint64_t seed, const std::string& key);
+
+// Order in which stream pixels arrive
+enum class StreamOrder {
+    Random,      // uniformly random distinct pixels, random order
+    Raster,      // random distinct pixels, row-major order
+    Spiral,      // random distinct pixels, spiral outward from the center
+    BlobGrowth,  // one connected blob grown from the center (Eden model)
+    EdgeInward   // random distinct pixels, outer ring first
+};
+
+const char* stream_order_name(StreamOrder order);
+bool parse_stream_order(const std::string& name, StreamOrder& order);
+
+// `count` distinct pixels sampled uniformly, in random order.
+// Sparse requests (count <= H*W/2) use rejection against a byte bitmap,
+// dense ones a partial Fisher-Yates shuffle of the index range.
+std::vector<std::pair<int, int>> sample_pixels(
+    int H, int W, int count, uint64_t seed
+);
+
+// `count` distinct pixels delivered in the given order
+std::vector<std::pair<int, int>> generate_stream(
+    int H, int W, int count, StreamOrder order, uint64_t seed
+);
+
+// i.i.d. Bernoulli(density) binary image
+std::vector<uint8_t> generate_random_image(
+    int H, int W, double density, uint64_t seed
+);
+
+// Dense 0/1 image containing the given pixels
+std::vector<uint8_t> pixels_to_image(
+    const std::vector<std::pair<int, int>>& pixels, int H, int W
+);
+
+// Structured image classes for the benchmark corpus. i.i.d. noise at
+// density 0.3 sits near the percolation threshold; these shapes stress
+// the engines the way real masks (and adversarial inputs) do.
+enum class ShapeClass {
+    Noise,         // i.i.d. Bernoulli(0.3)
+    Blobs,         // filled ellipses of varying size, lesion-like
+    Spiral,        // thick Archimedean spiral (clipped at the border): few long, curved components
+    Snake,         // boustrophedon path: deep DFS stacks and long union chains
+    Checkerboard,  // worst case for provisional labels under 4-connectivity
+    Text           // thin 4-connected strokes in a glyph grid
+};
+
+const char* shape_class_name(ShapeClass cls);
+bool parse_shape_class(const std::string& name, ShapeClass& cls);
+const std::vector<ShapeClass>& all_shape_classes();
+
+// 0/1 image of the given class
+std::vector<uint8_t> generate_shape_image(
+    ShapeClass cls, int H, int W, uint64_t seed
+);
+
+#endif // WORKLOAD_HPP
@@ -0,0 +1,78 @@
+# export_corpus.py
+"""
+Export the real lesion masks as binary PGM files for the C++ benchmark corpus.
+
+    python python/export_corpus.py [--image ISIC_0012369.jpg] [--mask mask_otsu.png]
+                                   [--out corpus/lesion] [--scales 1,0.5,0.25]
+
+Then run: ./ccl_bench --masks ../../corpus/lesion
+"""
+from __future__ import annotations
+import argparse
+import os
+import numpy as np
+from PIL import Image
+
+from make_mask import compute_mask
+
+
+# (name, method, invert, smooth, morph_open)
+MASK_VARIANTS = [
+    ("otsu_s0", "otsu", False, 0, 0),
+    ("otsu_s1", "otsu", False, 1, 1),
+    ("otsu_s3", "otsu", False, 3, 1),
+    ("otsu_inv", "otsu", True, 1, 1),
+    ("darkness", "darkness", False, 0, 1),
+    ("gray", "gray", False, 0, 0),
+]
+
+
+def write_pgm(path: str, mask: np.ndarray):
+    """
+    Write a 0/1 mask as binary PGM (P5) with values 0/255.
+    """
+    h, w = mask.shape
+    with open(path, "wb") as f:
+        f.write(f"P5\n{w} {h}\n255\n".encode("ascii"))
+        f.write((mask.astype(np.uint8) * 255).tobytes())
+
+
+def rescale(mask: np.ndarray, scale: float) -> np.ndarray:
+    if scale == 1.0:
+        return mask
+    h, w = mask.shape
+    size = (max(1, int(w * scale)), max(1, int(h * scale)))
+    small = Image.fromarray(mask * 255).resize(size, Image.NEAREST)
+    return (np.array(small) > 0).astype(np.uint8)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument("--image", default="ISIC_0012369.jpg")
+    parser.add_argument("--mask", default="mask_otsu.png")
+    parser.add_argument("--out", default=os.path.join("corpus", "lesion"))
+    parser.add_argument("--scales", default="1,0.5,0.25")
+    args = parser.parse_args()
+
+    os.makedirs(args.out, exist_ok=True)
+    scales = [float(s) for s in args.scales.split(",") if s]
+
+    masks = []
+    if os.path.exists(args.mask):
+        arr = np.array(Image.open(args.mask).convert("L"))
+        masks.append(("mask_otsu", (arr > 0).astype(np.uint8)))
+    if os.path.exists(args.image):
+        for name, method, invert, smooth, morph_open in MASK_VARIANTS:
+            masks.append((name, compute_mask(args.image, method, invert, smooth, morph_open)))
+
+    for name, mask in masks:
+        for scale in scales:
+            out = rescale(mask, scale)
+            suffix = "" if scale == 1.0 else f"_x{scale:g}"
+            path = os.path.join(args.out, f"{name}{suffix}.pgm")
+            write_pgm(path, out)
+            print(f"{path}: {out.shape[0]}x{out.shape[1]}, density {out.mean():.3f}")
+
+
+if __name__ == "__main__":
+    main()
@@ -1,5 +1,6 @@
 # make_mask.py
 from __future__ import annotations
+import warnings
 import numpy as np
 from PIL import Image, ImageFilter, ImageOps
 
@@ -37,15 +38,13 @@ def otsu_threshold(gray: np.ndarray) -> int:
     return threshold
 
 
-def generate_mask(input_path: str,
-                  output_path: str,
-                  method: str = "otsu",
-                  invert: bool = False,
-                  smooth: int = 1,
-                  morph_open: int = 1):
+def compute_mask(input_path: str,
+                 method: str = "otsu",
+                 invert: bool = False,
+                 smooth: int = 1,
+                 morph_open: int = 1) -> np.ndarray:
     """
-    Generate a binary (0/1) mask from dermoscopy image.
-    Saves PNG (0/255).
+    Compute a binary (0/1) uint8 mask from dermoscopy image.
     """
     img = Image.open(input_path).convert("RGB")
 
@@ -81,13 +80,30 @@ def generate_mask(input_path: str,
         mask = 1 - mask
 
     # --- Morphological Opening (optional) ---
-    try:
-        from scipy.ndimage import binary_opening
-        if morph_open > 0:
+    if morph_open > 0:
+        try:
+            from scipy.ndimage import binary_opening
+        except ImportError:
+            # cpp/mask_label --open N does the same without scipy
+            warnings.warn("scipy not installed: skipping morphological opening")
+        else:
             mask = binary_opening(mask.astype(bool),
                                   iterations=morph_open).astype(np.uint8)
-    except Exception:
-        pass
+
+    return mask
+
+
+def generate_mask(input_path: str,
+                  output_path: str,
+                  method: str = "otsu",
+                  invert: bool = False,
+                  smooth: int = 1,
+                  morph_open: int = 1):
+    """
+    Generate a binary (0/1) mask from dermoscopy image.
+    Saves PNG (0/255).
+    """
+    mask = compute_mask(input_path, method, invert, smooth, morph_open)
 
     # Save 0/255 PNG
     Image.fromarray(mask * 255).save(output_path)
@@ -109,6 +109,59 @@ def test_consistency():
     print("✓ Consistency test passed")
 
 
+def test_cpp_extension():
+    """Test the ccl_pybind module against the Python engines (skipped if not built)"""
+    sys.path.insert(0, str(Path(__file__).parent.parent / "cpp" / "build"))
+    try:
+        import ccl_pybind
+    except ImportError:
+        print("- C++ extension test skipped (ccl_pybind not built)")
+        return
+
+    np.random.seed(7)
+    frame = (np.random.rand(60, 80) < 0.4).astype(np.uint8)
+    for eight in (False, True):
+        expected = label_cc_bfs(frame, eight)
+        labels, n = ccl_pybind.label(frame, eight, engine="bfs")
+        assert labels.dtype == np.int32 and np.array_equal(labels, expected)
+        assert n == len(np.unique(expected[expected > 0]))
+
+        # Same partition from every engine
+        for engine in ("2pass", "dfs", "dsu", "auto", "roi"):
+            other, m = ccl_pybind.label(frame, eight, engine=engine)
+            pairs = np.unique(np.stack([other[frame > 0], expected[frame > 0]]), axis=1)
+            assert m == n and pairs.shape[1] == n and np.array_equal(other > 0, frame > 0)
+
+    # A strided slice is labeled in place, into a slice of a larger output
+    tile = frame[5:45, 10:70]
+    out = np.full((60, 80), -1, dtype=np.int32)
+    ccl_pybind.label(tile, engine="bfs", out=out[5:45, 10:70])
+    assert np.array_equal(out[5:45, 10:70], label_cc_bfs(np.ascontiguousarray(tile)))
+    assert (out[:5] == -1).all()
+
+    results, stats = ccl_pybind.label_batch([frame, tile], threads=2)
+    assert np.array_equal(results[1][0], ccl_pybind.label(np.ascontiguousarray(tile))[0])
+    assert sum(stats["images_per_worker"]) == 2
+
+    stream = ccl_pybind.StreamDSU(4, 4)
+    stream.add_pixels(np.array([[0, 0], [0, 1], [3, 3]]))
+    assert stream.component_count == 2
+    assert stream.component_stats(stream.component_id(0, 0)).size == 2
+    for bad in (0, -1, 10**6):
+        try:
+            stream.component_stats(bad)
+            assert False, "component id %d accepted" % bad
+        except IndexError:
+            pass
+    try:
+        ccl_pybind.StreamDSU(-1, 4)
+        assert False, "negative canvas accepted"
+    except ValueError:
+        pass
+
+    print("✓ C++ extension test passed")
+
+
 def run_all_tests():
     """Run all tests"""
     print("Running tests...\n")
@@ -118,6 +171,7 @@ def run_all_tests():
         test_empty_image()
         test_full_foreground()
         test_consistency()
+        test_cpp_extension()
         print("\n✅ All tests passed!")
         return 0
     except AssertionError as e: